@@ -0,0 +1,61 @@
+//
+//  ActivityMonitor.cpp
+//  PFM10
+//
+
+#include "ActivityMonitor.h"
+
+void ActivityMonitor::prepare(double sampleRate)
+{
+    idleDelaySamples = static_cast<juce::int64>(sampleRate * idleDelayMs / 1000.0);
+    samplesSinceActivity = 0;
+    idle = false;
+}
+
+void ActivityMonitor::process(const BlockSummary& summary, bool hostIsPlaying)
+{
+    static const float silenceThresholdGain = juce::Decibels::decibelsToGain(silenceThresholdDb);
+
+    bool isActive = hostIsPlaying || summary.getMaxMagnitude() > silenceThresholdGain;
+
+    if (isActive)
+    {
+        samplesSinceActivity = 0;
+        idle = false;
+
+        if (wakeRequested.exchange(false))
+            triggerAsyncUpdate();
+
+        return;
+    }
+
+    if (samplesSinceActivity < idleDelaySamples)
+    {
+        samplesSinceActivity += summary.numSamples;
+        idle = samplesSinceActivity >= idleDelaySamples;
+    }
+}
+
+void ActivityMonitor::wakeOnActivity(std::function<void()> callback)
+{
+    onWake = std::move(callback);
+
+    // If audio is already running, the next block takes care of it
+    wakeRequested = true;
+}
+
+void ActivityMonitor::cancelWake()
+{
+    wakeRequested = false;
+    cancelPendingUpdate();
+    onWake = nullptr;
+}
+
+void ActivityMonitor::handleAsyncUpdate()
+{
+    if (auto callback = std::move(onWake))
+    {
+        onWake = nullptr;
+        callback();
+    }
+}
@@ -0,0 +1,48 @@
+//
+//  ActivityMonitor.h
+//  PFM10
+//
+//  Tells the editor when there is nothing to meter: the host transport is
+//  stopped (or not reported) and the input has been silent for idleDelayMs.
+//  The editor parks its timers and update thread while idle.
+//
+//  process() runs on the audio thread and only touches atomics, apart from
+//  one triggerAsyncUpdate() after the editor has asked to be woken. The wake
+//  callback then runs on the message thread, so a parked editor wakes on the
+//  first block that carries audio instead of at the next poll.
+//
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "MeterAnalysis.h"
+
+class ActivityMonitor : private juce::AsyncUpdater
+{
+public:
+    static constexpr float silenceThresholdDb = -90.f;      // well below the meters' floor
+    static constexpr int idleDelayMs = 1000;
+
+    ~ActivityMonitor() override { cancelPendingUpdate(); }
+
+    void prepare(double sampleRate);
+
+    // Audio thread
+    void process(const BlockSummary& summary, bool hostIsPlaying);
+
+    bool isIdle() const { return idle.load(); }
+
+    // Message thread. onWake is called once, after the first active block that
+    // follows. Until then nobody is reading the editor FIFO.
+    void wakeOnActivity(std::function<void()> callback);
+    void cancelWake();
+    bool isWaitingForActivity() const { return wakeRequested.load(); }
+private:
+    std::function<void()> onWake;
+    std::atomic<bool> idle { false };
+    std::atomic<bool> wakeRequested { false };
+    juce::int64 idleDelaySamples { 44100 };
+    juce::int64 samplesSinceActivity { 0 };
+
+    void handleAsyncUpdate() override;
+};
@@ -0,0 +1,222 @@
+//
+//  AnalysisHistory.cpp
+//  PFM10 - Shared Code
+//
+
+#include "AnalysisHistory.h"
+
+namespace
+{
+    void writeVarInt(juce::MemoryOutputStream& stream, juce::uint32 value)
+    {
+        while (value >= 0x80)
+        {
+            stream.writeByte(static_cast<char>((value & 0x7f) | 0x80));
+            value >>= 7;
+        }
+
+        stream.writeByte(static_cast<char>(value));
+    }
+
+    bool readVarInt(juce::MemoryInputStream& stream, juce::uint32& value)
+    {
+        value = 0;
+
+        for (int shift = 0; shift < 35; shift += 7)
+        {
+            if (stream.isExhausted())
+                return false;
+
+            auto byte = static_cast<juce::uint8>(stream.readByte());
+            value |= static_cast<juce::uint32>(byte & 0x7f) << shift;
+
+            if ((byte & 0x80) == 0)
+                return true;
+        }
+
+        return false;
+    }
+
+    juce::uint32 zigzag(int n)      { return (static_cast<juce::uint32>(n) << 1) ^ static_cast<juce::uint32>(n >> 31); }
+    int unzigzag(juce::uint32 n)    { return static_cast<int>(n >> 1) ^ -static_cast<int>(n & 1); }
+}
+
+//==============================================================================
+
+void AnalysisHistory::setCapacity(int _numLevels)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto current = getLevelsLocked();
+    levels.assign(static_cast<size_t>(juce::jlimit(0, maxCapacity, _numLevels)), 0);
+    setLevelsLocked(current);
+}
+
+int AnalysisHistory::getCapacity() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return static_cast<int>(levels.size());
+}
+
+void AnalysisHistory::addFrame(float monoDb, float leftDb, float rightDb)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    peaks[0] = juce::jmax(peaks[0], toCentiDb(leftDb));
+    peaks[1] = juce::jmax(peaks[1], toCentiDb(rightDb));
+
+    if (levels.empty())
+        return;
+
+    levels[writeIndex] = toCentiDb(monoDb);
+    writeIndex = (writeIndex + 1) % levels.size();
+    numLevels = juce::jmin(numLevels + 1, levels.size());
+}
+
+void AnalysisHistory::clearLevels()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    writeIndex = 0;
+    numLevels = 0;
+}
+
+void AnalysisHistory::resetPeaks()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    peaks.fill(toCentiDb(NEGATIVE_INFINITY));
+}
+
+std::vector<float> AnalysisHistory::getLevels() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto quantised = getLevelsLocked();
+    std::vector<float> result(quantised.size());
+
+    for (size_t i = 0; i < quantised.size(); ++i)
+        result[i] = fromCentiDb(quantised[i]);
+
+    return result;
+}
+
+std::array<float, 2> AnalysisHistory::getPeaks() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    return { fromCentiDb(peaks[0]), fromCentiDb(peaks[1]) };
+}
+
+void AnalysisHistory::writeToStream(juce::OutputStream& stream) const
+{
+    juce::MemoryOutputStream payload;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        auto quantised = getLevelsLocked();
+        payload.preallocate(quantised.size() + 16);
+
+        writeVarInt(payload, static_cast<juce::uint32>(quantised.size()));
+        payload.writeShort(peaks[0]);
+        payload.writeShort(peaks[1]);
+
+        int previous = 0;
+        for (auto level : quantised)
+        {
+            writeVarInt(payload, zigzag(level - previous));
+            previous = level;
+        }
+    }
+
+    stream.writeInt(static_cast<int>(chunkMagic));
+    stream.writeInt(static_cast<int>(currentVersion));
+    stream.writeInt(static_cast<int>(payload.getDataSize()));
+    stream.write(payload.getData(), payload.getDataSize());
+}
+
+bool AnalysisHistory::readFromStream(juce::InputStream& stream)
+{
+    if (static_cast<juce::uint32>(stream.readInt()) != chunkMagic)
+        return false;
+
+    auto version = static_cast<juce::uint32>(stream.readInt());
+    auto payloadSize = stream.readInt();
+
+    if (version != currentVersion || payloadSize < 0)
+        return false;
+
+    juce::MemoryBlock payloadData;
+    if (stream.readIntoMemoryBlock(payloadData, payloadSize) != static_cast<size_t>(payloadSize))
+        return false;
+
+    juce::MemoryInputStream payload(payloadData, false);
+
+    juce::uint32 count = 0;
+    if (! readVarInt(payload, count) || count > static_cast<juce::uint32>(maxCapacity))
+        return false;
+
+    std::array<juce::int16, 2> loadedPeaks { payload.readShort(), payload.readShort() };
+
+    std::vector<juce::int16> loadedLevels(count);
+    int previous = 0;
+
+    for (auto& level : loadedLevels)
+    {
+        juce::uint32 delta = 0;
+        if (! readVarInt(payload, delta))
+            return false;
+
+        previous += unzigzag(delta);
+        level = static_cast<juce::int16>(previous);
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    peaks = loadedPeaks;
+    setLevelsLocked(loadedLevels);
+
+    return true;
+}
+
+juce::int16 AnalysisHistory::toCentiDb(float db)
+{
+    auto limited = juce::jlimit(NEGATIVE_INFINITY, MAX_DECIBELS, db);
+    return static_cast<juce::int16>(juce::roundToInt(limited * 100));
+}
+
+//==============================================================================
+
+std::vector<juce::int16> AnalysisHistory::getLevelsLocked() const
+{
+    std::vector<juce::int16> result;
+    result.reserve(numLevels);
+
+    if (levels.empty())
+        return result;
+
+    size_t readIndex = (writeIndex + levels.size() - numLevels) % levels.size();
+
+    for (size_t i = 0; i < numLevels; ++i)
+        result.push_back(levels[(readIndex + i) % levels.size()]);
+
+    return result;
+}
+
+void AnalysisHistory::setLevelsLocked(const std::vector<juce::int16>& newLevels)
+{
+    writeIndex = 0;
+    numLevels = 0;
+
+    if (levels.empty())
+        return;
+
+    // Keep the newest levels that fit
+    size_t first = newLevels.size() > levels.size() ? newLevels.size() - levels.size() : 0;
+
+    for (size_t i = first; i < newLevels.size(); ++i)
+        levels[numLevels++] = newLevels[i];
+
+    writeIndex = numLevels % levels.size();
+}
@@ -0,0 +1,61 @@
+//
+//  AnalysisHistory.h
+//  PFM10 - Shared Code
+//
+//  The recent level history and peak holds, kept by the processor so they
+//  can be saved with the plugin state and survive a project reload.
+//
+//  Levels are stored quantised to int16 centi-dB. In the state chunk each
+//  level is written as the difference from the one before it, zigzag and
+//  varint encoded, so steady material costs about a byte per frame.
+//
+//  Chunk layout (little-endian):
+//      uint32 magic "PFMH", uint32 version, uint32 payload size
+//      payload: varint numLevels, int16 peak left, int16 peak right,
+//               varint zigzag(level[0] - 0), varint zigzag(level[n] - level[n-1]) ...
+//
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include "MeterAnalysis.h"
+
+class AnalysisHistory
+{
+public:
+    static constexpr juce::uint32 chunkMagic = 0x484d4650;     // "PFMH"
+    static constexpr juce::uint32 currentVersion = 1;
+    static constexpr int maxCapacity = 1 << 20;
+
+    // Keeps the newest levels that fit. 0 turns the history off.
+    void setCapacity(int numLevels);
+    int getCapacity() const;
+
+    void addFrame(float monoDb, float leftDb, float rightDb);
+    void clearLevels();
+    void resetPeaks();
+
+    // Oldest first
+    std::vector<float> getLevels() const;
+    std::array<float, 2> getPeaks() const;
+
+    void writeToStream(juce::OutputStream& stream) const;
+
+    // Returns false and leaves the history alone if the stream doesn't hold
+    // a history chunk this version can read.
+    bool readFromStream(juce::InputStream& stream);
+
+    static juce::int16 toCentiDb(float db);
+    static float fromCentiDb(juce::int16 centiDb) { return centiDb * 0.01f; }
+private:
+    mutable std::mutex mutex;
+
+    std::vector<juce::int16> levels;    // ring, levels[writeIndex] is the oldest once full
+    size_t writeIndex { 0 };
+    size_t numLevels { 0 };
+    std::array<juce::int16, 2> peaks { toCentiDb(NEGATIVE_INFINITY), toCentiDb(NEGATIVE_INFINITY) };
+
+    std::vector<juce::int16> getLevelsLocked() const;
+    void setLevelsLocked(const std::vector<juce::int16>& newLevels);
+};
@@ -0,0 +1,130 @@
+//
+//  AudioSampleRing.cpp
+//  PFM10 - Shared Code
+//
+
+#include "AudioSampleRing.h"
+
+void AudioSampleRing::prepare(double sampleRate, int maxBlockSize)
+{
+    const juce::ScopedLock lock(readerLock);
+
+    int capacity = juce::jmax(static_cast<int>(std::ceil(sampleRate * minSeconds)), minBlocks * maxBlockSize);
+
+    // An AbstractFifo holds one item less than its size
+    fifo.setTotalSize(capacity + 1);
+    samples.setSize(numChannels, capacity + 1);
+    samples.clear();
+
+    lastGapPosition = 0;
+    numDroppedBlocks = 0;
+    numWritten = 0;
+    dropPending = false;
+    numRead = 0;
+    gapSeen = -1;               // the first read reports a gap, whatever the reader kept is from before
+    skipUntil = 0;
+}
+
+void AudioSampleRing::write(const juce::AudioBuffer<float>& buffer)
+{
+    int numSamples = buffer.getNumSamples();
+    int numBufferChannels = buffer.getNumChannels();
+    if (numSamples == 0 || numBufferChannels == 0)
+        return;
+
+    if (fifo.getFreeSpace() < numSamples)
+    {
+        dropPending = true;
+        ++numDroppedBlocks;
+        return;
+    }
+
+    // Published by the write below, so a reader that sees this block sees the gap before it
+    if (dropPending)
+    {
+        lastGapPosition.store(numWritten, std::memory_order_release);
+        dropPending = false;
+    }
+
+    auto scopedWrite = fifo.write(numSamples);
+
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        int sourceChannel = juce::jmin(ch, numBufferChannels - 1);
+
+        if (scopedWrite.blockSize1 > 0)
+            samples.copyFrom(ch, scopedWrite.startIndex1, buffer, sourceChannel, 0, scopedWrite.blockSize1);
+
+        if (scopedWrite.blockSize2 > 0)
+            samples.copyFrom(ch, scopedWrite.startIndex2, buffer, sourceChannel, scopedWrite.blockSize1, scopedWrite.blockSize2);
+    }
+
+    numWritten += numSamples;
+}
+
+bool AudioSampleRing::takeGap()
+{
+    auto gap = lastGapPosition.load(std::memory_order_acquire);
+    if (gap == gapSeen)
+        return false;
+
+    // Only the newest gap is kept, but everything before it is skipped, so older ones go with it
+    gapSeen = gap;
+    skipUntil = juce::jmax(skipUntil, gap);
+    return true;
+}
+
+void AudioSampleRing::skip(int numToSkip)
+{
+    if (numToSkip <= 0)
+        return;
+
+    fifo.finishedRead(numToSkip);
+    numRead += numToSkip;
+}
+
+AudioSampleRing::ReadResult AudioSampleRing::read(juce::AudioBuffer<float>& dest)
+{
+    jassert(dest.getNumChannels() >= numChannels);
+
+    const juce::ScopedLock lock(readerLock);
+    ReadResult result;
+
+    // Ready count first: whatever it covers, the gap in front of it is visible too
+    int numReady = fifo.getNumReady();
+    result.followsGap = takeGap();
+
+    // Samples from before the newest gap belong to audio that's already been cut short
+    int numToSkip = static_cast<int>(juce::jlimit(juce::int64(0), juce::int64(numReady), skipUntil - numRead));
+    skip(numToSkip);
+    numReady -= numToSkip;
+
+    int numToRead = juce::jmin(numReady, dest.getNumSamples());
+    if (numToRead == 0)
+        return result;
+
+    auto scopedRead = fifo.read(numToRead);
+
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        if (scopedRead.blockSize1 > 0)
+            dest.copyFrom(ch, 0, samples, ch, scopedRead.startIndex1, scopedRead.blockSize1);
+
+        if (scopedRead.blockSize2 > 0)
+            dest.copyFrom(ch, scopedRead.blockSize1, samples, ch, scopedRead.startIndex2, scopedRead.blockSize2);
+    }
+
+    numRead += numToRead;
+    result.numSamples = numToRead;
+    return result;
+}
+
+void AudioSampleRing::discardAll()
+{
+    const juce::ScopedLock lock(readerLock);
+
+    int numReady = fifo.getNumReady();
+    takeGap();
+
+    skip(numReady);
+}
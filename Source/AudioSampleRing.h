@@ -0,0 +1,71 @@
+//
+//  AudioSampleRing.h
+//  PFM10 - Shared Code
+//
+//  Single-producer, single-consumer ring of stereo samples, for displays
+//  that keep a history and need every sample in order. Unlike the block
+//  FIFO, the reader takes samples in whatever chunks suit it, and a block
+//  that doesn't fit is never lost silently: it is dropped whole, counted,
+//  and the reader is told where the gap is so it can start its histories
+//  over instead of splicing across it.
+//
+//  Positions are sample counts since prepare(). The writer records the
+//  position of the first block written after a drop before publishing that
+//  block. The reader reads the ready count first and the gap position after
+//  it, so it never sees samples from after a gap without also seeing the gap.
+//  The first read after prepare() reports a gap too.
+//
+
+#pragma once
+
+#include <JuceHeader.h>
+
+class AudioSampleRing
+{
+public:
+    static constexpr int numChannels = 2;
+    static constexpr double minSeconds = 0.5;       // many refresh intervals, in case the reader stalls
+    static constexpr int minBlocks = 4;
+
+    struct ReadResult
+    {
+        int numSamples { 0 };
+        bool followsGap { false };          // samples were dropped since the previous read
+    };
+
+    // Not while the writer is running. Waits for a read in progress.
+    void prepare(double sampleRate, int maxBlockSize);
+
+    // Writer, wait-free. A mono buffer is written to both channels.
+    void write(const juce::AudioBuffer<float>& buffer);
+
+    // Reader. Copies up to dest's length into dest, which must have numChannels channels.
+    ReadResult read(juce::AudioBuffer<float>& dest);
+
+    // Reader. Skips everything written so far, and any gap with it.
+    void discardAll();
+
+    // Any thread
+    juce::uint32 getNumDroppedBlocks() const { return numDroppedBlocks.load(); }
+private:
+    juce::AbstractFifo fifo { 1 };
+    juce::AudioBuffer<float> samples;
+
+    // Between prepare() and the reader only; the writer never takes it
+    juce::CriticalSection readerLock;
+
+    std::atomic<juce::int64> lastGapPosition { 0 };
+    std::atomic<juce::uint32> numDroppedBlocks { 0 };
+
+    // Writer only
+    juce::int64 numWritten { 0 };
+    bool dropPending { false };
+
+    // Reader only
+    juce::int64 numRead { 0 };
+    juce::int64 gapSeen { 0 };
+    juce::int64 skipUntil { 0 };
+
+    bool takeGap();
+    void skip(int numToSkip);
+};
@@ -17,4 +17,12 @@ struct DefaultPropertyValues
     static const bool      peakHoldInf       = false;
     static const int       peakHoldDuration  = 500;
     static constexpr float goniometerScale   = 1.0f;
+    static const int       historyLength     = 3600;    // histogram frames kept in the plugin state, 0 = none
+    static const int       scopeTrigger      = 1;       // Oscilloscope::TriggerModes: 0 free, 1 zero crossing, 2 threshold level
+    static const int       scopeWindowMs     = 20;
+    static const int       waveformSeconds   = 60;
+    static const int       heatmapZoom       = 0;       // LevelHeatmap level, each step doubles the time per column
+    static const int       dynamicsWindowSeconds = 3;   // crest factor and PSR window
+    static const int       spectrumResolution = 0;      // StereoSpectrum::Resolutions: 0 linear, 1 multi-resolution
+    static const bool      renderReports     = false;   // write a log and report for every offline bounce
 };
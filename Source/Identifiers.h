@@ -20,6 +20,15 @@ namespace IDs
     DECLARE_ID (peakHoldInf)
     DECLARE_ID (peakHoldDuration)
     DECLARE_ID (goniometerScale)
+    DECLARE_ID (historyLength)
+    DECLARE_ID (scopeTrigger)
+    DECLARE_ID (scopeWindowMs)
+    DECLARE_ID (waveformSeconds)
+    DECLARE_ID (heatmapZoom)
+    DECLARE_ID (dynamicsWindowSeconds)
+    DECLARE_ID (spectrumResolution)
+    DECLARE_ID (renderReports)
+    DECLARE_ID (settingsChanged)    // notification only, never stored (see SettingsBatch)
 
 #undef DECLARE_ID
 
@@ -0,0 +1,185 @@
+//
+//  InputCapture.cpp
+//  PFM10 - Debug
+//
+
+#include "InputCapture.h"
+
+//==============================================================================
+//MARK: - InputCaptureHeader
+
+bool InputCaptureHeader::isValid() const
+{
+    return magic[0] == 'P' && magic[1] == 'F' && magic[2] == 'M' && magic[3] == 'C'
+        && version == currentVersion
+        && sampleRate > 0;
+}
+
+//==============================================================================
+//MARK: - InputCaptureWriter
+
+InputCaptureWriter::~InputCaptureWriter()
+{
+    stop();
+}
+
+bool InputCaptureWriter::start(const juce::File& file, double sampleRate)
+{
+    stop();
+
+    file.getParentDirectory().createDirectory();
+
+    // Truncated rather than deleted, the file may have been claimed for us
+    auto newStream = std::make_unique<juce::FileOutputStream>(file, streamBufferSize);
+
+    if (newStream->failedToOpen() || ! newStream->setPosition(0) || newStream->truncate().failed())
+        return false;
+
+    InputCaptureHeader header;
+    header.sampleRate = sampleRate;
+    newStream->write(&header, sizeof(header));
+
+    const juce::ScopedLock sl(lock);
+    stream = std::move(newStream);
+    startTimeMs = juce::Time::getMillisecondCounterHiRes();
+
+    return true;
+}
+
+void InputCaptureWriter::stop()
+{
+    const juce::ScopedLock sl(lock);
+
+    if (stream == nullptr)
+        return;
+
+    stream->flush();
+    stream.reset();
+}
+
+void InputCaptureWriter::writeDrain(const juce::AudioBuffer<float>& lastBlock, const PeakLevels& peakLevels, const LowEndLevels& lowEndLevels)
+{
+    const juce::ScopedLock sl(lock);
+
+    if (stream == nullptr)
+        return;
+
+    stream->writeInt(static_cast<int>(drainTag));
+    stream->writeDouble(juce::Time::getMillisecondCounterHiRes() - startTimeMs);
+    stream->writeFloat(peakLevels.magLeft);
+    stream->writeFloat(peakLevels.magRight);
+
+    for (float value : lowEndLevels.dcOffset)
+        stream->writeFloat(value);
+    for (float value : lowEndLevels.subsonicDb)
+        stream->writeFloat(value);
+
+    writeBlock(lastBlock);
+}
+
+void InputCaptureWriter::writeChunk(const juce::AudioBuffer<float>& chunk, bool followsGap)
+{
+    const juce::ScopedLock sl(lock);
+
+    if (stream == nullptr)
+        return;
+
+    stream->writeInt(static_cast<int>(chunkTag));
+    stream->writeInt(followsGap ? 1 : 0);
+    writeBlock(chunk);
+}
+
+void InputCaptureWriter::writeUpdate(bool silenceFed)
+{
+    const juce::ScopedLock sl(lock);
+
+    if (stream == nullptr)
+        return;
+
+    stream->writeInt(static_cast<int>(updateTag));
+    stream->writeDouble(juce::Time::getMillisecondCounterHiRes() - startTimeMs);
+    stream->writeInt(silenceFed ? 1 : 0);
+}
+
+void InputCaptureWriter::writeBlock(const juce::AudioBuffer<float>& block)
+{
+    auto numSamples = static_cast<size_t>(block.getNumSamples());
+
+    stream->writeInt(block.getNumChannels());
+    stream->writeInt(block.getNumSamples());
+
+    for (int ch = 0; ch < block.getNumChannels(); ++ch)
+        stream->write(block.getReadPointer(ch), numSamples * sizeof(float));
+}
+
+//==============================================================================
+//MARK: - InputCaptureReader
+
+InputCaptureReader::InputCaptureReader(const juce::File& file)
+    : stream(file)
+{
+    ok = stream.openedOk()
+      && stream.read(&header, sizeof(header)) == sizeof(header)
+      && header.isValid();
+}
+
+bool InputCaptureReader::readNext(InputCaptureRecord& record)
+{
+    if (! ok || stream.isExhausted())
+        return false;
+
+    record.tag = static_cast<juce::uint32>(stream.readInt());
+
+    if (record.tag == InputCaptureWriter::drainTag)
+    {
+        record.timeMs = stream.readDouble();
+
+        float magLeft  = stream.readFloat();
+        float magRight = stream.readFloat();
+        record.peakLevels = PeakLevels::fromMagnitudes(magLeft, magRight);
+
+        for (float& value : record.lowEndLevels.dcOffset)
+            value = stream.readFloat();
+        for (float& value : record.lowEndLevels.subsonicDb)
+            value = stream.readFloat();
+
+        if (readBlock(record.block))
+            return true;
+    }
+    else if (record.tag == InputCaptureWriter::chunkTag)
+    {
+        record.followsGap = stream.readInt() != 0;
+
+        if (readBlock(record.block))
+            return true;
+    }
+    else if (record.tag == InputCaptureWriter::updateTag)
+    {
+        record.timeMs = stream.readDouble();
+        record.silenceFed = stream.readInt() != 0;
+
+        return true;
+    }
+
+    ok = false;
+    return false;
+}
+
+bool InputCaptureReader::readBlock(juce::AudioBuffer<float>& block)
+{
+    int numChannels = stream.readInt();
+    int numSamples  = stream.readInt();
+
+    if (numChannels <= 0 || numChannels > 64 || numSamples < 0 || numSamples > (1 << 20))
+        return false;
+
+    block.setSize(numChannels, numSamples, false, false, true);
+
+    auto numBytes = static_cast<int>(static_cast<size_t>(numSamples) * sizeof(float));
+
+    for (int ch = 0; ch < numChannels; ++ch)
+        if (stream.read(block.getWritePointer(ch), numBytes) != numBytes)
+            return false;
+
+    return true;
+}
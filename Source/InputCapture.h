@@ -0,0 +1,107 @@
+//
+//  InputCapture.h
+//  PFM10 - Debug
+//
+//  Capture and replay of what the editor takes from the processor, in the
+//  order it takes it: each drain of audioBufferFifo in timerCallback, with
+//  the peak and low-end levels taken alongside it, every chunk update()
+//  reads from the history ring, gaps included, and each update() itself.
+//  Replaying a capture through the editor reproduces the meters, histories,
+//  histogram and goniometer exactly, independent of replay speed.
+//
+//  File layout (little-endian):
+//      InputCaptureHeader   16 bytes
+//      records, each starting with a uint32 tag:
+//          drainTag   double ms since the capture started,
+//                     float32 magLeft, magRight (the peak levels taken),
+//                     float32 dcOffset[2], subsonicDb[2],
+//                     then the last block pulled, as a block
+//          chunkTag   uint32 followsGap, then the samples read, as a block
+//          updateTag  double ms since the capture started, uint32 silenceFed
+//      where a block is uint32 numChannels, uint32 numSamples,
+//      float32 samples, one channel after the other
+//
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "MeterAnalysis.h"
+
+//==============================================================================
+//MARK: - InputCaptureHeader
+
+struct InputCaptureHeader
+{
+    static constexpr juce::uint32 currentVersion = 2;
+
+    char magic[4] { 'P', 'F', 'M', 'C' };
+    juce::uint32 version { currentVersion };
+    double sampleRate { 0.0 };
+
+    bool isValid() const;
+};
+
+static_assert(sizeof(InputCaptureHeader) == 16, "InputCaptureHeader is part of the file format");
+
+//==============================================================================
+//MARK: - InputCaptureWriter
+
+// The message thread writes the drains and the update thread the chunks and
+// updates, so every write takes a lock. Writes go through a large buffer, and
+// the occasional disk write lands on either thread - fine for a debug build.
+class InputCaptureWriter
+{
+public:
+    static constexpr juce::uint32 drainTag  = 0x4e415244;  // "DRAN"
+    static constexpr juce::uint32 chunkTag  = 0x4b4e4843;  // "CHNK"
+    static constexpr juce::uint32 updateTag = 0x54445055;  // "UPDT"
+    static constexpr size_t streamBufferSize = 1 << 18;
+
+    ~InputCaptureWriter();
+
+    bool start(const juce::File& file, double sampleRate);
+    void stop();
+
+    void writeDrain(const juce::AudioBuffer<float>& lastBlock, const PeakLevels& peakLevels, const LowEndLevels& lowEndLevels);
+    void writeChunk(const juce::AudioBuffer<float>& chunk, bool followsGap);
+    void writeUpdate(bool silenceFed);
+private:
+    juce::CriticalSection lock;
+    std::unique_ptr<juce::FileOutputStream> stream;
+    double startTimeMs { 0 };
+
+    void writeBlock(const juce::AudioBuffer<float>& block);
+};
+
+//==============================================================================
+//MARK: - InputCaptureReader
+
+struct InputCaptureRecord
+{
+    juce::uint32 tag { 0 };
+
+    double timeMs { 0 };                // drain and update
+    PeakLevels peakLevels;              // drain
+    LowEndLevels lowEndLevels;          // drain
+    juce::AudioBuffer<float> block;     // drain: the last block pulled, chunk: the samples read
+    bool followsGap { false };          // chunk
+    bool silenceFed { false };          // update
+};
+
+class InputCaptureReader
+{
+public:
+    explicit InputCaptureReader(const juce::File& file);
+
+    bool openedOk() const { return ok; }
+    const InputCaptureHeader& getHeader() const { return header; }
+
+    // Returns false at the end of the capture, or at the first damaged record.
+    bool readNext(InputCaptureRecord& record);
+private:
+    juce::FileInputStream stream;
+    InputCaptureHeader header;
+    bool ok { false };
+
+    bool readBlock(juce::AudioBuffer<float>& block);
+};
@@ -0,0 +1,73 @@
+//
+//  InstanceRegistry.cpp
+//  PFM10
+//
+
+#include "InstanceRegistry.h"
+
+//==============================================================================
+//MARK: - InstanceSlot
+
+void InstanceSlot::publishBlock(const BlockSummary& summary)
+{
+    if (summary.numSamples == 0)
+        return;
+
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        auto index = static_cast<size_t>(ch);
+
+        rms[index].store(summary.getRms(ch), std::memory_order_relaxed);
+        storeMax(peak[index], summary.magnitude[index]);
+    }
+}
+
+void InstanceSlot::setName(const juce::String& newName)
+{
+    const juce::SpinLock::ScopedLockType lock(nameLock);
+    name = newName;
+}
+
+juce::String InstanceSlot::getName() const
+{
+    const juce::SpinLock::ScopedLockType lock(nameLock);
+    return name;
+}
+
+//==============================================================================
+//MARK: - InstanceRegistry
+
+InstanceSlot* InstanceRegistry::acquireSlot()
+{
+    for (auto& slot : slots)
+    {
+        bool expected = false;
+
+        if (slot.inUse.compare_exchange_strong(expected, true))
+        {
+            for (int ch = 0; ch < InstanceSlot::numChannels; ++ch)
+            {
+                slot.peak[static_cast<size_t>(ch)] = 0.f;
+                slot.rms[static_cast<size_t>(ch)] = 0.f;
+            }
+
+            slot.setName("PFM10 " + juce::String(++numCreated));
+            ++slot.generation;
+
+            return &slot;
+        }
+    }
+
+    return nullptr;
+}
+
+void InstanceRegistry::releaseSlot(InstanceSlot* slot)
+{
+    if (slot != nullptr)
+        slot->inUse = false;
+}
+
+InstanceSlot* InstanceRegistry::getSlot(int index)
+{
+    return juce::isPositiveAndBelow(index, maxInstances) ? &slots[static_cast<size_t>(index)] : nullptr;
+}
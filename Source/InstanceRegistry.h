@@ -0,0 +1,70 @@
+//
+//  InstanceRegistry.h
+//  PFM10
+//
+//  Process-wide list of the PFM10 instances that are alive, for the
+//  overview window. Each processor claims a slot and publishes its block
+//  levels into it from the audio thread. The overview reads every slot from
+//  one timer, so instances cost it no timers or messages of their own.
+//
+//  Shared through juce::SharedResourcePointer: the registry lives as long as
+//  at least one processor does.
+//
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include "MeterAnalysis.h"
+
+//==============================================================================
+//MARK: - InstanceSlot
+
+struct InstanceSlot
+{
+    static constexpr int numChannels = 2;
+
+    std::atomic<bool> inUse { false };
+
+    // Bumped every time the slot is claimed, so a reader can tell a new
+    // instance from the one that had the slot before it
+    std::atomic<juce::uint32> generation { 0 };
+
+    // Magnitudes. peak is the maximum since a reader last took it, rms is the last block's.
+    std::array<std::atomic<float>, numChannels> peak {};
+    std::array<std::atomic<float>, numChannels> rms {};
+
+    // Audio thread, lock-free
+    void publishBlock(const BlockSummary& summary);
+
+    // Reader side: returns the peak since the previous call and starts a new one
+    float takePeak(int channel) { return peak[static_cast<size_t>(channel)].exchange(0.f); }
+
+    void setName(const juce::String& newName);
+    juce::String getName() const;
+private:
+    mutable juce::SpinLock nameLock;
+    juce::String name;
+};
+
+//==============================================================================
+//MARK: - InstanceRegistry
+
+class InstanceRegistry
+{
+public:
+    static constexpr int maxInstances = 256;
+
+    // Returns nullptr when every slot is taken, the instance then simply isn't listed
+    InstanceSlot* acquireSlot();
+    void releaseSlot(InstanceSlot* slot);
+
+    InstanceSlot* getSlot(int index);
+    int getNumSlots() const { return maxInstances; }
+
+    // The overview window, created on demand and torn down with the registry. Message thread only.
+    std::unique_ptr<juce::Component> overviewWindow;
+private:
+    std::array<InstanceSlot, maxInstances> slots;
+    std::atomic<juce::uint32> numCreated { 0 };
+};
@@ -0,0 +1,184 @@
+//
+//  LevelHeatmap.cpp
+//  PFM10 - Shared Code
+//
+
+#include "LevelHeatmap.h"
+
+LevelHeatmap::LevelHeatmap() = default;
+
+void LevelHeatmap::prepare(double sampleRate)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto samplesPerColumn = juce::jmax(juce::int64(1), static_cast<juce::int64>(std::llround(sampleRate * secondsPerColumn)));
+
+    // Columns of a different length can't carry on where the old ones left off
+    if (samplesPerColumn != samplesPerBaseColumn)
+        numSamples = 0;
+
+    samplesPerBaseColumn = samplesPerColumn;
+    fifo.reset();
+    numSamplesDropped = 0;
+}
+
+void LevelHeatmap::pushBlock(float db, int numSamplesInBlock)
+{
+    if (numSamplesInBlock <= 0)
+        return;
+
+    auto scopedWrite = fifo.write(1);
+    if (scopedWrite.blockSize1 == 0)
+    {
+        numSamplesDropped += numSamplesInBlock;
+        return;
+    }
+
+    auto& block = pushedBlocks[static_cast<size_t>(scopedWrite.startIndex1)];
+    block.db = db;
+    block.numSamples = numSamplesInBlock;
+    block.numSamplesDroppedBefore = numSamplesDropped;
+    numSamplesDropped = 0;
+}
+
+void LevelHeatmap::drain()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto scopedRead = fifo.read(fifo.getNumReady());
+
+    auto addRange = [this](int start, int size)
+    {
+        for (int i = start; i < start + size; ++i)
+        {
+            const auto& block = pushedBlocks[static_cast<size_t>(i)];
+            add(NEGATIVE_INFINITY, block.numSamplesDroppedBefore, false);
+            add(block.db, block.numSamples, true);
+        }
+    };
+
+    addRange(scopedRead.startIndex1, scopedRead.blockSize1);
+    addRange(scopedRead.startIndex2, scopedRead.blockSize2);
+}
+
+void LevelHeatmap::addBlock(float db, int numSamplesInBlock)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    add(db, numSamplesInBlock, true);
+}
+
+void LevelHeatmap::add(float db, juce::int64 numSamplesToAdd, bool hasLevel)
+{
+    // Nothing until something is drained or added, so a processor whose editor never opens doesn't hold the columns
+    if (levels.empty())
+        levels.assign(numLevels, std::vector<Column>(columnsPerLevel));
+
+    auto bin = static_cast<size_t>(MeterStatistics::levelToBin(db));
+
+    // A block can straddle column boundaries; a long stretch with no level can cover many columns
+    while (numSamplesToAdd > 0)
+    {
+        juce::int64 column = numSamples / samplesPerBaseColumn;
+        juce::int64 intoColumn = numSamples % samplesPerBaseColumn;
+
+        // First sample of a level-0 column: every column it opens on the levels above starts from zero
+        if (intoColumn == 0)
+        {
+            for (int level = 0; level < numLevels && (column & ((juce::int64(1) << level) - 1)) == 0; ++level)
+                getSlot(level, column >> level).fill(0);
+        }
+
+        auto numInColumn = juce::jmin(numSamplesToAdd, samplesPerBaseColumn - intoColumn);
+
+        if (hasLevel)
+            getSlot(0, column)[bin] += static_cast<juce::uint32>(numInColumn);
+
+        numSamples += numInColumn;
+        numSamplesToAdd -= numInColumn;
+
+        if (numSamples % samplesPerBaseColumn == 0)
+            finishColumn(0, column);
+    }
+}
+
+void LevelHeatmap::clear()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    numSamples = 0;
+}
+
+juce::int64 LevelHeatmap::getNumColumns(int level) const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return getNumColumnsLocked(level);
+}
+
+juce::int64 LevelHeatmap::getNumColumnsLocked(int level) const
+{
+    juce::int64 samplesPerColumn = getSamplesPerColumn(level);
+    return (numSamples + samplesPerColumn - 1) / samplesPerColumn;
+}
+
+void LevelHeatmap::getColumns(int level, juce::int64 firstColumn, int numColumns, std::vector<Column>& columns) const
+{
+    columns.assign(static_cast<size_t>(juce::jmax(0, numColumns)), Column());
+
+    if (level < 0 || level >= numLevels)
+        return;
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    juce::int64 total = getNumColumnsLocked(level);
+    juce::int64 oldestKept = juce::jmax(juce::int64(0), total - columnsPerLevel);
+
+    for (int i = 0; i < numColumns; ++i)
+    {
+        juce::int64 column = firstColumn + i;
+        if (column < oldestKept || column >= total)
+            continue;
+
+        auto& counts = columns[static_cast<size_t>(i)];
+        counts = getSlot(level, column);
+
+        if (column < total - 1 || numSamples % getSamplesPerColumn(level) == 0)
+            continue;
+
+        // The open column: add the open columns below it, which haven't been passed up yet
+        for (int finer = level - 1; finer >= 0; --finer)
+        {
+            juce::int64 samplesPerColumn = getSamplesPerColumn(finer);
+            if (numSamples % samplesPerColumn == 0)
+                continue;
+
+            const auto& open = getSlot(finer, numSamples / samplesPerColumn);
+            for (size_t bin = 0; bin < counts.size(); ++bin)
+                counts[bin] += open[bin];
+        }
+    }
+}
+
+LevelHeatmap::Column& LevelHeatmap::getSlot(int level, juce::int64 column)
+{
+    return levels[static_cast<size_t>(level)][static_cast<size_t>(column % columnsPerLevel)];
+}
+
+const LevelHeatmap::Column& LevelHeatmap::getSlot(int level, juce::int64 column) const
+{
+    return levels[static_cast<size_t>(level)][static_cast<size_t>(column % columnsPerLevel)];
+}
+
+void LevelHeatmap::finishColumn(int level, juce::int64 column)
+{
+    if (level + 1 >= numLevels)
+        return;
+
+    const auto& finished = getSlot(level, column);
+    auto& parent = getSlot(level + 1, column >> 1);
+
+    for (size_t bin = 0; bin < parent.size(); ++bin)
+        parent[bin] += finished[bin];
+
+    // The second child closes its parent
+    if ((column & 1) != 0)
+        finishColumn(level + 1, column >> 1);
+}
@@ -0,0 +1,96 @@
+//
+//  LevelHeatmap.h
+//  PFM10 - Shared Code
+//
+//  Level distribution over time: one column per stretch of audio, each
+//  column a count of samples per 1 dB bin (the MeterStatistics bins), the
+//  level being the block's mono peak.
+//
+//  Level 0 closes a column every secondsPerColumn of audio. A finished column
+//  is added into its parent on the level above, so level n column k is the
+//  sum of level 0 columns k << n up to (k + 1) << n. Every level keeps the
+//  newest columnsPerLevel columns, so coarser levels reach further back.
+//  A block only touches the open level-0 columns, and a finished column only
+//  touches its parent; nothing is re-summed when the view zooms out.
+//
+//  The processor pushes every block's level, wait-free, and drain() moves
+//  them into the columns. Blocks that don't fit in the queue are kept as
+//  time with no level, so the columns stay in step with the audio and show
+//  a blank stretch instead of closing up.
+//
+//  Thread-safe apart from pushBlock(), which only the audio thread calls.
+//
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <vector>
+#include "MeterAnalysis.h"
+
+class LevelHeatmap
+{
+public:
+    static constexpr int numBins = MeterStatistics::numLevelBins;
+    static constexpr int numLevels = 8;
+    static constexpr int columnsPerLevel = 1024;
+    static constexpr int secondsPerColumn = 1;      // level 0
+    static constexpr int queueSize = 4096;          // blocks, some seconds even at small block sizes
+
+    using Column = std::array<juce::uint32, numBins>;
+
+    LevelHeatmap();
+
+    // Not while the audio thread pushes. A new sample rate starts the columns over.
+    void prepare(double sampleRate);
+
+    // Audio thread, wait-free
+    void pushBlock(float db, int numSamples);
+
+    // Moves the pushed blocks into the columns
+    void drain();
+
+    // Adds a block directly, bypassing the queue
+    void addBlock(float db, int numSamples);
+    void clear();
+
+    int getSecondsPerColumn(int level) const { return secondsPerColumn << level; }
+
+    // Columns started so far at this level, the newest one possibly still open
+    juce::int64 getNumColumns(int level) const;
+
+    /* Copies columns firstColumn up to firstColumn + numColumns of one level.
+       The open column includes the samples its finer levels haven't passed
+       up yet. Columns that are no longer kept, or haven't started, come back
+       zeroed.
+     */
+    void getColumns(int level, juce::int64 firstColumn, int numColumns, std::vector<Column>& columns) const;
+private:
+    mutable std::mutex mutex;
+
+    juce::int64 samplesPerBaseColumn { 44100 };
+    juce::int64 numSamples { 0 };
+
+    // levels[n]: ring of columnsPerLevel columns, about 2.5 MB in all,
+    // allocated by the first add() rather than in every processor
+    std::vector<std::vector<Column>> levels;
+
+    // Written by the audio thread, read under the mutex
+    struct PushedBlock
+    {
+        float db { NEGATIVE_INFINITY };
+        int numSamples { 0 };
+        juce::int64 numSamplesDroppedBefore { 0 };
+    };
+
+    juce::AbstractFifo fifo { queueSize };
+    std::array<PushedBlock, queueSize> pushedBlocks;
+    juce::int64 numSamplesDropped { 0 };    // audio thread only
+
+    void add(float db, juce::int64 numSamplesToAdd, bool hasLevel);
+
+    Column& getSlot(int level, juce::int64 column);
+    const Column& getSlot(int level, juce::int64 column) const;
+    juce::int64 getSamplesPerColumn(int level) const { return samplesPerBaseColumn << level; }
+    juce::int64 getNumColumnsLocked(int level) const;
+    void finishColumn(int level, juce::int64 column);
+};
@@ -0,0 +1,1375 @@
+//
+//  MeterAnalysis.cpp
+//  PFM10 - Shared Code
+//
+
+#include "MeterAnalysis.h"
+
+//==============================================================================
+//MARK: - Averager
+
+template<typename T>
+Averager<T>::Averager(size_t _numElements, T _initialValue)
+{
+    resize(_numElements, _initialValue);
+}
+
+template<typename T>
+void Averager<T>::resize(size_t numElements, T initialValue)
+{
+    elements.resize(numElements);
+    clear(initialValue);
+}
+
+template<typename T>
+void Averager<T>::clear(T initialValue)
+{
+    size_t numElements = elements.size();
+    for (size_t i = 0; i < numElements; i++)
+    {
+        elements[i] = initialValue;
+    }
+
+    writeIndex = 0;
+    avg = initialValue;
+    sum = static_cast<T>(initialValue * numElements);
+}
+
+template<typename T>
+void Averager<T>::add(T t)
+{
+    // First, cache the atomics as local variables to work with
+    auto writeIndexTemp = writeIndex.load();
+    auto sumTemp = sum.load();
+
+    sumTemp -= elements[writeIndexTemp];
+    sumTemp += t;
+
+    elements[writeIndexTemp] = t;
+
+    ++writeIndexTemp;
+    if (writeIndexTemp > (elements.size() - 1))
+    {
+        writeIndexTemp = 0;
+    }
+
+    writeIndex = writeIndexTemp;
+    sum = sumTemp;
+    avg = sumTemp / static_cast<T>(elements.size());
+}
+
+template struct Averager<float>;
+template struct Averager<double>;
+
+//==============================================================================
+//MARK: - WindowedMean
+
+void WindowedMean::resize(size_t numElements, float initialValue)
+{
+    elements.resize(juce::jmax(size_t(1), numElements));
+    clear(initialValue);
+}
+
+void WindowedMean::clear(float initialValue)
+{
+    std::fill(elements.begin(), elements.end(), initialValue);
+    writeIndex = 0;
+}
+
+void WindowedMean::add(float value)
+{
+    elements[writeIndex] = value;
+    writeIndex = (writeIndex + 1) % elements.size();
+}
+
+double WindowedMean::getMean() const
+{
+    double sum = 0.0;
+
+    for (size_t i = writeIndex; i < elements.size(); ++i)
+        sum += elements[i];
+    for (size_t i = 0; i < writeIndex; ++i)
+        sum += elements[i];
+
+    return sum / static_cast<double>(elements.size());
+}
+
+//==============================================================================
+//MARK: - SlidingWindowExtreme
+
+template<typename T, typename Compare>
+void SlidingWindowExtreme<T, Compare>::setWindowLength(size_t length)
+{
+    windowLength = juce::jmax(size_t(1), length);
+    ring.assign(windowLength, Entry());
+    clear();
+}
+
+template<typename T, typename Compare>
+void SlidingWindowExtreme<T, Compare>::clear()
+{
+    head = 0;
+    numEntries = 0;
+    numPushed = 0;
+}
+
+template<typename T, typename Compare>
+void SlidingWindowExtreme<T, Compare>::push(T value)
+{
+    if (ring.empty())
+        setWindowLength(windowLength);
+
+    auto size = ring.size();
+
+    // Drop the oldest once it has slid out of the window
+    if (numEntries > 0 && ring[head].index <= numPushed - static_cast<juce::int64>(windowLength))
+    {
+        head = (head + 1) % size;
+        --numEntries;
+    }
+
+    // Nothing that isn't more extreme than the new value can ever be the extreme again
+    Compare isMoreExtreme;
+    while (numEntries > 0 && ! isMoreExtreme(ring[(head + numEntries - 1) % size].value, value))
+        --numEntries;
+
+    ring[(head + numEntries) % size] = { value, numPushed };
+    ++numEntries;
+    ++numPushed;
+}
+
+template struct SlidingWindowExtreme<float, std::greater<float>>;
+template struct SlidingWindowExtreme<float, std::less<float>>;
+
+//==============================================================================
+//MARK: - DecayingValue
+
+void DecayingValue::update(float input, juce::int64 nowMs)
+{
+    if (input > heldValue.load())
+    {
+        peakTime = nowMs;
+        heldValue = input;
+    }
+}
+
+void DecayingValue::decay(juce::int64 nowMs, float elapsedMs)
+{
+    if (holdForInf.load())
+        return;
+
+    if ((nowMs - peakTime.load()) > holdTimeMs.load())
+    {
+        float decayed = heldValue.load() - decayRateDbPerSec.load() * elapsedMs / 1000.f;
+
+        heldValue = juce::jlimit(NEGATIVE_INFINITY,
+                                 MAX_DECIBELS,
+                                 decayed);
+    }
+}
+
+//==============================================================================
+//MARK: - CorrelationAnalyser
+
+void CorrelationAnalyser::prepare(double sampleRate)
+{
+    // Initialize moving-average windows via FIR low-pass filters
+
+    using FilterDesign = juce::dsp::FilterDesign<float>;
+    using WindowingMethod = juce::dsp::WindowingFunction<float>::WindowingMethod;
+
+    FilterDesign::FIRCoefficientsPtr coefficientsPtr( FilterDesign::designFIRLowpassWindowMethod(10.f, //frequency
+                                                                                                 sampleRate,
+                                                                                                 1, //order
+                                                                                                 WindowingMethod::rectangular) );
+
+    for (juce::dsp::FIR::Filter<float> &filter : filters)
+    {
+        filter = juce::dsp::FIR::Filter<float>(coefficientsPtr);
+    }
+}
+
+void CorrelationAnalyser::reset()
+{
+    for (juce::dsp::FIR::Filter<float> &filter : filters)
+    {
+        filter.reset();
+    }
+}
+
+float CorrelationAnalyser::processSample(float leftSample, float rightSample)
+{
+    float numerator = filters[0].processSample( leftSample * rightSample );
+    float denominator = sqrt( filters[1].processSample(juce::square(leftSample))
+                            * filters[2].processSample(juce::square(rightSample)) );
+    float c = numerator / denominator;
+
+    if ( std::isnan(c) || std::isinf(c) )
+        return 0.f;
+
+    return c;
+}
+
+//==============================================================================
+//MARK: - MidSideSums
+
+namespace
+{
+    float energyRatioToDb(double numerator, double denominator)
+    {
+        if (numerator <= 0.0)
+            return NEGATIVE_INFINITY;
+        if (denominator <= 0.0)
+            return MAX_DECIBELS;
+
+        return juce::jlimit(NEGATIVE_INFINITY, MAX_DECIBELS, static_cast<float>(10.0 * std::log10(numerator / denominator)));
+    }
+}
+
+float MidSideSums::getWidthDb() const
+{
+    if (isSilent())
+        return NEGATIVE_INFINITY;
+
+    return energyRatioToDb(sideSquared, midSquared);
+}
+
+float MidSideSums::getBalanceDb() const
+{
+    if (isSilent())
+        return 0.f;
+
+    double total = midSquared + sideSquared;
+    double left  = (total + 2.0 * midSide) / 2.0;
+    double right = (total - 2.0 * midSide) / 2.0;
+
+    // One side silent: pinned to that end of the scale
+    if (left <= 0.0)
+        return -MAX_DECIBELS;
+
+    return energyRatioToDb(left, right);
+}
+
+float MidSideSums::getMonoLossDb() const
+{
+    if (isSilent())
+        return NEGATIVE_INFINITY;
+
+    return energyRatioToDb(midSquared + sideSquared, midSquared);
+}
+
+//==============================================================================
+//MARK: - KWeightingFilter
+
+void KWeightingFilter::prepare(double sampleRate)
+{
+    using Coefficients = juce::dsp::IIR::Coefficients<double>;
+
+    // Stage 1: high shelf, +4 dB above ~1.7 kHz
+    {
+        const double f0 = 1681.974450955533;
+        const double G  = 3.999843853973347;
+        const double Q  = 0.7071752369554196;
+
+        const double K  = std::tan(juce::MathConstants<double>::pi * f0 / sampleRate);
+        const double Vh = std::pow(10.0, G / 20.0);
+        const double Vb = std::pow(Vh, 0.4996667741545416);
+        const double a0 = 1.0 + K / Q + K * K;
+
+        preFilter.coefficients = new Coefficients((Vh + Vb * K / Q + K * K) / a0,
+                                                  2.0 * (K * K - Vh) / a0,
+                                                  (Vh - Vb * K / Q + K * K) / a0,
+                                                  1.0,
+                                                  2.0 * (K * K - 1.0) / a0,
+                                                  (1.0 - K / Q + K * K) / a0);
+    }
+
+    // Stage 2: RLB high-pass at ~38 Hz
+    {
+        const double f0 = 38.13547087602444;
+        const double Q  = 0.5003270373238773;
+
+        const double K  = std::tan(juce::MathConstants<double>::pi * f0 / sampleRate);
+        const double a0 = 1.0 + K / Q + K * K;
+
+        highPass.coefficients = new Coefficients(1.0,
+                                                 -2.0,
+                                                 1.0,
+                                                 1.0,
+                                                 2.0 * (K * K - 1.0) / a0,
+                                                 (1.0 - K / Q + K * K) / a0);
+    }
+
+    reset();
+}
+
+void KWeightingFilter::reset()
+{
+    preFilter.reset();
+    highPass.reset();
+}
+
+//==============================================================================
+//MARK: - LoudnessGating
+
+LoudnessGating::LoudnessGating()
+{
+    reset();
+}
+
+void LoudnessGating::reset()
+{
+    blockEnergies.clear();
+
+    numHead = 0;
+    numTail = 0;
+    numSubBlocks = 0;
+}
+
+void LoudnessGating::addSubBlock(double meanSquare)
+{
+    if (numHead < edgeSize)
+        head[static_cast<size_t>(numHead++)] = meanSquare;
+
+    if (numTail == edgeSize)
+        addBlock((tail[0] + tail[1] + tail[2] + meanSquare) / subBlocksPerBlock);
+
+    pushTail(meanSquare);
+    ++numSubBlocks;
+}
+
+void LoudnessGating::merge(const LoudnessGating& later)
+{
+    // Blocks that straddle the seam: our last sub-blocks followed by their first ones
+    std::array<double, edgeSize * 2> seam {};
+    int seamSize = 0;
+
+    for (int i = 0; i < numTail; ++i)       seam[static_cast<size_t>(seamSize++)] = tail[static_cast<size_t>(i)];
+    for (int i = 0; i < later.numHead; ++i) seam[static_cast<size_t>(seamSize++)] = later.head[static_cast<size_t>(i)];
+
+    for (int start = 0; start < numTail && start + subBlocksPerBlock <= seamSize; ++start)
+    {
+        double sum = 0.0;
+        for (int i = start; i < start + subBlocksPerBlock; ++i)
+            sum += seam[static_cast<size_t>(i)];
+
+        addBlock(sum / subBlocksPerBlock);
+    }
+
+    blockEnergies.insert(blockEnergies.end(), later.blockEnergies.begin(), later.blockEnergies.end());
+
+    // Only short stretches (< 3 sub-blocks) need their neighbours' edges carried over
+    for (int i = 0; i < later.numHead && numHead < edgeSize; ++i)
+        head[static_cast<size_t>(numHead++)] = later.head[static_cast<size_t>(i)];
+
+    for (int i = 0; i < later.numTail; ++i)
+        pushTail(later.tail[static_cast<size_t>(i)]);
+
+    numSubBlocks += later.numSubBlocks;
+}
+
+float LoudnessGating::getIntegratedLufs() const
+{
+    // Absolute gate: only blocks above it were ever kept
+    if (blockEnergies.empty())
+        return absoluteGateLufs;
+
+    double energy = 0.0;
+    for (auto blockEnergy : blockEnergies)
+        energy += blockEnergy;
+
+    // Relative gate, in the energy domain: 10 LU below the loudness of the blocks above the absolute gate
+    double relativeGateEnergy = energy / static_cast<double>(blockEnergies.size()) * std::pow(10.0, relativeGateLu / 10.0);
+
+    juce::int64 count = 0;
+    energy = 0.0;
+
+    for (auto blockEnergy : blockEnergies)
+    {
+        if (blockEnergy > relativeGateEnergy)
+        {
+            ++count;
+            energy += blockEnergy;
+        }
+    }
+
+    if (count == 0)
+        return absoluteGateLufs;
+
+    return energyToLufs(energy / static_cast<double>(count));
+}
+
+juce::int64 LoudnessGating::getNumBlocks() const
+{
+    return static_cast<juce::int64>(blockEnergies.size());
+}
+
+float LoudnessGating::energyToLufs(double meanSquare)
+{
+    if (meanSquare <= 0.0)
+        return -std::numeric_limits<float>::infinity();
+
+    return static_cast<float>(-0.691 + 10.0 * std::log10(meanSquare));
+}
+
+void LoudnessGating::addBlock(double meanSquare)
+{
+    if (energyToLufs(meanSquare) <= absoluteGateLufs)
+        return;
+
+    blockEnergies.push_back(meanSquare);
+}
+
+void LoudnessGating::pushTail(double meanSquare)
+{
+    if (numTail == edgeSize)
+    {
+        tail[0] = tail[1];
+        tail[1] = tail[2];
+        --numTail;
+    }
+
+    tail[static_cast<size_t>(numTail++)] = meanSquare;
+}
+
+//==============================================================================
+//MARK: - LoudnessHistogram
+
+void LoudnessHistogram::reset()
+{
+    binCounts.fill(0);
+    binEnergies.fill(0.0);
+    totalCount = 0;
+    totalEnergy = 0.0;
+    numTail = 0;
+}
+
+void LoudnessHistogram::addSubBlock(double meanSquare)
+{
+    if (numTail == edgeSize)
+    {
+        double blockEnergy = (tail[0] + tail[1] + tail[2] + meanSquare) / LoudnessGating::subBlocksPerBlock;
+        float blockLufs = LoudnessGating::energyToLufs(blockEnergy);
+
+        if (blockLufs > LoudnessGating::absoluteGateLufs)
+        {
+            auto bin = static_cast<size_t>(juce::jlimit(0, numBins - 1, static_cast<int>((blockLufs - LoudnessGating::absoluteGateLufs) / binWidthLu)));
+            ++binCounts[bin];
+            binEnergies[bin] += blockEnergy;
+            ++totalCount;
+            totalEnergy += blockEnergy;
+        }
+
+        tail[0] = tail[1];
+        tail[1] = tail[2];
+        --numTail;
+    }
+
+    tail[static_cast<size_t>(numTail++)] = meanSquare;
+}
+
+float LoudnessHistogram::getIntegratedLufs() const
+{
+    if (totalCount == 0)
+        return LoudnessGating::absoluteGateLufs;
+
+    double relativeGateEnergy = totalEnergy / static_cast<double>(totalCount) * std::pow(10.0, LoudnessGating::relativeGateLu / 10.0);
+
+    juce::int64 count = 0;
+    double energy = 0.0;
+
+    for (size_t bin = 0; bin < binCounts.size(); ++bin)
+    {
+        if (binCounts[bin] > 0 && binEnergies[bin] > relativeGateEnergy * static_cast<double>(binCounts[bin]))
+        {
+            count += binCounts[bin];
+            energy += binEnergies[bin];
+        }
+    }
+
+    if (count == 0)
+        return LoudnessGating::absoluteGateLufs;
+
+    return LoudnessGating::energyToLufs(energy / static_cast<double>(count));
+}
+
+//==============================================================================
+//MARK: - PeakLevels
+
+PeakLevels PeakLevels::fromBuffer(const juce::AudioBuffer<float>& buffer, int startSample, int numSamples)
+{
+    int numChannels = buffer.getNumChannels();
+
+    if (numChannels == 0 || numSamples <= 0)
+        return PeakLevels();
+
+    float magLeft  = buffer.getMagnitude(0, startSample, numSamples);
+    float magRight = (numChannels > 1) ? buffer.getMagnitude(1, startSample, numSamples) : magLeft;
+
+    return fromMagnitudes(magLeft, magRight);
+}
+
+PeakLevels PeakLevels::fromMagnitudes(float magLeft, float magRight)
+{
+    PeakLevels levels;
+
+    levels.magLeft  = magLeft;
+    levels.magRight = magRight;
+    levels.dbLeft   = juce::Decibels::gainToDecibels(magLeft,  NEGATIVE_INFINITY);
+    levels.dbRight  = juce::Decibels::gainToDecibels(magRight, NEGATIVE_INFINITY);
+
+    // Mono level is the avg. of the left and right channel magnitudes
+    levels.dbMono   = juce::Decibels::gainToDecibels((magLeft + magRight) / 2, NEGATIVE_INFINITY);
+
+    return levels;
+}
+
+//==============================================================================
+//MARK: - BlockSummary
+
+BlockSummary BlockSummary::fromBuffer(const juce::AudioBuffer<float>& buffer)
+{
+    return fromBuffer(buffer, 0, buffer.getNumSamples());
+}
+
+BlockSummary BlockSummary::fromBuffer(const juce::AudioBuffer<float>& buffer, int startSample, int numSamples)
+{
+    BlockSummary summary;
+    summary.numSamples = numSamples;
+
+    int numBufferChannels = buffer.getNumChannels();
+    if (numBufferChannels == 0 || summary.numSamples == 0)
+        return summary;
+
+    for (int ch = 0; ch < juce::jmin(numChannels, numBufferChannels); ++ch)
+    {
+        auto index = static_cast<size_t>(ch);
+        const float* samples = buffer.getReadPointer(ch, startSample);
+
+        // Vectorised min/max for the peak, then one pass for the energy
+        summary.magnitude[index] = buffer.getMagnitude(ch, startSample, summary.numSamples);
+
+        double sum = 0.0;
+        for (int i = 0; i < summary.numSamples; ++i)
+            sum += static_cast<double>(samples[i]) * samples[i];
+
+        summary.sumOfSquares[index] = sum;
+    }
+
+    if (numBufferChannels == 1)
+    {
+        summary.magnitude[1] = summary.magnitude[0];
+        summary.sumOfSquares[1] = summary.sumOfSquares[0];
+    }
+
+    return summary;
+}
+
+float BlockSummary::getRms(int channel) const
+{
+    if (numSamples == 0)
+        return 0.f;
+
+    return static_cast<float>(std::sqrt(sumOfSquares[static_cast<size_t>(channel)] / numSamples));
+}
+
+//==============================================================================
+//MARK: - PeakTracker
+
+void PeakTracker::prepare(double sampleRate)
+{
+    dcCoefficient = 1.0 - std::exp(-1.0 / (dcTimeConstantSeconds * sampleRate));
+    meanSquareCoefficient = 1.0 - std::exp(-1.0 / (subsonicTimeConstantSeconds * sampleRate));
+
+    // RBJ low-passes with the Butterworth Qs for 4th order, 1 / (2 cos(pi/8)) and 1 / (2 cos(3pi/8))
+    double w0 = juce::MathConstants<double>::twoPi * subsonicCutoffHz / sampleRate;
+    double cosW0 = std::cos(w0);
+
+    for (size_t s = 0; s < sections.size(); ++s)
+    {
+        double angle = juce::MathConstants<double>::pi * (2 * s + 1) / (4 * numSubsonicSections);
+        double q = 1.0 / (2.0 * std::cos(angle));
+        double alpha = std::sin(w0) / (2.0 * q);
+        double a0 = 1.0 + alpha;
+
+        auto& section = sections[s];
+        section.b0 = (1.0 - cosW0) / 2.0 / a0;
+        section.b1 = (1.0 - cosW0) / a0;
+        section.b2 = section.b0;
+        section.a1 = -2.0 * cosW0 / a0;
+        section.a2 = (1.0 - alpha) / a0;
+    }
+
+    resetLowEnd();
+}
+
+void PeakTracker::resetLowEnd()
+{
+    lowEnd = LowEndState();
+
+    for (size_t ch = 0; ch < numChannels; ++ch)
+    {
+        dcOffset[ch] = 0.f;
+        subsonicMeanSquare[ch] = 0.f;
+    }
+}
+
+void PeakTracker::process(const juce::AudioBuffer<float>& buffer, const BlockSummary& summary, bool runLowEnd)
+{
+    int numSamples = buffer.getNumSamples();
+    if (buffer.getNumChannels() == 0 || numSamples == 0)
+        return;
+
+    for (size_t ch = 0; ch < numChannels; ++ch)
+        storeMax(peak[ch], summary.magnitude[ch]);
+
+    // Whatever the filters held from before they stopped doesn't belong to this audio
+    if (runLowEnd && ! lowEndRunning)
+        resetLowEnd();
+
+    lowEndRunning = runLowEnd;
+    if (! runLowEnd)
+        return;
+
+    // A mono buffer reports the same level on both sides
+    processLowEnd(buffer.getReadPointer(0), buffer.getReadPointer(juce::jmin(1, buffer.getNumChannels() - 1)), numSamples);
+
+    for (size_t ch = 0; ch < numChannels; ++ch)
+    {
+        dcOffset[ch] = static_cast<float>(lowEnd.dc[ch]);
+        subsonicMeanSquare[ch] = static_cast<float>(lowEnd.meanSquare[ch]);
+    }
+}
+
+void PeakTracker::processLowEnd(const float* left, const float* right, int numSamples)
+{
+    // The recursions keep their state in locals
+    auto state = lowEnd;
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        Lanes y { left[i], right[i] };
+
+        for (size_t ch = 0; ch < numChannels; ++ch)
+        {
+            state.dc[ch] += dcCoefficient * (y[ch] - state.dc[ch]);
+            y[ch] -= state.dc[ch];
+        }
+
+        // Transposed direct form II, section by section
+        for (size_t s = 0; s < sections.size(); ++s)
+        {
+            const auto& section = sections[s];
+            auto& z1 = state.z1[s];
+            auto& z2 = state.z2[s];
+
+            for (size_t ch = 0; ch < numChannels; ++ch)
+            {
+                double x = y[ch];
+                y[ch] = section.b0 * x + z1[ch];
+                z1[ch] = section.b1 * x - section.a1 * y[ch] + z2[ch];
+                z2[ch] = section.b2 * x - section.a2 * y[ch];
+            }
+        }
+
+        for (size_t ch = 0; ch < numChannels; ++ch)
+            state.meanSquare[ch] += meanSquareCoefficient * (y[ch] * y[ch] - state.meanSquare[ch]);
+    }
+
+    lowEnd = state;
+}
+
+float PeakTracker::getSubsonicDb(int channel) const
+{
+    float meanSquare = subsonicMeanSquare[static_cast<size_t>(channel)].load();
+
+    // A sine's mean square is half its peak squared, same calibration as the RTA
+    return juce::Decibels::gainToDecibels(std::sqrt(2.f * meanSquare), NEGATIVE_INFINITY);
+}
+
+LowEndLevels PeakTracker::getLowEndLevels() const
+{
+    LowEndLevels levels;
+
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        levels.dcOffset[static_cast<size_t>(ch)] = getDcOffset(ch);
+        levels.subsonicDb[static_cast<size_t>(ch)] = getSubsonicDb(ch);
+    }
+
+    return levels;
+}
+
+PeakLevels PeakTracker::takePeakLevels()
+{
+    float magLeft  = takePeak(0);
+    float magRight = takePeak(1);
+
+    return PeakLevels::fromMagnitudes(magLeft, magRight);
+}
+
+//==============================================================================
+//MARK: - TruePeakDetector
+
+void TruePeakDetector::prepare(int _maxBlockSize)
+{
+    maxBlockSize = juce::jmax(1, _maxBlockSize);
+
+    oversampling = std::make_unique<juce::dsp::Oversampling<float>>(static_cast<size_t>(numChannels),
+                                                                    static_cast<size_t>(oversamplingOrder),
+                                                                    juce::dsp::Oversampling<float>::filterHalfBandFIREquiripple,
+                                                                    true);
+    oversampling->initProcessing(static_cast<size_t>(maxBlockSize));
+    stereoBlock.setSize(numChannels, maxBlockSize);
+
+    reset();
+}
+
+void TruePeakDetector::reset()
+{
+    if (oversampling != nullptr)
+        oversampling->reset();
+
+    truePeak.fill(0.f);
+    overs.fill(0);
+}
+
+void TruePeakDetector::process(const juce::AudioBuffer<float>& buffer, int startSample, int numSamples)
+{
+    if (oversampling == nullptr || buffer.getNumChannels() == 0)
+        return;
+
+    // A mono buffer is measured as the same signal on both sides
+    int rightChannel = buffer.getNumChannels() > 1 ? 1 : 0;
+
+    for (int done = 0; done < numSamples; )
+    {
+        int numThisTime = juce::jmin(maxBlockSize, numSamples - done);
+
+        stereoBlock.copyFrom(0, 0, buffer, 0, startSample + done, numThisTime);
+        stereoBlock.copyFrom(1, 0, buffer, rightChannel, startSample + done, numThisTime);
+        processBlock(numThisTime);
+
+        done += numThisTime;
+    }
+}
+
+void TruePeakDetector::flush()
+{
+    if (oversampling == nullptr)
+        return;
+
+    int remaining = static_cast<int>(std::ceil(oversampling->getLatencyInSamples())) + 1;
+
+    stereoBlock.clear();
+
+    while (remaining > 0)
+    {
+        int numThisTime = juce::jmin(maxBlockSize, remaining);
+        processBlock(numThisTime);
+        remaining -= numThisTime;
+    }
+}
+
+void TruePeakDetector::processBlock(int numSamples)
+{
+    juce::dsp::AudioBlock<float> block (stereoBlock.getArrayOfWritePointers(), static_cast<size_t>(numChannels),
+                                        0, static_cast<size_t>(numSamples));
+
+    auto upsampled = oversampling->processSamplesUp(block);
+
+    for (size_t ch = 0; ch < static_cast<size_t>(numChannels); ++ch)
+    {
+        const float* samples = upsampled.getChannelPointer(ch);
+
+        for (size_t i = 0; i < upsampled.getNumSamples(); ++i)
+        {
+            float magnitude = std::abs(samples[i]);
+
+            truePeak[ch] = juce::jmax(truePeak[ch], magnitude);
+            if (magnitude >= 1.f)
+                ++overs[ch];
+        }
+    }
+}
+
+float TruePeakDetector::getTruePeakDb(int channel) const
+{
+    return juce::Decibels::gainToDecibels(truePeak[static_cast<size_t>(channel)], NEGATIVE_INFINITY);
+}
+
+//==============================================================================
+//MARK: - DynamicRangeAnalyser
+
+void DynamicRangeAnalyser::prepare(double sampleRate, double windowSeconds)
+{
+    for (auto& filter : kWeighting)
+        filter.prepare(sampleRate);
+
+    samplesPerStep = juce::jmax(1, juce::roundToInt(sampleRate * stepSeconds));
+
+    // Fed at most a step at a time
+    truePeak.prepare(samplesPerStep);
+
+    auto windowSteps = static_cast<size_t>(juce::jlimit(1, maxWindowSteps, juce::roundToInt(windowSeconds / stepSeconds)));
+    windowPeak.setWindowLength(windowSteps);
+    sumsOfSquares.assign(windowSteps, 0.0);
+    weightedSumsOfSquares.assign(windowSteps, 0.0);
+
+    reset();
+}
+
+void DynamicRangeAnalyser::reset()
+{
+    for (auto& filter : kWeighting)
+        filter.reset();
+
+    truePeak.reset();
+    loudness.reset();
+    plrDb = NEGATIVE_INFINITY;
+
+    samplesIntoStep = 0;
+    stepPeak = 0.f;
+    stepSumOfSquares = 0.0;
+    stepWeightedSumOfSquares = 0.0;
+
+    windowPeak.clear();
+    std::fill(sumsOfSquares.begin(), sumsOfSquares.end(), 0.0);
+    std::fill(weightedSumsOfSquares.begin(), weightedSumsOfSquares.end(), 0.0);
+    ringIndex = 0;
+    numStepsInWindow = 0;
+    windowSumOfSquares = 0.0;
+    windowWeightedSumOfSquares = 0.0;
+}
+
+void DynamicRangeAnalyser::process(const juce::AudioBuffer<float>& buffer, int startSample, int numSamples)
+{
+    int numChannels = buffer.getNumChannels();
+    if (numChannels == 0 || sumsOfSquares.empty())
+        return;
+
+    const float* left  = buffer.getReadPointer(0);
+    const float* right = buffer.getReadPointer(numChannels > 1 ? 1 : 0);
+
+    // A piece at a time, so no piece crosses the end of a step
+    while (numSamples > 0)
+    {
+        int numInStep = juce::jmin(numSamples, samplesPerStep - samplesIntoStep);
+
+        auto summary = BlockSummary::fromBuffer(buffer, startSample, numInStep);
+        stepPeak = juce::jmax(stepPeak, summary.getMaxMagnitude());
+        stepSumOfSquares += summary.sumOfSquares[0] + summary.sumOfSquares[1];
+
+        for (int i = startSample; i < startSample + numInStep; ++i)
+        {
+            double weightedLeft  = kWeighting[0].processSample(left[i]);
+            double weightedRight = kWeighting[1].processSample(right[i]);
+            stepWeightedSumOfSquares += weightedLeft * weightedLeft + weightedRight * weightedRight;
+        }
+
+        truePeak.process(buffer, startSample, numInStep);
+
+        startSample += numInStep;
+        numSamples -= numInStep;
+        samplesIntoStep += numInStep;
+
+        if (samplesIntoStep == samplesPerStep)
+            endStep();
+    }
+}
+
+void DynamicRangeAnalyser::endStep()
+{
+    windowPeak.push(stepPeak);
+
+    // The step leaving the window comes off the running sums as the new one goes on
+    windowSumOfSquares += stepSumOfSquares - sumsOfSquares[ringIndex];
+    windowWeightedSumOfSquares += stepWeightedSumOfSquares - weightedSumsOfSquares[ringIndex];
+
+    // Rounding left over from the subtractions must not go negative over silence
+    windowSumOfSquares = juce::jmax(0.0, windowSumOfSquares);
+    windowWeightedSumOfSquares = juce::jmax(0.0, windowWeightedSumOfSquares);
+
+    // BS.1770 adds the channels' mean squares
+    loudness.addSubBlock(stepWeightedSumOfSquares / samplesPerStep);
+    updatePlr();
+
+    sumsOfSquares[ringIndex] = stepSumOfSquares;
+    weightedSumsOfSquares[ringIndex] = stepWeightedSumOfSquares;
+    ringIndex = (ringIndex + 1) % sumsOfSquares.size();
+    numStepsInWindow = juce::jmin(numStepsInWindow + 1, static_cast<int>(sumsOfSquares.size()));
+
+    samplesIntoStep = 0;
+    stepPeak = 0.f;
+    stepSumOfSquares = 0.0;
+    stepWeightedSumOfSquares = 0.0;
+}
+
+float DynamicRangeAnalyser::getPeakDb() const
+{
+    if (! hasReading())
+        return NEGATIVE_INFINITY;
+
+    return juce::Decibels::gainToDecibels(windowPeak.get(), NEGATIVE_INFINITY);
+}
+
+float DynamicRangeAnalyser::getRmsDb() const
+{
+    if (numStepsInWindow == 0)
+        return NEGATIVE_INFINITY;
+
+    // Both channels together: the mean square per channel
+    double meanSquare = windowSumOfSquares / (2.0 * numStepsInWindow * samplesPerStep);
+    return juce::Decibels::gainToDecibels(static_cast<float>(std::sqrt(meanSquare)), NEGATIVE_INFINITY);
+}
+
+float DynamicRangeAnalyser::getLoudnessLufs() const
+{
+    if (numStepsInWindow == 0)
+        return LoudnessGating::absoluteGateLufs;
+
+    // BS.1770 adds the channels' mean squares rather than averaging them
+    double meanSquare = windowWeightedSumOfSquares / (static_cast<double>(numStepsInWindow) * samplesPerStep);
+    return juce::jmax(LoudnessGating::absoluteGateLufs, LoudnessGating::energyToLufs(meanSquare));
+}
+
+float DynamicRangeAnalyser::getCrestFactorDb() const
+{
+    float peakDb = getPeakDb();
+    float rmsDb = getRmsDb();
+
+    if (peakDb <= NEGATIVE_INFINITY || rmsDb <= NEGATIVE_INFINITY)
+        return NEGATIVE_INFINITY;
+
+    return peakDb - rmsDb;
+}
+
+void DynamicRangeAnalyser::updatePlr()
+{
+    float truePeakDb = juce::jmax(truePeak.getTruePeakDb(0), truePeak.getTruePeakDb(1));
+    float integratedLufs = loudness.getIntegratedLufs();
+
+    if (truePeakDb <= NEGATIVE_INFINITY || integratedLufs <= LoudnessGating::absoluteGateLufs)
+        plrDb = NEGATIVE_INFINITY;
+    else
+        plrDb = truePeakDb - integratedLufs;
+}
+
+float DynamicRangeAnalyser::getPsrDb() const
+{
+    float peakDb = getPeakDb();
+    float lufs = getLoudnessLufs();
+
+    if (peakDb <= NEGATIVE_INFINITY || lufs <= LoudnessGating::absoluteGateLufs)
+        return NEGATIVE_INFINITY;
+
+    return peakDb - lufs;
+}
+
+//==============================================================================
+//MARK: - NoiseFloorEstimator
+
+void NoiseFloorEstimator::prepare(double sampleRate, double windowSeconds)
+{
+    samplesPerStep = juce::jmax(1, juce::roundToInt(sampleRate * stepSeconds));
+    smoothingCoefficient = 1.0 - std::exp(-stepSeconds / smoothingSeconds);
+
+    auto windowSteps = static_cast<size_t>(juce::jmax(1, juce::roundToInt(windowSeconds / stepSeconds)));
+    windowMinimum.setWindowLength(windowSteps);
+    windowMeanSquare.resize(windowSteps, 0.0);
+
+    reset();
+}
+
+void NoiseFloorEstimator::reset()
+{
+    samplesIntoStep = 0;
+    stepSumOfSquares = 0.0;
+    smoothedMeanSquare = -1.0;
+
+    windowMinimum.clear();
+    windowMeanSquare.clear(0.0);
+}
+
+void NoiseFloorEstimator::process(const juce::AudioBuffer<float>& buffer, int startSample, int numSamples)
+{
+    int numChannels = buffer.getNumChannels();
+    if (numChannels == 0)
+        return;
+
+    const float* left  = buffer.getReadPointer(0, startSample);
+    const float* right = buffer.getReadPointer(numChannels > 1 ? 1 : 0, startSample);
+
+    int position = 0;
+    while (position < numSamples)
+    {
+        int numThisTime = juce::jmin(samplesPerStep - samplesIntoStep, numSamples - position);
+
+        for (int i = position; i < position + numThisTime; ++i)
+            stepSumOfSquares += static_cast<double>(left[i]) * left[i] + static_cast<double>(right[i]) * right[i];
+
+        position += numThisTime;
+        samplesIntoStep += numThisTime;
+
+        if (samplesIntoStep == samplesPerStep)
+            endStep();
+    }
+}
+
+void NoiseFloorEstimator::endStep()
+{
+    double meanSquare = stepSumOfSquares / (2.0 * samplesPerStep);
+
+    if (smoothedMeanSquare < 0.0)
+        smoothedMeanSquare = meanSquare;
+    else
+        smoothedMeanSquare += smoothingCoefficient * (meanSquare - smoothedMeanSquare);
+
+    windowMinimum.push(juce::Decibels::gainToDecibels(static_cast<float>(std::sqrt(smoothedMeanSquare)), NEGATIVE_INFINITY));
+    windowMeanSquare.add(meanSquare);
+
+    samplesIntoStep = 0;
+    stepSumOfSquares = 0.0;
+}
+
+float NoiseFloorEstimator::getNoiseFloorDb() const
+{
+    return windowMinimum.isEmpty() ? NEGATIVE_INFINITY : windowMinimum.get();
+}
+
+float NoiseFloorEstimator::getSignalDb() const
+{
+    if (windowMinimum.isEmpty())
+        return NEGATIVE_INFINITY;
+
+    // Before the window fills, the zeros it started with pull this down a little
+    double meanSquare = juce::jmax(0.0, windowMeanSquare.getAvg());
+    return juce::Decibels::gainToDecibels(static_cast<float>(std::sqrt(meanSquare)), NEGATIVE_INFINITY);
+}
+
+float NoiseFloorEstimator::getSnrDb() const
+{
+    float floorDb = getNoiseFloorDb();
+    float signalDb = getSignalDb();
+
+    if (floorDb <= NEGATIVE_INFINITY || signalDb <= NEGATIVE_INFINITY)
+        return NEGATIVE_INFINITY;
+
+    return juce::jmax(0.f, signalDb - floorDb);
+}
+
+//==============================================================================
+//MARK: - MeterStatistics
+
+void MeterStatistics::reset()
+{
+    *this = MeterStatistics();
+}
+
+void MeterStatistics::addBlock(int channel, float blockPeak, double blockSumOfSquares, int numSamples)
+{
+    jassert(juce::isPositiveAndBelow(channel, numChannels));
+
+    auto ch = static_cast<size_t>(channel);
+    peak[ch] = juce::jmax(peak[ch], blockPeak);
+    sumOfSquares[ch] += blockSumOfSquares;
+    numSamplesPerChannel[ch] += numSamples;
+}
+
+void MeterStatistics::addFrame(const PeakLevels& levels, float slowCorrelation, float peakCorrelation)
+{
+    ++levelHistogram[static_cast<size_t>(levelToBin(levels.dbMono))];
+
+    ++numFrames;
+    correlationSum += slowCorrelation;
+    correlationMin = juce::jmin(correlationMin, peakCorrelation);
+    correlationMax = juce::jmax(correlationMax, peakCorrelation);
+}
+
+void MeterStatistics::merge(const MeterStatistics& later)
+{
+    for (size_t ch = 0; ch < numChannels; ++ch)
+    {
+        peak[ch] = juce::jmax(peak[ch], later.peak[ch]);
+        sumOfSquares[ch] += later.sumOfSquares[ch];
+        numSamplesPerChannel[ch] += later.numSamplesPerChannel[ch];
+    }
+
+    if (later.numFrames > 0)
+    {
+        correlationMin = juce::jmin(correlationMin, later.correlationMin);
+        correlationMax = juce::jmax(correlationMax, later.correlationMax);
+    }
+
+    numFrames += later.numFrames;
+    correlationSum += later.correlationSum;
+
+    for (size_t bin = 0; bin < levelHistogram.size(); ++bin)
+        levelHistogram[bin] += later.levelHistogram[bin];
+
+    loudness.merge(later.loudness);
+}
+
+int MeterStatistics::levelToBin(float db)
+{
+    int bin = static_cast<int>(std::floor((db - NEGATIVE_INFINITY) / levelBinWidthDb));
+
+    return juce::jlimit(0, numLevelBins - 1, bin);
+}
+
+float MeterStatistics::getPeakDb(int channel) const
+{
+    return juce::Decibels::gainToDecibels(peak[static_cast<size_t>(channel)], NEGATIVE_INFINITY);
+}
+
+float MeterStatistics::getRmsDb(int channel) const
+{
+    auto ch = static_cast<size_t>(channel);
+
+    if (numSamplesPerChannel[ch] == 0)
+        return NEGATIVE_INFINITY;
+
+    auto rms = std::sqrt(sumOfSquares[ch] / static_cast<double>(numSamplesPerChannel[ch]));
+
+    return juce::Decibels::gainToDecibels(static_cast<float>(rms), NEGATIVE_INFINITY);
+}
+
+float MeterStatistics::getCorrelationMean() const
+{
+    if (numFrames == 0)
+        return 0.f;
+
+    return static_cast<float>(correlationSum / static_cast<double>(numFrames));
+}
+
+//==============================================================================
+//MARK: - MeterAnalysisEngine
+
+MeterAnalysisEngine::MeterAnalysisEngine()
+{
+    prepare(48000.0, 60);
+}
+
+void MeterAnalysisEngine::prepare(double sampleRate, int frameRateHz)
+{
+    jassert(sampleRate > 0 && frameRateHz > 0);
+
+    correlation.prepare(sampleRate);
+    slowCorrelationAverager.clear(0.f);
+    peakCorrelationAverager.clear(0.f);
+    statistics.reset();
+
+    for (auto& filter : kWeighting)
+        filter.prepare(sampleRate);
+
+    samplesPerFrame = getSamplesPerFrame(sampleRate, frameRateHz);
+    samplesIntoFrame = 0;
+    frameMagLeft = 0.f;
+    frameMagRight = 0.f;
+
+    samplesPerSubBlock = getSamplesPerSubBlock(sampleRate);
+    samplesIntoSubBlock = 0;
+    subBlockSumOfSquares = 0.0;
+
+    recentSubBlocks.fill(0.0);
+    recentSubBlocksWriteIndex = 0;
+    numRecentSubBlocks = 0;
+
+    intervalPeak.fill(0.f);
+    intervalSumOfSquares.fill(0.0);
+    intervalNumSamples = 0;
+}
+
+void MeterAnalysisEngine::preRoll(const juce::AudioBuffer<float>& buffer, int startSample, int numSamples)
+{
+    int numChannels = buffer.getNumChannels();
+    if (numChannels == 0)
+        return;
+
+    processSamples(buffer.getReadPointer(0, startSample),
+                   buffer.getReadPointer(numChannels > 1 ? 1 : 0, startSample),
+                   1,
+                   numChannels > 1,
+                   numSamples,
+                   false);
+}
+
+void MeterAnalysisEngine::process(const juce::AudioBuffer<float>& buffer, int startSample, int numSamples)
+{
+    int numChannels = buffer.getNumChannels();
+    if (numChannels == 0)
+        return;
+
+    processSamples(buffer.getReadPointer(0, startSample),
+                   buffer.getReadPointer(numChannels > 1 ? 1 : 0, startSample),
+                   1,
+                   numChannels > 1,
+                   numSamples,
+                   true);
+}
+
+void MeterAnalysisEngine::processInterleaved(const float* interleaved, int numChannels, int numSamples)
+{
+    if (numChannels <= 0)
+        return;
+
+    processSamples(interleaved,
+                   interleaved + (numChannels > 1 ? 1 : 0),
+                   numChannels,
+                   numChannels > 1,
+                   numSamples,
+                   true);
+}
+
+MeterReadout MeterAnalysisEngine::takeReadout()
+{
+    MeterReadout readout;
+
+    for (size_t ch = 0; ch < MeterStatistics::numChannels; ++ch)
+    {
+        readout.peakDb[ch] = juce::Decibels::gainToDecibels(intervalPeak[ch], NEGATIVE_INFINITY);
+
+        float rms = intervalNumSamples > 0 ? static_cast<float>(std::sqrt(intervalSumOfSquares[ch] / intervalNumSamples))
+                                           : 0.f;
+        readout.rmsDb[ch] = juce::Decibels::gainToDecibels(rms, NEGATIVE_INFINITY);
+    }
+
+    readout.correlation = static_cast<float>(slowCorrelationAverager.getMean());
+    readout.momentaryLufs = getRecentLoudness(momentarySubBlocks);
+    readout.shortTermLufs = getRecentLoudness(shortTermSubBlocks);
+
+    intervalPeak.fill(0.f);
+    intervalSumOfSquares.fill(0.0);
+    intervalNumSamples = 0;
+
+    return readout;
+}
+
+void MeterAnalysisEngine::processSamples(const float* left,
+                                         const float* right,
+                                         int stride,
+                                         bool isStereo,
+                                         int numSamples,
+                                         bool accumulate)
+{
+    // One pass over the input feeds every kernel, reading straight from the caller's memory
+    float blockPeakLeft = 0.f, blockPeakRight = 0.f;
+    double blockSumOfSquaresLeft = 0.0, blockSumOfSquaresRight = 0.0;
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        float leftSample  = left[i * stride];
+        float rightSample = right[i * stride];
+
+        float c = correlation.processSample(leftSample, rightSample);
+        slowCorrelationAverager.add(c);
+        peakCorrelationAverager.add(c);
+
+        // A mono source only contributes its one channel to the loudness sum
+        double weightedLeft = kWeighting[0].processSample(leftSample);
+        double weightedSumOfSquares = weightedLeft * weightedLeft;
+
+        if (isStereo)
+        {
+            double weightedRight = kWeighting[1].processSample(rightSample);
+            weightedSumOfSquares += weightedRight * weightedRight;
+        }
+
+        if (! accumulate)
+            continue;
+
+        float magLeft  = std::abs(leftSample);
+        float magRight = std::abs(rightSample);
+
+        blockPeakLeft  = juce::jmax(blockPeakLeft,  magLeft);
+        blockPeakRight = juce::jmax(blockPeakRight, magRight);
+        blockSumOfSquaresLeft  += static_cast<double>(leftSample)  * leftSample;
+        blockSumOfSquaresRight += static_cast<double>(rightSample) * rightSample;
+
+        frameMagLeft  = juce::jmax(frameMagLeft,  magLeft);
+        frameMagRight = juce::jmax(frameMagRight, magRight);
+
+        subBlockSumOfSquares += weightedSumOfSquares;
+
+        if (++samplesIntoSubBlock == samplesPerSubBlock)
+            endSubBlock();
+
+        if (++samplesIntoFrame == samplesPerFrame)
+            endFrame();
+    }
+
+    if (! accumulate)
+        return;
+
+    statistics.addBlock(0, blockPeakLeft,  blockSumOfSquaresLeft,  numSamples);
+    statistics.addBlock(1, blockPeakRight, blockSumOfSquaresRight, numSamples);
+
+    intervalPeak[0] = juce::jmax(intervalPeak[0], blockPeakLeft);
+    intervalPeak[1] = juce::jmax(intervalPeak[1], blockPeakRight);
+    intervalSumOfSquares[0] += blockSumOfSquaresLeft;
+    intervalSumOfSquares[1] += blockSumOfSquaresRight;
+    intervalNumSamples += numSamples;
+}
+
+void MeterAnalysisEngine::endFrame()
+{
+    statistics.addFrame(PeakLevels::fromMagnitudes(frameMagLeft, frameMagRight),
+                        static_cast<float>(slowCorrelationAverager.getMean()),
+                        static_cast<float>(peakCorrelationAverager.getMean()));
+
+    samplesIntoFrame = 0;
+    frameMagLeft = 0.f;
+    frameMagRight = 0.f;
+}
+
+void MeterAnalysisEngine::endSubBlock()
+{
+    double meanSquare = subBlockSumOfSquares / samplesPerSubBlock;
+
+    statistics.loudness.addSubBlock(meanSquare);
+
+    recentSubBlocks[static_cast<size_t>(recentSubBlocksWriteIndex)] = meanSquare;
+    recentSubBlocksWriteIndex = (recentSubBlocksWriteIndex + 1) % shortTermSubBlocks;
+    numRecentSubBlocks = juce::jmin(numRecentSubBlocks + 1, shortTermSubBlocks);
+
+    samplesIntoSubBlock = 0;
+    subBlockSumOfSquares = 0.0;
+}
+
+float MeterAnalysisEngine::getRecentLoudness(int numSubBlocks) const
+{
+    int count = juce::jmin(numSubBlocks, numRecentSubBlocks);
+    if (count == 0)
+        return LoudnessGating::absoluteGateLufs;
+
+    double sum = 0.0;
+    int index = recentSubBlocksWriteIndex;
+    for (int i = 0; i < count; ++i)
+    {
+        index = (index == 0) ? shortTermSubBlocks - 1 : index - 1;
+        sum += recentSubBlocks[static_cast<size_t>(index)];
+    }
+
+    return juce::jmax(LoudnessGating::absoluteGateLufs, LoudnessGating::energyToLufs(sum / count));
+}
+
+int MeterAnalysisEngine::getSamplesPerFrame(double sampleRate, int frameRateHz)
+{
+    return juce::jmax(1, juce::roundToInt(sampleRate / frameRateHz));
+}
+
+int MeterAnalysisEngine::getSamplesPerSubBlock(double sampleRate)
+{
+    return juce::jmax(1, juce::roundToInt(sampleRate * LoudnessGating::subBlockSeconds));
+}
+
+int MeterAnalysisEngine::getSegmentAlignment(double sampleRate, int frameRateHz)
+{
+    return std::lcm(getSamplesPerFrame(sampleRate, frameRateHz), getSamplesPerSubBlock(sampleRate));
+}
+
+int MeterAnalysisEngine::getPreRollLength(double sampleRate)
+{
+    // The averagers are exact after one full window, the IIR K-weighting has decayed well below float precision
+    return juce::jmax(slowCorrelationLength, juce::roundToInt(sampleRate * preRollSeconds));
+}
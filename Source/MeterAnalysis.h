@@ -0,0 +1,701 @@
+//
+//  MeterAnalysis.h
+//  PFM10 - Shared Code
+//
+//  GUI-independent metering kernels shared by the plugin editor and the
+//  offline analyser (Tools/pfm10-analyze). Nothing in here may depend on
+//  juce_gui_basics or on the plugin processor.
+//
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <functional>
+#include <numeric>
+
+#ifdef  MAX_DECIBELS
+#undef  MAX_DECIBELS
+#endif
+#define MAX_DECIBELS 12.f
+
+#ifdef  NEGATIVE_INFINITY
+#undef  NEGATIVE_INFINITY
+#endif
+#define NEGATIVE_INFINITY -66.f
+
+#ifdef  INV_SQRT_OF_2
+#undef  INV_SQRT_OF_2
+#endif
+#define INV_SQRT_OF_2 0.7071f
+
+//==============================================================================
+//MARK: - Averager
+
+template<typename T>
+struct Averager
+{
+    Averager(size_t _numElements, T _initialValue);
+
+    void resize(size_t numElements, T initialValue);
+
+    void clear(T initialValue);
+
+    size_t getSize() const { return elements.size(); }
+
+    void add(T t);
+
+    T getAvg() const { return avg; }
+private:
+    std::vector<T> elements;
+    std::atomic<T> avg { NEGATIVE_INFINITY };
+    std::atomic<size_t> writeIndex = 0;
+    std::atomic<T> sum { NEGATIVE_INFINITY };
+};
+
+//==============================================================================
+//MARK: - WindowedMean
+
+/*
+   Mean of the last numElements values added, like an Averager, but summed
+   afresh in double precision, oldest first, each time it's read. The result
+   only depends on the values in the window, never on how long it has run,
+   so two passes that end on the same samples read exactly the same mean.
+   Meant for windows that are read far less often than they're written.
+ */
+struct WindowedMean
+{
+    WindowedMean(size_t numElements, float initialValue) { resize(numElements, initialValue); }
+
+    void resize(size_t numElements, float initialValue);
+    void clear(float initialValue);
+    void add(float value);
+    double getMean() const;
+private:
+    std::vector<float> elements;
+    size_t writeIndex { 0 };        // the oldest value
+};
+
+//==============================================================================
+//MARK: - SlidingWindowExtreme
+
+/*
+   Maximum (or, with std::less, minimum) of the last windowLength values
+   pushed. Keeps a monotonic deque of the values that could still become
+   the extreme, so push() is O(1) amortised and get() is O(1), however long
+   the window. The deque lives in a ring sized to the window and nothing is
+   allocated after setWindowLength().
+ */
+template<typename T, typename Compare = std::greater<T>>
+struct SlidingWindowExtreme
+{
+    // Clears the window
+    void setWindowLength(size_t length);
+    size_t getWindowLength() const { return windowLength; }
+
+    void clear();
+    void push(T value);
+
+    bool isEmpty() const { return numEntries == 0; }
+    T get() const { return ring[head].value; }      // only when not empty
+private:
+    struct Entry
+    {
+        T value {};
+        juce::int64 index { 0 };
+    };
+
+    std::vector<Entry> ring;
+    size_t windowLength { 1 };
+    size_t head { 0 };
+    size_t numEntries { 0 };
+    juce::int64 numPushed { 0 };
+};
+
+using SlidingWindowMax = SlidingWindowExtreme<float, std::greater<float>>;
+using SlidingWindowMin = SlidingWindowExtreme<float, std::less<float>>;
+
+//==============================================================================
+//MARK: - DecayingValue
+
+/*
+   Peak hold and decay ballistics without a clock of its own. The owner passes
+   in the current time, so the editor can drive it from a juce::Timer and the
+   offline analyser can drive it from the sample position.
+ */
+struct DecayingValue
+{
+    void update(float input, juce::int64 nowMs);
+    void decay(juce::int64 nowMs, float elapsedMs);
+    void reset() { heldValue = NEGATIVE_INFINITY; }
+    float getHeldValue() const { return heldValue.load(); }
+    void setHoldTime(juce::int64 ms) { holdTimeMs = ms; }
+    void setDecayRate(float dbPerSec) { decayRateDbPerSec = dbPerSec; }
+    void setHoldForInf(bool b) { holdForInf = b; }
+    bool isHoldingForInf() const { return holdForInf.load(); }
+private:
+    std::atomic<bool> holdForInf { false };
+    std::atomic<float> heldValue { NEGATIVE_INFINITY };
+    std::atomic<juce::int64> holdTimeMs { 0 };
+    std::atomic<juce::int64> peakTime { 0 };
+    std::atomic<float> decayRateDbPerSec { 0.f };
+};
+
+//==============================================================================
+//MARK: - CorrelationAnalyser
+
+/*
+   Running phase correlation between two channels:
+   r = LP(L*R) / sqrt( LP(L^2) * LP(R^2) ), with a 10 Hz moving-average low-pass.
+   Undefined results (silence) are reported as 0.
+ */
+struct CorrelationAnalyser
+{
+    void prepare(double sampleRate);
+    void reset();
+    float processSample(float leftSample, float rightSample);
+private:
+    std::array<juce::dsp::FIR::Filter<float>, 3> filters;
+};
+
+//==============================================================================
+//MARK: - MidSideSums
+
+/*
+   Energy sums of the mid and side signals, M = (L+R)/sqrt(2) and
+   S = (L-R)/sqrt(2), over a stretch of samples. Width, balance and mono
+   fold-down loss all follow from these three sums, since
+   L^2 + R^2 = M^2 + S^2 and L^2 - R^2 = 2*M*S.
+   Each reading is NEGATIVE_INFINITY (balance: 0) over silence.
+ */
+struct MidSideSums
+{
+    double midSquared  { 0.0 };
+    double sideSquared { 0.0 };
+    double midSide     { 0.0 };
+
+    void add(float mid, float side)
+    {
+        midSquared  += static_cast<double>(mid) * mid;
+        sideSquared += static_cast<double>(side) * side;
+        midSide     += static_cast<double>(mid) * side;
+    }
+    void reset() { midSquared = sideSquared = midSide = 0.0; }
+    bool isSilent() const { return midSquared + sideSquared <= 0.0; }
+
+    // Side over mid energy: far below 0 dB for mono, 0 dB for uncorrelated channels, above for out-of-phase material
+    float getWidthDb() const;
+
+    // Left over right energy, positive when the left channel is louder
+    float getBalanceDb() const;
+
+    // How much quieter the mono sum is than the stereo signal: 0 dB for mono, 3 dB for uncorrelated channels
+    float getMonoLossDb() const;
+};
+
+//==============================================================================
+//MARK: - KWeightingFilter
+
+/*
+   ITU-R BS.1770 K-weighting: a high-shelf pre-filter followed by the RLB
+   high-pass. Coefficients are derived for the actual sample rate rather
+   than taken from the 48 kHz tables.
+ */
+struct KWeightingFilter
+{
+    void prepare(double sampleRate);
+    void reset();
+    double processSample(double x) { return highPass.processSample(preFilter.processSample(x)); }
+private:
+    juce::dsp::IIR::Filter<double> preFilter, highPass;
+};
+
+//==============================================================================
+//MARK: - LoudnessGating
+
+/*
+   Gated integrated loudness (BS.1770 / EBU R128). Mean-square energies of
+   100 ms sub-blocks are combined into 400 ms blocks with 75% overlap. The
+   energy of every block above the absolute gate is kept, in order, so the
+   relative gate is applied to the exact block energies; that's 8 bytes per
+   100 ms, under 300 kB an hour.
+
+   Two accumulators over consecutive stretches of audio can be merged: the
+   first and last three sub-blocks of each are kept so the blocks that
+   straddle the seam are formed exactly as a single pass would form them,
+   and the merged blocks stay in time order, so the sums come out exactly
+   as a single pass would add them up.
+ */
+struct LoudnessGating
+{
+    static constexpr float absoluteGateLufs = -70.f;
+    static constexpr float relativeGateLu = -10.f;
+    static constexpr int subBlocksPerBlock = 4;
+    static constexpr double subBlockSeconds = 0.1;
+
+    LoudnessGating();
+
+    void reset();
+    void addSubBlock(double meanSquare);
+    void merge(const LoudnessGating& later);
+
+    // Returns absoluteGateLufs when nothing made it above the absolute gate.
+    float getIntegratedLufs() const;
+    juce::int64 getNumBlocks() const;
+
+    static float energyToLufs(double meanSquare);
+private:
+    static constexpr int edgeSize = subBlocksPerBlock - 1;
+
+    std::vector<double> blockEnergies;      // above the absolute gate, oldest first
+
+    std::array<double, edgeSize> head {};
+    std::array<double, edgeSize> tail {};
+    int numHead { 0 };
+    int numTail { 0 };
+    juce::int64 numSubBlocks { 0 };
+
+    void addBlock(double meanSquare);
+    void pushTail(double meanSquare);
+};
+
+//==============================================================================
+//MARK: - LoudnessHistogram
+
+/*
+   Gated integrated loudness for a meter that runs for as long as the session.
+   The blocks are formed as LoudnessGating forms them, but each one only adds
+   to the count and energy sum of its 0.1 LU bin, so memory is fixed and a
+   reading costs one pass over the bins however long it has run. The relative
+   gate is applied per bin, on the bin's mean energy, which puts the result
+   within a bin width of the exact value. Blocks louder than maxLufs share the
+   top bin; their energies are still summed exactly.
+
+   Not mergeable: pfm10-analyze keeps the exact LoudnessGating.
+ */
+struct LoudnessHistogram
+{
+    static constexpr float binWidthLu = 0.1f;
+    static constexpr float maxLufs = 10.f;
+    static constexpr int numBins = static_cast<int>((maxLufs - LoudnessGating::absoluteGateLufs) / binWidthLu);
+
+    void reset();
+    void addSubBlock(double meanSquare);
+
+    // Returns LoudnessGating::absoluteGateLufs when nothing made it above the absolute gate.
+    float getIntegratedLufs() const;
+private:
+    static constexpr int edgeSize = LoudnessGating::subBlocksPerBlock - 1;
+
+    std::array<juce::int64, numBins> binCounts {};
+    std::array<double, numBins> binEnergies {};
+    juce::int64 totalCount { 0 };
+    double totalEnergy { 0.0 };
+
+    std::array<double, edgeSize> tail {};
+    int numTail { 0 };
+};
+
+//==============================================================================
+//MARK: - PeakLevels
+
+struct PeakLevels
+{
+    float magLeft  { 0.f };
+    float magRight { 0.f };
+    float dbLeft   { NEGATIVE_INFINITY };
+    float dbRight  { NEGATIVE_INFINITY };
+    float dbMono   { NEGATIVE_INFINITY };
+
+    // A mono buffer reports the same level on both sides.
+    static PeakLevels fromBuffer(const juce::AudioBuffer<float>& buffer, int startSample, int numSamples);
+    static PeakLevels fromMagnitudes(float magLeft, float magRight);
+};
+
+// The PeakTracker's low-end filter states, as the low-end meter shows them
+struct LowEndLevels
+{
+    std::array<float, 2> dcOffset {};
+    std::array<float, 2> subsonicDb {};
+};
+
+//==============================================================================
+//MARK: - BlockSummary
+
+/*
+   Peak and sum of squares per channel of one processor block, worked out
+   once at the top of processBlock() and handed to everything that only
+   needs block levels, instead of each of them making its own passes.
+ */
+struct BlockSummary
+{
+    static constexpr int numChannels = 2;
+
+    std::array<float, numChannels> magnitude {};
+    std::array<double, numChannels> sumOfSquares {};
+    int numSamples { 0 };
+
+    // A mono buffer reports the same levels on both sides.
+    static BlockSummary fromBuffer(const juce::AudioBuffer<float>& buffer);
+    static BlockSummary fromBuffer(const juce::AudioBuffer<float>& buffer, int startSample, int numSamples);
+
+    float getRms(int channel) const;
+    float getMaxMagnitude() const { return juce::jmax(magnitude[0], magnitude[1]); }
+    float getMonoMagnitude() const { return (magnitude[0] + magnitude[1]) / 2; }      // as PeakLevels::dbMono
+};
+
+// Raises target to value unless it already holds more. For peaks that a reader takes with exchange(0).
+inline void storeMax(std::atomic<float>& target, float value)
+{
+    // If a take lands in between, the exchange fails and value starts the new interval
+    float current = target.load(std::memory_order_relaxed);
+    while (value > current && ! target.compare_exchange_weak(current, value))
+    {
+    }
+}
+
+//==============================================================================
+//MARK: - PeakTracker
+
+/*
+   Maximum magnitude per channel since the last read, kept by the audio
+   thread from every block's BlockSummary. The reader takes the value and
+   starts the next interval with one exchange, so a peak either lands in the
+   interval being read or in the next one, never in neither.
+
+   The audio thread also runs the low-end filters, but only while someone
+   displays them: a one-pole low-pass (1 s time constant) whose output is
+   the DC offset, and a 4th-order Butterworth low-pass at 20 Hz (two
+   biquads) over the signal with that DC taken out, whose square is
+   smoothed over 300 ms. The two channels run through the same loop, one
+   lane each, so the compiler can keep them side by side in a vector
+   register. Both are published once per block as filter states, so
+   reading them doesn't reset anything.
+ */
+struct PeakTracker
+{
+    static constexpr int numChannels = 2;
+    static constexpr double subsonicCutoffHz = 20.0;
+    static constexpr double dcTimeConstantSeconds = 1.0;
+    static constexpr double subsonicTimeConstantSeconds = 0.3;
+    static constexpr int numSubsonicSections = 2;         // 4th order
+
+    PeakTracker() { prepare(44100.0); }
+
+    // Resets the low-end filters. Not while process() may be running.
+    void prepare(double sampleRate);
+
+    // Audio thread, lock-free. summary is buffer's. The low-end filters only run
+    // when runLowEnd is set, and start over from rest when it comes back on.
+    void process(const juce::AudioBuffer<float>& buffer, const BlockSummary& summary, bool runLowEnd);
+
+    // Any thread: the peak since the previous take
+    float takePeak(int channel) { return peak[static_cast<size_t>(channel)].exchange(0.f); }
+    PeakLevels takePeakLevels();
+
+    // Any thread, as of the end of the last block. The sub-sonic level reads
+    // 0 dB for a full-scale sine, like the level meters and the RTA.
+    float getDcOffset(int channel) const { return dcOffset[static_cast<size_t>(channel)].load(); }
+    float getSubsonicDb(int channel) const;
+    LowEndLevels getLowEndLevels() const;
+private:
+    std::array<std::atomic<float>, numChannels> peak {};
+    std::array<std::atomic<float>, numChannels> dcOffset {};
+    std::array<std::atomic<float>, numChannels> subsonicMeanSquare {};
+
+    // Audio thread only. Double precision: at 20 Hz the biquads' poles sit very close
+    // to the unit circle. Channel innermost, so each is a lane of the same arithmetic.
+    using Lanes = std::array<double, numChannels>;
+
+    struct LowEndState
+    {
+        Lanes dc {};
+        std::array<Lanes, numSubsonicSections> z1 {}, z2 {};
+        Lanes meanSquare {};
+    };
+    LowEndState lowEnd;
+    bool lowEndRunning { false };
+
+    struct Section
+    {
+        double b0 { 0.0 }, b1 { 0.0 }, b2 { 0.0 }, a1 { 0.0 }, a2 { 0.0 };
+    };
+    std::array<Section, numSubsonicSections> sections;
+
+    double dcCoefficient { 0.0 };
+    double meanSquareCoefficient { 0.0 };
+
+    void resetLowEnd();
+    void processLowEnd(const float* left, const float* right, int numSamples);
+};
+
+//==============================================================================
+//MARK: - TruePeakDetector
+
+/*
+   Inter-sample peaks (BS.1770 true peak): the signal is upsampled 8x with a
+   linear-phase half-band FIR cascade and the peak taken over the result.
+   Too heavy for the audio thread; meant for offline passes and the editor's
+   update thread.
+ */
+struct TruePeakDetector
+{
+    static constexpr int numChannels = 2;
+    static constexpr int oversamplingOrder = 3;       // 2^3 = 8x
+
+    void prepare(int maxBlockSize);
+    void reset();
+    void process(const juce::AudioBuffer<float>& buffer, int startSample, int numSamples);
+
+    // Pushes the filter latency through, so peaks at the very end are counted.
+    void flush();
+
+    float getTruePeakDb(int channel) const;
+    juce::int64 getNumOvers(int channel) const { return overs[static_cast<size_t>(channel)]; }
+private:
+    std::unique_ptr<juce::dsp::Oversampling<float>> oversampling;
+    juce::AudioBuffer<float> stereoBlock;
+    int maxBlockSize { 0 };
+
+    std::array<float, numChannels> truePeak {};
+    std::array<juce::int64, numChannels> overs {};     // oversampled samples at or above full scale
+
+    void processBlock(int numSamples);
+};
+
+//==============================================================================
+//MARK: - DynamicRangeAnalyser
+
+/*
+   Crest factor (peak over RMS) and PSR (peak over short-term loudness)
+   across a sliding window, in 100 ms steps. Each step's peak and plain
+   energy come from a BlockSummary of its samples, the same accumulators the
+   processor uses; only the K-weighting for the loudness runs per sample here.
+   Step peaks feed a SlidingWindowMax, and the plain and K-weighted energies
+   are running sums that drop the oldest step as it leaves the window, so each
+   step costs O(1) amortised.
+
+   The peak is the sample peak of both channels and the loudness is the
+   ungated K-weighted level of the window, which at the default 3 s is the
+   BS.1770 short-term loudness; their ratio is the PSR. A window that hasn't
+   filled yet reads over the steps it has.
+
+   PLR is the true peak over the gated integrated loudness, both since the
+   last prepare() or reset(), so it starts over with the window. The steps
+   are the 100 ms BS.1770 sub-blocks, so the window's K-weighting feeds a
+   LoudnessHistogram too, which keeps the step O(1) and the memory fixed
+   however long the session runs; the true peak comes from a TruePeakDetector.
+ */
+struct DynamicRangeAnalyser
+{
+    static constexpr double stepSeconds = 0.1;
+    static constexpr int maxWindowSteps = 600;      // 60 s
+
+    void prepare(double sampleRate, double windowSeconds);
+    void reset();
+
+    // Any number of samples; a mono buffer counts as both channels
+    void process(const juce::AudioBuffer<float>& buffer, int startSample, int numSamples);
+
+    bool hasReading() const { return ! windowPeak.isEmpty(); }
+    float getPeakDb() const;
+    float getRmsDb() const;
+    float getLoudnessLufs() const;
+
+    // NEGATIVE_INFINITY over silence or before the first step
+    float getCrestFactorDb() const;
+    float getPsrDb() const;
+    float getPlrDb() const { return plrDb; }
+private:
+    std::array<KWeightingFilter, 2> kWeighting;
+    TruePeakDetector truePeak;
+    LoudnessHistogram loudness;
+    float plrDb { NEGATIVE_INFINITY };
+
+    int samplesPerStep { 4800 };
+    int samplesIntoStep { 0 };
+    float stepPeak { 0.f };
+    double stepSumOfSquares { 0.0 };
+    double stepWeightedSumOfSquares { 0.0 };
+
+    SlidingWindowMax windowPeak;
+
+    // Per-step energies still in the window, oldest at ringIndex once full
+    std::vector<double> sumsOfSquares, weightedSumsOfSquares;
+    size_t ringIndex { 0 };
+    int numStepsInWindow { 0 };
+    double windowSumOfSquares { 0.0 };
+    double windowWeightedSumOfSquares { 0.0 };
+
+    void endStep();
+    void updatePlr();
+};
+
+//==============================================================================
+//MARK: - NoiseFloorEstimator
+
+/*
+   Background noise level by minimum statistics. The mean square of each
+   50 ms step is smoothed (about 100 ms), and the floor is the minimum of
+   that over a sliding window long enough to reach into the pauses between
+   phrases. The minimum comes from a SlidingWindowMin and the window's mean
+   from an Averager, so each step is O(1) and memory is fixed by the window
+   length, however long it runs.
+
+   The minimum of a smoothed power sits a little below the noise's mean
+   power; it's reported as is, as a floor. SNR is the window's RMS over that
+   floor.
+ */
+struct NoiseFloorEstimator
+{
+    static constexpr double stepSeconds = 0.05;
+    static constexpr double smoothingSeconds = 0.1;
+
+    void prepare(double sampleRate, double windowSeconds = 5.0);
+    void reset();
+
+    // Any number of samples; a mono buffer counts as both channels
+    void process(const juce::AudioBuffer<float>& buffer, int startSample, int numSamples);
+
+    // NEGATIVE_INFINITY before the first step and over digital silence
+    float getNoiseFloorDb() const;
+    float getSignalDb() const;
+    float getSnrDb() const;
+private:
+    int samplesPerStep { 2400 };
+    int samplesIntoStep { 0 };
+    double stepSumOfSquares { 0.0 };
+
+    double smoothingCoefficient { 1.0 };
+    double smoothedMeanSquare { -1.0 };         // < 0 until the first step
+
+    SlidingWindowMin windowMinimum;             // smoothed step levels, dB
+    Averager<double> windowMeanSquare { 1, 0.0 };
+
+    void endStep();
+};
+
+//==============================================================================
+//MARK: - MeterStatistics
+
+struct MeterStatistics
+{
+    static constexpr int numChannels = 2;
+    static constexpr int levelBinWidthDb = 1;
+    static constexpr int numLevelBins = static_cast<int>(MAX_DECIBELS - NEGATIVE_INFINITY) / levelBinWidthDb;
+
+    void reset();
+    void addBlock(int channel, float blockPeak, double blockSumOfSquares, int numSamples);
+    void addFrame(const PeakLevels& levels, float slowCorrelation, float peakCorrelation);
+
+    // Folds in the statistics of the audio that immediately follows this one.
+    // Merging is associative, so segments can be reduced in any grouping as
+    // long as their order is kept. Peaks, counts, the level distribution and
+    // the gated loudness merge exactly; the sums of squares and correlations
+    // are double sums added up in a different grouping, which moves them by
+    // about 1e-15 of their value, far below anything the tool prints.
+    void merge(const MeterStatistics& later);
+
+    static int levelToBin(float db);
+
+    float getPeakDb(int channel) const;
+    float getRmsDb(int channel) const;
+    float getCorrelationMean() const;
+
+    std::array<float, numChannels>  peak {};
+    std::array<double, numChannels> sumOfSquares {};
+    std::array<juce::int64, numChannels> numSamplesPerChannel {};
+
+    juce::int64 numFrames { 0 };
+    double correlationSum { 0.0 };
+    float correlationMin { 1.f };
+    float correlationMax { -1.f };
+
+    std::array<juce::int64, numLevelBins> levelHistogram {};
+
+    LoudnessGating loudness;
+};
+
+//==============================================================================
+//MARK: - MeterReadout
+
+// Levels over one readout interval, plus the running correlation and loudness.
+struct MeterReadout
+{
+    std::array<float, MeterStatistics::numChannels> peakDb { NEGATIVE_INFINITY, NEGATIVE_INFINITY };
+    std::array<float, MeterStatistics::numChannels> rmsDb  { NEGATIVE_INFINITY, NEGATIVE_INFINITY };
+    float correlation { 0.f };
+    float momentaryLufs { LoudnessGating::absoluteGateLufs };
+    float shortTermLufs { LoudnessGating::absoluteGateLufs };
+};
+
+//==============================================================================
+//MARK: - MeterAnalysisEngine
+
+/*
+   Runs the editor's metering chain over arbitrary blocks of audio. Frames are
+   cut at the editor refresh rate, so the level distribution and correlation
+   figures match what the plugin displays for the same material.
+
+   To analyse one file in several pieces, start each piece on a multiple of
+   getSegmentAlignment() and feed it the getPreRollLength() samples before
+   its start through preRoll() first. That settles the correlation filters,
+   averagers and K-weighting so the merged statistics match a single pass.
+ */
+struct MeterAnalysisEngine
+{
+    static constexpr int slowCorrelationLength = 1024*4;
+    static constexpr int peakCorrelationLength = 512;
+    static constexpr double preRollSeconds = 0.5;
+    static constexpr int momentarySubBlocks = 4;      // 400 ms
+    static constexpr int shortTermSubBlocks = 30;     // 3 s
+
+    MeterAnalysisEngine();
+
+    void prepare(double sampleRate, int frameRateHz);
+    void preRoll(const juce::AudioBuffer<float>& buffer, int startSample, int numSamples);
+    void process(const juce::AudioBuffer<float>& buffer, int startSample, int numSamples);
+
+    // Reads interleaved samples in place, without de-interleaving into a buffer first.
+    void processInterleaved(const float* interleaved, int numChannels, int numSamples);
+
+    const MeterStatistics& getStatistics() const { return statistics; }
+
+    // Peak and RMS since the previous call, with the current correlation and loudness.
+    MeterReadout takeReadout();
+
+    static int getSamplesPerFrame(double sampleRate, int frameRateHz);
+    static int getSamplesPerSubBlock(double sampleRate);
+    static int getSegmentAlignment(double sampleRate, int frameRateHz);
+    static int getPreRollLength(double sampleRate);
+private:
+    CorrelationAnalyser correlation;
+    // Only read once per frame, so they can afford to be exact
+    WindowedMean slowCorrelationAverager { slowCorrelationLength, 0.f },
+                 peakCorrelationAverager { peakCorrelationLength, 0.f };
+    std::array<KWeightingFilter, MeterStatistics::numChannels> kWeighting;
+
+    MeterStatistics statistics;
+
+    int samplesPerFrame { 800 };
+    int samplesIntoFrame { 0 };
+    float frameMagLeft { 0.f };
+    float frameMagRight { 0.f };
+
+    int samplesPerSubBlock { 4800 };
+    int samplesIntoSubBlock { 0 };
+    double subBlockSumOfSquares { 0.0 };
+
+    std::array<double, shortTermSubBlocks> recentSubBlocks {};
+    int recentSubBlocksWriteIndex { 0 };
+    int numRecentSubBlocks { 0 };
+
+    std::array<float, MeterStatistics::numChannels> intervalPeak {};
+    std::array<double, MeterStatistics::numChannels> intervalSumOfSquares {};
+    juce::int64 intervalNumSamples { 0 };
+
+    void processSamples(const float* left, const float* right, int stride, bool isStereo, int numSamples, bool accumulate);
+    void endFrame();
+    void endSubBlock();
+    float getRecentLoudness(int numSubBlocks) const;
+};
@@ -0,0 +1,472 @@
+//
+//  MeterLog.cpp
+//  PFM10 - Shared Code
+//
+
+#include "MeterLog.h"
+
+//==============================================================================
+//MARK: - MeterLogHeader
+
+bool MeterLogHeader::isValid() const
+{
+    return magic[0] == 'P' && magic[1] == 'F' && magic[2] == 'M' && magic[3] == 'L'
+        && version == currentVersion
+        && frameSize == sizeof(MeterLogFrame)
+        && sampleRate > 0
+        && frameIntervalMs > 0;
+}
+
+//==============================================================================
+//MARK: - MeterLogWriter
+
+MeterLogWriter::MeterLogWriter()
+    : juce::Thread("PFM10 Meter Log Writer")
+{
+}
+
+MeterLogWriter::~MeterLogWriter()
+{
+    stop();
+}
+
+bool MeterLogWriter::start(const juce::File& _file, double sampleRate, int frameIntervalMs)
+{
+    stop();
+
+    _file.getParentDirectory().createDirectory();
+
+    // Truncated rather than deleted and created again, so a file claimed with
+    // PFM10AudioProcessor::createLogFile() stays ours throughout
+    stream = std::make_unique<juce::FileOutputStream>(_file, streamBufferSize);
+
+    if (stream->failedToOpen() || ! stream->setPosition(0) || stream->truncate().failed())
+    {
+        stream.reset();
+        return false;
+    }
+
+    file = _file;
+
+    MeterLogHeader header;
+    header.sampleRate = sampleRate;
+    header.frameIntervalMs = static_cast<juce::uint32>(frameIntervalMs);
+    header.frameSize = sizeof(MeterLogFrame);
+    header.startTimeMs = juce::Time::currentTimeMillis();
+    stream->write(&header, sizeof(header));
+
+    // Anything still queued, or still to come, from before this belongs to the previous log.
+    // The FIFO itself is left alone: the audio thread may be pushing into it right now.
+    ++session;
+
+    startThread();
+    active = true;
+
+    return true;
+}
+
+void MeterLogWriter::stop()
+{
+    if (! active.exchange(false))
+        return;
+
+    stopThread(2000);
+
+    // The thread drains once more on its way out, this catches frames pushed after that
+    drain();
+
+    stream->flush();
+    stream.reset();
+}
+
+bool MeterLogWriter::beginBlock()
+{
+    auto current = session.load();
+
+    if (current == producerSession)
+        return false;
+
+    producerSession = current;
+    return true;
+}
+
+bool MeterLogWriter::push(const MeterLogFrame& frame)
+{
+    auto scopedWrite = fifo.write(1);
+    if (scopedWrite.blockSize1 > 0)
+    {
+        frames[static_cast<size_t>(scopedWrite.startIndex1)] = { frame, producerSession };
+        return true;
+    }
+    return false;
+}
+
+void MeterLogWriter::run()
+{
+    juce::uint32 lastFlush = juce::Time::getMillisecondCounter();
+
+    while (! threadShouldExit())
+    {
+        wait(wakeIntervalMs);
+
+        drain();
+
+        // The stream buffer does the batching, this only bounds what a crash could lose
+        auto now = juce::Time::getMillisecondCounter();
+        if (now - lastFlush > static_cast<juce::uint32>(flushIntervalMs))
+        {
+            stream->flush();
+            lastFlush = now;
+        }
+    }
+
+    drain();
+}
+
+void MeterLogWriter::drain()
+{
+    int numReady = fifo.getNumReady();
+    if (numReady == 0)
+        return;
+
+    auto current = session.load();
+
+    // Frame by frame, the stream buffer does the batching
+    fifo.read(numReady).forEach([this, current](int index)
+    {
+        const auto& queued = frames[static_cast<size_t>(index)];
+
+        if (queued.session == current)
+            stream->write(&queued.frame, sizeof(MeterLogFrame));
+    });
+}
+
+//==============================================================================
+//MARK: - MeterLogAccumulator
+
+void MeterLogAccumulator::prepare(double sampleRate, int frameIntervalMs)
+{
+    exactSamplesPerFrame = juce::jmax(1.0, sampleRate * frameIntervalMs / 1000.0);
+    reset();
+}
+
+int MeterLogAccumulator::getFrameLength(juce::int64 frame) const
+{
+    auto start = std::llround(static_cast<double>(frame) * exactSamplesPerFrame);
+    auto end   = std::llround(static_cast<double>(frame + 1) * exactSamplesPerFrame);
+    return static_cast<int>(end - start);
+}
+
+void MeterLogAccumulator::reset()
+{
+    numFramesEnded = 0;
+    samplesPerFrame = getFrameLength(0);
+    samplesIntoFrame = 0;
+    frameHostTime = -1;
+    framePlaying = false;
+    peak.fill(0.f);
+    sumOfSquares.fill(0.0);
+    sumOfProducts = 0.0;
+}
+
+void MeterLogAccumulator::process(const juce::AudioBuffer<float>& buffer,
+                                  juce::int64 hostTimeInSamples,
+                                  bool hostIsPlaying,
+                                  float thresholdDb,
+                                  MeterFrameSink& sink)
+{
+    int numChannels = buffer.getNumChannels();
+    int numSamples = buffer.getNumSamples();
+    if (numChannels == 0)
+        return;
+
+    const float* left  = buffer.getReadPointer(0);
+    const float* right = buffer.getReadPointer(numChannels > 1 ? 1 : 0);
+
+    int position = 0;
+    while (position < numSamples)
+    {
+        if (samplesIntoFrame == 0)
+        {
+            frameHostTime = hostTimeInSamples >= 0 ? hostTimeInSamples + position : -1;
+            framePlaying = hostIsPlaying;
+            frameThresholdDb = thresholdDb;
+        }
+
+        int numToFrameEnd = juce::jmin(samplesPerFrame - samplesIntoFrame, numSamples - position);
+
+        for (int i = position; i < position + numToFrameEnd; ++i)
+        {
+            float l = left[i];
+            float r = right[i];
+
+            peak[0] = juce::jmax(peak[0], std::abs(l));
+            peak[1] = juce::jmax(peak[1], std::abs(r));
+            sumOfSquares[0] += static_cast<double>(l) * l;
+            sumOfSquares[1] += static_cast<double>(r) * r;
+            sumOfProducts   += static_cast<double>(l) * r;
+        }
+
+        position += numToFrameEnd;
+        samplesIntoFrame += numToFrameEnd;
+
+        if (samplesIntoFrame == samplesPerFrame)
+            endFrame(sink);
+    }
+}
+
+void MeterLogAccumulator::flush(MeterFrameSink& sink)
+{
+    if (samplesIntoFrame > 0)
+        endFrame(sink);
+}
+
+void MeterLogAccumulator::endFrame(MeterFrameSink& sink)
+{
+    MeterLogFrame frame;
+    frame.hostTimeInSamples = frameHostTime;
+
+    for (size_t ch = 0; ch < 2; ++ch)
+    {
+        frame.peakDb[ch] = juce::Decibels::gainToDecibels(peak[ch], NEGATIVE_INFINITY);
+        frame.rmsDb[ch]  = juce::Decibels::gainToDecibels(static_cast<float>(std::sqrt(sumOfSquares[ch] / samplesIntoFrame)),
+                                                          NEGATIVE_INFINITY);
+    }
+
+    double denominator = std::sqrt(sumOfSquares[0] * sumOfSquares[1]);
+    frame.correlation = denominator > 0.0 ? static_cast<float>(sumOfProducts / denominator) : 0.f;
+
+    if (peak[0] >= 1.f) frame.flags |= MeterLogFrame::overLeft;
+    if (peak[1] >= 1.f) frame.flags |= MeterLogFrame::overRight;
+    if (framePlaying)   frame.flags |= MeterLogFrame::hostPlaying;
+    if (juce::jmax(frame.peakDb[0], frame.peakDb[1]) > frameThresholdDb)
+        frame.flags |= MeterLogFrame::overThreshold;
+
+    sink.push(frame);
+
+    ++numFramesEnded;
+    samplesPerFrame = getFrameLength(numFramesEnded);
+    samplesIntoFrame = 0;
+    peak.fill(0.f);
+    sumOfSquares.fill(0.0);
+    sumOfProducts = 0.0;
+}
+
+//==============================================================================
+//MARK: - MeterLogReader
+
+MeterLogReader::MeterLogReader(const juce::File& _file)
+    : juce::Thread("PFM10 Meter Log Reader"),
+      file(_file)
+{
+    juce::FileInputStream stream(file);
+
+    if (stream.openedOk() && stream.read(&header, sizeof(MeterLogHeader)) == static_cast<int>(sizeof(MeterLogHeader)))
+        headerOk = header.isValid();
+
+    if (headerOk)
+        startThread();
+}
+
+MeterLogReader::~MeterLogReader()
+{
+    stopThread(2000);
+}
+
+juce::int64 MeterLogReader::getNumFramesOnDisk() const
+{
+    auto size = file.getSize();
+    if (size < static_cast<juce::int64>(sizeof(MeterLogHeader)))
+        return 0;
+
+    // A log that is still being written may end on a partial frame, ignore it
+    return (size - static_cast<juce::int64>(sizeof(MeterLogHeader))) / static_cast<juce::int64>(sizeof(MeterLogFrame));
+}
+
+bool MeterLogReader::refresh()
+{
+    if (! headerOk)
+        return false;
+
+    std::shared_ptr<const Snapshot> next;
+    {
+        std::lock_guard<std::mutex> lock(builtMutex);
+        next = std::move(built);
+    }
+
+    bool changed = next != nullptr;
+    if (changed)
+        snapshot = std::move(next);
+
+    // The builder reads previous, so it's only set while the builder is idle
+    if (snapshot != nullptr && ! isThreadRunning() && getNumFramesOnDisk() > snapshot->numFrames)
+    {
+        previous = snapshot;
+        startThread();
+    }
+
+    return changed;
+}
+
+void MeterLogReader::run()
+{
+    auto next = std::make_shared<Snapshot>();
+    next->mappedFile = std::make_unique<juce::MemoryMappedFile>(file, juce::MemoryMappedFile::readOnly, false);
+
+    auto* data = static_cast<const char*>(next->mappedFile->getData());
+    auto size = next->mappedFile->getSize();
+
+    juce::int64 numFrames = 0;
+    if (data != nullptr && size >= sizeof(MeterLogHeader))
+        numFrames = static_cast<juce::int64>((size - sizeof(MeterLogHeader)) / sizeof(MeterLogFrame));
+
+    // Nothing new, or the file couldn't be mapped this time
+    if (previous != nullptr && numFrames <= previous->numFrames)
+        return;
+
+    next->frames = data != nullptr ? reinterpret_cast<const MeterLogFrame*>(data + sizeof(MeterLogHeader)) : nullptr;
+    next->numFrames = numFrames;
+
+    // Only the entries over frames added since the previous build change,
+    // that's its last, partial, entry at each level onwards
+    juce::int64 firstNewFrame = 0;
+    if (previous != nullptr)
+    {
+        next->levels = previous->levels;
+        firstNewFrame = previous->numFrames;
+    }
+
+    auto firstChanged = static_cast<size_t>(firstNewFrame / summaryFanout);
+    auto numEntries = static_cast<size_t>((numFrames + summaryFanout - 1) / summaryFanout);
+
+    for (size_t level = 0; numEntries > 0; ++level)
+    {
+        if (next->levels.size() <= level)
+            next->levels.emplace_back();
+
+        auto& entries = next->levels[level];
+        entries.resize(numEntries);
+
+        for (auto i = firstChanged; i < numEntries; ++i)
+        {
+            if (threadShouldExit())
+                return;
+
+            if (level == 0)
+            {
+                auto start = static_cast<juce::int64>(i) * summaryFanout;
+                entries[i] = next->scanFrames(start, juce::jmin(start + summaryFanout, numFrames));
+            }
+            else
+            {
+                auto& finer = next->levels[level - 1];
+                Span span;
+
+                for (auto j = i * summaryFanout; j < juce::jmin((i + 1) * summaryFanout, finer.size()); ++j)
+                    span.add(finer[j]);
+
+                entries[i] = span;
+            }
+        }
+
+        if (numEntries == 1)
+        {
+            next->levels.resize(level + 1);
+            break;
+        }
+
+        firstChanged /= summaryFanout;
+        numEntries = (numEntries + summaryFanout - 1) / summaryFanout;
+    }
+
+    std::lock_guard<std::mutex> lock(builtMutex);
+    built = std::move(next);
+}
+
+void MeterLogReader::getSpans(double startFrame, double framesPerColumn, int numColumns, std::vector<Span>& spans) const
+{
+    spans.assign(static_cast<size_t>(juce::jmax(0, numColumns)), Span());
+
+    if (snapshot == nullptr || framesPerColumn <= 0)
+        return;
+
+    for (int column = 0; column < numColumns; ++column)
+    {
+        auto start = static_cast<juce::int64>(std::floor(startFrame + column * framesPerColumn));
+        auto end   = static_cast<juce::int64>(std::floor(startFrame + (column + 1) * framesPerColumn));
+        end = juce::jmax(end, start + 1);
+
+        start = juce::jmax(start, juce::int64(0));
+        end   = juce::jmin(end, snapshot->numFrames);
+
+        if (start >= end)
+            continue;
+
+        juce::int64 length = end - start;
+
+        // Coarsest level whose entries are no wider than the column
+        int level = -1;
+        juce::int64 entrySize = 1;
+        while (entrySize * summaryFanout <= length)
+        {
+            entrySize *= summaryFanout;
+            ++level;
+        }
+
+        snapshot->addRange(spans[static_cast<size_t>(column)], start, end, level);
+    }
+}
+
+void MeterLogReader::Snapshot::addRange(Span& span, juce::int64 start, juce::int64 end, int level) const
+{
+    if (start >= end)
+        return;
+
+    if (level < 0)
+    {
+        span.add(scanFrames(start, end));
+        return;
+    }
+
+    juce::int64 entrySize = summaryFanout;
+    for (int n = 0; n < level; ++n)
+        entrySize *= summaryFanout;
+
+    // Whole entries only, the ragged ends come from the level below so a
+    // column never picks up a peak from outside its own frames
+    juce::int64 first = (start + entrySize - 1) / entrySize;
+    juce::int64 last  = end / entrySize;
+
+    if (first >= last)
+    {
+        addRange(span, start, end, level - 1);
+        return;
+    }
+
+    addRange(span, start, first * entrySize, level - 1);
+
+    auto& entries = levels[static_cast<size_t>(level)];
+    for (auto i = first; i < last; ++i)
+        span.add(entries[static_cast<size_t>(i)]);
+
+    addRange(span, last * entrySize, end, level - 1);
+}
+
+float MeterLogReader::getMonoPeakDb(const MeterLogFrame& frame)
+{
+    // Same mono level the live histogram plots: avg. of the left and right magnitudes
+    float magLeft  = juce::Decibels::decibelsToGain(frame.peakDb[0], NEGATIVE_INFINITY);
+    float magRight = juce::Decibels::decibelsToGain(frame.peakDb[1], NEGATIVE_INFINITY);
+
+    return juce::Decibels::gainToDecibels((magLeft + magRight) / 2, NEGATIVE_INFINITY);
+}
+
+MeterLogReader::Span MeterLogReader::Snapshot::scanFrames(juce::int64 start, juce::int64 end) const
+{
+    Span span;
+
+    for (auto i = start; i < end; ++i)
+        span.add(getMonoPeakDb(frames[i]));
+
+    return span;
+}
@@ -0,0 +1,263 @@
+//
+//  MeterLog.h
+//  PFM10 - Shared Code
+//
+//  Session meter log: one fixed-size record per 100 ms of audio, written to
+//  disk by a background thread.
+//
+//  File layout (little-endian):
+//      MeterLogHeader   32 bytes
+//      MeterLogFrame    32 bytes each, back to back until end of file
+//
+//  The audio thread only ever touches MeterLogAccumulator and
+//  MeterLogWriter::beginBlock() and push(), none of which locks or
+//  allocates. The message thread never touches the accumulator.
+//
+//  MeterLogReader maps a finished (or still growing) log read-only. Frames
+//  are fixed-size, so frame n lives at a known offset and nothing has to be
+//  parsed when the file is opened.
+//
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <memory>
+#include <mutex>
+#include "MeterAnalysis.h"
+
+//==============================================================================
+//MARK: - MeterLogHeader
+
+struct MeterLogHeader
+{
+    static constexpr juce::uint32 currentVersion = 1;
+
+    char magic[4] { 'P', 'F', 'M', 'L' };
+    juce::uint32 version { currentVersion };
+    double sampleRate { 0.0 };
+    juce::uint32 frameIntervalMs { 0 };
+    juce::uint32 frameSize { 0 };
+    juce::int64 startTimeMs { 0 };      // wall clock, ms since 1970
+
+    bool isValid() const;
+};
+
+//==============================================================================
+//MARK: - MeterLogFrame
+
+struct MeterLogFrame
+{
+    enum Flags : juce::uint32
+    {
+        overLeft    = 1 << 0,           // a sample reached 0 dBFS or above
+        overRight   = 1 << 1,
+        hostPlaying = 1 << 2,
+        overThreshold = 1 << 3          // either peak went above the meter threshold setting
+    };
+
+    juce::int64 hostTimeInSamples { -1 };   // -1 when the host doesn't report a position
+    float peakDb[2] { NEGATIVE_INFINITY, NEGATIVE_INFINITY };
+    float rmsDb[2]  { NEGATIVE_INFINITY, NEGATIVE_INFINITY };
+    float correlation { 0.f };
+    juce::uint32 flags { 0 };
+};
+
+static_assert(sizeof(MeterLogHeader) == 32, "MeterLogHeader is part of the file format");
+static_assert(sizeof(MeterLogFrame) == 32, "MeterLogFrame is part of the file format");
+
+//==============================================================================
+//MARK: - MeterFrameSink
+
+// Where MeterLogAccumulator sends finished frames. push() is called on the audio thread and must not block.
+struct MeterFrameSink
+{
+    virtual ~MeterFrameSink() = default;
+    virtual bool push(const MeterLogFrame& frame) = 0;
+};
+
+//==============================================================================
+//MARK: - MeterLogWriter
+
+class MeterLogWriter : public MeterFrameSink, private juce::Thread
+{
+public:
+    static constexpr int queueSize = 256;               // ~25 s of frames
+    static constexpr int wakeIntervalMs = 1000;
+    static constexpr int flushIntervalMs = 30000;
+    static constexpr size_t streamBufferSize = 1 << 16;
+
+    MeterLogWriter();
+    ~MeterLogWriter() override;
+
+    // Message thread
+    bool start(const juce::File& file, double sampleRate, int frameIntervalMs);
+    void stop();
+    juce::File getFile() const { return file; }
+
+    /* Audio thread, at the top of every block. Returns true once for each
+       start(), on the first block after it: whatever feeds the log has to
+       reset there, so the new log doesn't begin with the old one's partial
+       frame. Frames pushed by blocks that began before the start() are
+       dropped rather than written to the new log.
+     */
+    bool beginBlock();
+
+    // Audio thread, wait-free. Returns false (and drops the frame) if the queue is full.
+    bool push(const MeterLogFrame& frame) override;
+    bool isActive() const { return active.load(); }
+
+private:
+    // Tagged with the log they were pushed for; the writer thread skips the others
+    struct QueuedFrame
+    {
+        MeterLogFrame frame;
+        juce::uint32 session { 0 };
+    };
+
+    juce::AbstractFifo fifo { queueSize };
+    std::array<QueuedFrame, queueSize> frames;
+
+    std::atomic<juce::uint32> session { 0 };
+    juce::uint32 producerSession { 0 };     // audio thread only
+
+    juce::File file;
+    std::unique_ptr<juce::FileOutputStream> stream;
+    std::atomic<bool> active { false };
+
+    void run() override;
+    void drain();
+};
+
+//==============================================================================
+//MARK: - MeterLogAccumulator
+
+/*
+   Builds MeterLogFrames from the processor's blocks. Correlation is the
+   normalised cross-product over the frame, sum(L*R) / sqrt(sum(L^2) * sum(R^2)),
+   which falls out of the same sums the RMS needs.
+
+   Frame n starts at sample round(n * sampleRate * frameIntervalMs / 1000),
+   so when the interval isn't a whole number of samples (1 ms at 44.1 kHz)
+   frames differ in length by one sample rather than drifting away from the
+   interval in the header.
+ */
+struct MeterLogAccumulator
+{
+    void prepare(double sampleRate, int frameIntervalMs);
+    void reset();
+    void process(const juce::AudioBuffer<float>& buffer,
+                 juce::int64 hostTimeInSamples,
+                 bool hostIsPlaying,
+                 float thresholdDb,
+                 MeterFrameSink& sink);
+
+    // Ends a partial frame, if there is one, so the last few samples of a stream aren't lost
+    void flush(MeterFrameSink& sink);
+private:
+    double exactSamplesPerFrame { 4800.0 };
+    juce::int64 numFramesEnded { 0 };
+    int samplesPerFrame { 4800 };           // length of the frame being built
+    int samplesIntoFrame { 0 };
+
+    juce::int64 frameHostTime { -1 };
+    bool framePlaying { false };
+    float frameThresholdDb { 0.f };
+    std::array<float, 2> peak {};
+    std::array<double, 2> sumOfSquares {};
+    double sumOfProducts { 0.0 };
+
+    int getFrameLength(juce::int64 frame) const;
+    void endFrame(MeterFrameSink& sink);
+};
+
+//==============================================================================
+//MARK: - MeterLogReader
+
+/*
+   The min/max summary of the log is built on a background thread, so
+   opening an hour-long log doesn't hold up the message thread. Until the
+   first build is done the reader is loading and has no frames. A log that
+   is still being written is picked up again by refresh(), which only
+   summarises the frames added since the last build.
+
+   Each build is an immutable Snapshot with its own mapping of the file, so
+   the message thread keeps drawing the previous one while the next is made.
+ */
+class MeterLogReader : private juce::Thread
+{
+public:
+    // Min and max of the mono peak level over a stretch of frames.
+    struct Span
+    {
+        float minDb { MAX_DECIBELS };
+        float maxDb { NEGATIVE_INFINITY };
+
+        bool isEmpty() const { return minDb > maxDb; }
+        void add(float db)        { minDb = juce::jmin(minDb, db);        maxDb = juce::jmax(maxDb, db); }
+        void add(const Span& s)   { minDb = juce::jmin(minDb, s.minDb);   maxDb = juce::jmax(maxDb, s.maxDb); }
+    };
+
+    static constexpr int summaryFanout = 4;
+
+    // Checks the header and starts the first build
+    explicit MeterLogReader(const juce::File& file);
+    ~MeterLogReader() override;
+
+    bool openedOk() const { return headerOk; }
+    const juce::File& getFile() const { return file; }
+    const MeterLogHeader& getHeader() const { return header; }
+
+    // Message thread, from here on
+    bool isLoading() const { return snapshot == nullptr; }
+    juce::int64 getNumFrames() const { return snapshot != nullptr ? snapshot->numFrames : 0; }
+    const MeterLogFrame& getFrame(juce::int64 index) const { return snapshot->frames[index]; }
+
+    /* Takes a finished build, if there is one, and starts another if the
+       file has grown by a whole frame since the last. Returns true when the
+       frames have changed. Cheap enough for a slow timer.
+     */
+    bool refresh();
+
+    /* Fills one Span per column, column n covering the frames from
+       startFrame + n * framesPerColumn up to the next column. Each column reads
+       a handful of entries from the summary level that fits its width, and
+       finer levels for its ragged ends, so a column only ever covers its own
+       frames. The cost depends on the number of columns, not on how many
+       frames they span. Columns past either end of the log come back empty,
+       as do all of them while loading.
+     */
+    void getSpans(double startFrame, double framesPerColumn, int numColumns, std::vector<Span>& spans) const;
+
+    static float getMonoPeakDb(const MeterLogFrame& frame);
+
+private:
+    struct Snapshot
+    {
+        std::unique_ptr<juce::MemoryMappedFile> mappedFile;
+        const MeterLogFrame* frames { nullptr };
+        juce::int64 numFrames { 0 };
+
+        // levels[n] holds one Span per summaryFanout^(n+1) frames, down to a single Span
+        std::vector<std::vector<Span>> levels;
+
+        Span scanFrames(juce::int64 start, juce::int64 end) const;
+        void addRange(Span& span, juce::int64 start, juce::int64 end, int level) const;    // level -1 is the frames themselves
+    };
+
+    juce::File file;
+    MeterLogHeader header;
+    bool headerOk { false };
+
+    std::shared_ptr<const Snapshot> snapshot;       // message thread
+
+    // Handed from the builder to the message thread
+    std::mutex builtMutex;
+    std::shared_ptr<const Snapshot> built;
+
+    // Builder thread: the snapshot it extends, set before each start
+    std::shared_ptr<const Snapshot> previous;
+
+    void run() override;
+    juce::int64 getNumFramesOnDisk() const;
+};
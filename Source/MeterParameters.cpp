@@ -0,0 +1,185 @@
+//
+//  MeterParameters.cpp
+//  PFM10
+//
+
+#include "MeterParameters.h"
+#include "MeterAnalysis.h"
+#include "SettingsBatch.h"
+
+MeterParameters::MeterParameters(juce::AudioProcessor& processor, juce::ValueTree _vt)
+    : vt(_vt)
+{
+    juce::StringArray decayRateNames;
+    for (int rate : decayRates)
+        decayRateNames.add("-" + juce::String(rate) + "dB/s");
+
+    juce::StringArray holdTimeNames { "0s" };
+    for (int ms : holdDurations)
+        holdTimeNames.add(juce::String(ms / 1000.f, ms % 1000 == 0 ? 0 : 1) + "s");
+    holdTimeNames.add("inf");
+
+    // Plain-value defaults are placeholders, pushTreeToParameters() sets the real ones below
+    threshold = new juce::AudioParameterFloat(juce::ParameterID { IDs::thresholdValue.toString(), 1 },
+                                              "Threshold",
+                                              juce::NormalisableRange<float>(NEGATIVE_INFINITY, MAX_DECIBELS),
+                                              DefaultPropertyValues::thresholdValue);
+    decayRate = new juce::AudioParameterChoice(juce::ParameterID { IDs::decayRate.toString(), 1 },
+                                               "Decay Rate",
+                                               decayRateNames,
+                                               decayRateToIndex(DefaultPropertyValues::decayRate));
+    holdTime = new juce::AudioParameterChoice(juce::ParameterID { IDs::peakHoldDuration.toString(), 1 },
+                                              "Hold Time",
+                                              holdTimeNames,
+                                              1);
+    goniometerScale = new juce::AudioParameterFloat(juce::ParameterID { IDs::goniometerScale.toString(), 1 },
+                                                    "Gonio Scale",
+                                                    juce::NormalisableRange<float>(0.5f, 2.0f),
+                                                    DefaultPropertyValues::goniometerScale);
+
+    processor.addParameter(threshold);
+    processor.addParameter(decayRate);
+    processor.addParameter(holdTime);
+    processor.addParameter(goniometerScale);
+
+    pushTreeToParameters(false);
+
+    vt.addListener(this);
+
+    for (auto* parameter : getParameters())
+        parameter->addListener(this);
+
+    startTimerHz(syncRateHz);
+}
+
+MeterParameters::~MeterParameters()
+{
+    // The processor owns the parameters and outlives us
+    for (auto* parameter : getParameters())
+        parameter->removeListener(this);
+
+    stopTimer();
+    vt.removeListener(this);
+}
+
+int MeterParameters::getHoldDurationMs() const
+{
+    int index = holdTime->getIndex();
+
+    if (index == holdOffIndex || index == holdInfIndex)
+        return 0;
+
+    return holdDurations[static_cast<size_t>(index - 1)];
+}
+
+void MeterParameters::valueTreePropertyChanged(juce::ValueTree& _vt, const juce::Identifier& _ID)
+{
+    // Our own write-back, the parameters already hold these values
+    if (isWritingTree || SettingsBatch::isApplying())
+        return;
+
+    if (_ID == IDs::thresholdValue  || _ID == IDs::decayRate   || _ID == IDs::peakHoldEnabled ||
+        _ID == IDs::peakHoldInf     || _ID == IDs::peakHoldDuration || _ID == IDs::goniometerScale ||
+        _ID == IDs::renderReports   || _ID == IDs::settingsChanged)
+    {
+        jassert(_vt == vt);
+        
+        // settingsChanged is a restore, not something the user did
+        pushTreeToParameters(_ID != IDs::settingsChanged);
+    }
+}
+
+void MeterParameters::parameterValueChanged(int, float)
+{
+    // Any thread, often the audio thread, so only the flag. Our own pushes
+    // come through here too, the pull then finds the tree already matches.
+    parametersChanged = true;
+}
+
+void MeterParameters::parameterGestureChanged(int, bool)
+{
+}
+
+void MeterParameters::timerCallback()
+{
+    if (parametersChanged.exchange(false))
+        pullParametersIntoTree();
+}
+
+void MeterParameters::pushTreeToParameters(bool isUserEdit)
+{
+    setIfDifferent(*threshold,       vt.getProperty(IDs::thresholdValue), isUserEdit);
+    setIfDifferent(*decayRate,       static_cast<float>(decayRateToIndex(vt.getProperty(IDs::decayRate))), isUserEdit);
+    setIfDifferent(*holdTime,        static_cast<float>(holdTimeToIndex(vt)), isUserEdit);
+    setIfDifferent(*goniometerScale, vt.getProperty(IDs::goniometerScale), isUserEdit);
+
+    renderReports = static_cast<bool>(vt.getProperty(IDs::renderReports));
+}
+
+void MeterParameters::pullParametersIntoTree()
+{
+    const juce::ScopedValueSetter<bool> writing(isWritingTree, true);
+
+    float thresholdDb = threshold->get();
+    if (std::abs(static_cast<float>(vt.getProperty(IDs::thresholdValue)) - thresholdDb) > 0.001f)
+        vt.setProperty(IDs::thresholdValue, thresholdDb, nullptr);
+
+    if (decayRateToIndex(vt.getProperty(IDs::decayRate)) != decayRate->getIndex())
+        vt.setProperty(IDs::decayRate, getDecayRateDbPerSec(), nullptr);
+
+    if (holdTimeToIndex(vt) != holdTime->getIndex())
+    {
+        // Same mapping as the editor's Hold Time menu
+        vt.setProperty(IDs::peakHoldEnabled, isHoldEnabled(), nullptr);
+        vt.setProperty(IDs::peakHoldInf,     isHoldInf(),     nullptr);
+
+        if (getHoldDurationMs() > 0)
+            vt.setProperty(IDs::peakHoldDuration, getHoldDurationMs(), nullptr);
+    }
+
+    float scale = goniometerScale->get();
+    if (std::abs(static_cast<float>(vt.getProperty(IDs::goniometerScale)) - scale) > 0.001f)
+        vt.setProperty(IDs::goniometerScale, scale, nullptr);
+}
+
+int MeterParameters::decayRateToIndex(int dbPerSec)
+{
+    for (size_t i = 0; i < decayRates.size(); ++i)
+        if (decayRates[i] == dbPerSec)
+            return static_cast<int>(i);
+
+    return decayRateToIndex(DefaultPropertyValues::decayRate);
+}
+
+int MeterParameters::holdTimeToIndex(const juce::ValueTree& tree)
+{
+    if (! static_cast<bool>(tree.getProperty(IDs::peakHoldEnabled)))
+        return holdOffIndex;
+
+    if (static_cast<bool>(tree.getProperty(IDs::peakHoldInf)))
+        return holdInfIndex;
+
+    int duration = tree.getProperty(IDs::peakHoldDuration);
+
+    for (size_t i = 0; i < holdDurations.size(); ++i)
+        if (holdDurations[i] == duration)
+            return static_cast<int>(i) + 1;
+
+    return 1;
+}
+
+void MeterParameters::setIfDifferent(juce::RangedAudioParameter& parameter, float plainValue, bool isUserEdit)
+{
+    float normalised = parameter.convertTo0to1(plainValue);
+
+    if (std::abs(parameter.getValue() - normalised) <= 1.0e-6f)
+        return;
+
+    if (isUserEdit)
+        parameter.beginChangeGesture();
+
+    parameter.setValueNotifyingHost(normalised);
+
+    if (isUserEdit)
+        parameter.endChangeGesture();
+}
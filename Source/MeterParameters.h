@@ -0,0 +1,78 @@
+//
+//  MeterParameters.h
+//  PFM10
+//
+//  Host-automatable parameters for the meter settings, mirrored to and from
+//  the settings tree so the editor and the saved state keep using IDs::.
+//
+//  The tree stays the source of truth for the UI and for saved state.
+//  Tree changes are pushed to the parameters straight away. User edits go
+//  inside a change gesture so the host records each as one edit; a restored
+//  state doesn't, so hosts in touch or latch mode don't record the load.
+//  Parameter changes, which may arrive on the audio thread, only set a dirty
+//  flag there. A timer on the message thread picks it up and writes them
+//  back into the tree. The audio thread only ever reads the parameters and
+//  the flag, which are atomics, so it is wait-free.
+//
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include "Identifiers.h"
+#include "DefaultPropertyValues.h"
+
+class MeterParameters : private juce::ValueTree::Listener,
+                        private juce::AudioProcessorParameter::Listener,
+                        private juce::Timer
+{
+public:
+    static constexpr int syncRateHz = 30;
+    static constexpr std::array<int, 5> decayRates    { 3, 6, 12, 24, 36 };
+    static constexpr std::array<int, 4> holdDurations { 500, 2000, 4000, 6000 };
+
+    // Hold time choices: Off, then holdDurations, then Inf
+    static constexpr int holdOffIndex = 0;
+    static constexpr int holdInfIndex = static_cast<int>(holdDurations.size()) + 1;
+
+    // Adds the parameters to the processor, so call from its constructor
+    MeterParameters(juce::AudioProcessor& processor, juce::ValueTree _vt);
+    ~MeterParameters() override;
+
+    // Wait-free, safe on the audio thread
+    float getThresholdDb() const       { return threshold->get(); }
+    int   getDecayRateDbPerSec() const { return decayRates[static_cast<size_t>(decayRate->getIndex())]; }
+    bool  isHoldEnabled() const        { return holdTime->getIndex() != holdOffIndex; }
+    bool  isHoldInf() const            { return holdTime->getIndex() == holdInfIndex; }
+    int   getHoldDurationMs() const;
+    float getGoniometerScale() const   { return goniometerScale->get(); }
+
+    // Not a parameter, nothing to automate, but the audio thread reads it during offline renders
+    bool  areRenderReportsEnabled() const { return renderReports.load(); }
+
+private:
+    juce::ValueTree vt;
+
+    juce::AudioParameterFloat*  threshold;
+    juce::AudioParameterChoice* decayRate;
+    juce::AudioParameterChoice* holdTime;
+    juce::AudioParameterFloat*  goniometerScale;
+    std::atomic<bool> renderReports { DefaultPropertyValues::renderReports };
+
+    bool isWritingTree { false };
+    std::atomic<bool> parametersChanged { false };
+
+    void valueTreePropertyChanged(juce::ValueTree&, const juce::Identifier&) override;
+    void parameterValueChanged(int parameterIndex, float newValue) override;
+    void parameterGestureChanged(int parameterIndex, bool gestureIsStarting) override;
+    void timerCallback() override;
+
+    void pushTreeToParameters(bool isUserEdit);
+    void pullParametersIntoTree();
+
+    static int decayRateToIndex(int dbPerSec);
+    static int holdTimeToIndex(const juce::ValueTree& tree);
+    static void setIfDifferent(juce::RangedAudioParameter& parameter, float plainValue, bool isUserEdit);
+
+    std::array<juce::AudioProcessorParameter*, 4> getParameters() const { return { threshold, decayRate, holdTime, goniometerScale }; }
+};
@@ -0,0 +1,250 @@
+//
+//  MeterPublisher.cpp
+//  PFM10
+//
+
+#include "MeterPublisher.h"
+
+#if JUCE_MAC || JUCE_LINUX
+ #include <cerrno>
+ #include <fcntl.h>
+ #include <sys/mman.h>
+ #include <sys/socket.h>
+ #include <sys/un.h>
+ #include <unistd.h>
+#endif
+
+static_assert(sizeof(MeterLogFrame) == sizeof(MeterShmFrame), "MeterLogFrame and MeterShmFrame must match");
+
+bool MeterPublisher::isEnabledByEnvironment()
+{
+    return juce::SystemStats::getEnvironmentVariable("PFM10_PUBLISH_METERS", {}) == "1";
+}
+
+MeterPublisher::MeterPublisher()
+    : juce::Thread("PFM10 Meter Publisher")
+{
+}
+
+MeterPublisher::~MeterPublisher()
+{
+    stopThread(1000);
+    destroyRing();
+}
+
+void MeterPublisher::prepare(double sampleRate)
+{
+    if (header.load() == nullptr)
+    {
+        createRing();
+        startThread();
+    }
+
+    header.load()->sampleRate = sampleRate;
+}
+
+void MeterPublisher::setName(const juce::String& newName)
+{
+    name = newName;
+    writeName();
+}
+
+void MeterPublisher::writeName()
+{
+    auto* h = header.load();
+    if (h == nullptr)
+        return;
+
+    // Seqlock: readers retry while the sequence is odd or has moved on
+    h->nameSequence.fetch_add(1, std::memory_order_acq_rel);
+    std::memset(h->name, 0, sizeof(h->name));
+    name.copyToUTF8(h->name, sizeof(h->name));
+    h->nameSequence.fetch_add(1, std::memory_order_release);
+}
+
+void MeterPublisher::readName(char* dest, size_t destSize) const
+{
+    auto* h = header.load(std::memory_order_acquire);
+    char copied[sizeof(MeterShmHeader::name)];
+
+    // The other half of writeName()'s seqlock: setName() runs on the message thread
+    for (;;)
+    {
+        auto before = h->nameSequence.load(std::memory_order_acquire);
+        std::memcpy(copied, h->name, sizeof(copied));
+        std::atomic_thread_fence(std::memory_order_acquire);
+        auto after = h->nameSequence.load(std::memory_order_relaxed);
+
+        if (before == after && (before & 1) == 0)
+            break;
+
+        juce::Thread::yield();
+    }
+
+    copied[sizeof(copied) - 1] = 0;
+    std::strncpy(dest, copied, destSize - 1);
+    dest[destSize - 1] = 0;
+}
+
+bool MeterPublisher::push(const MeterLogFrame& frame)
+{
+    auto* h = header.load(std::memory_order_acquire);
+    if (h == nullptr)
+        return false;
+
+    // Single writer, so a plain load is enough to find the next slot
+    auto count = h->writeCount.load(std::memory_order_relaxed);
+    std::memcpy(&frames[count & (ringCapacity - 1)], &frame, sizeof(MeterShmFrame));
+    h->writeCount.store(count + 1, std::memory_order_release);
+
+    return true;
+}
+
+void MeterPublisher::createRing()
+{
+    size_t size = sizeof(MeterShmHeader) + ringCapacity * sizeof(MeterShmFrame);
+    void* memory = nullptr;
+
+#if JUCE_MAC || JUCE_LINUX
+    static std::atomic<int> numPublishers { 0 };
+    auto objectName = "/pfm10-" + juce::String(static_cast<int>(getpid())) + "-" + juce::String(++numPublishers);
+
+    int fd = shm_open(objectName.toRawUTF8(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd >= 0)
+    {
+        if (ftruncate(fd, static_cast<off_t>(size)) == 0)
+            memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+
+        if (memory == nullptr || memory == MAP_FAILED)
+        {
+            memory = nullptr;
+            close(fd);
+            shm_unlink(objectName.toRawUTF8());
+        }
+        else
+        {
+            shmFd = fd;
+            shmName = objectName;
+            mappedMemory = memory;
+            mappedSize = size;
+        }
+    }
+
+    socketFd = socket(AF_UNIX, SOCK_DGRAM, 0);
+#endif
+
+    // Without shared memory the ring still feeds the notification datagrams
+    if (memory == nullptr)
+    {
+        localMemory.calloc(size);
+        memory = localMemory.get();
+    }
+
+    auto* h = new (memory) MeterShmHeader();
+    std::memcpy(h->magic, "PFMS", 4);
+    h->version = MeterSharedMemory::currentVersion;
+    h->headerSize = sizeof(MeterShmHeader);
+    h->frameSize = sizeof(MeterShmFrame);
+    h->capacity = ringCapacity;
+    h->frameIntervalMs = frameIntervalMs;
+    h->pid = static_cast<int64_t>(juce::Process::getProcessID());
+    h->writeCount = 0;
+    h->nameSequence = 0;
+
+    frames = reinterpret_cast<MeterShmFrame*>(static_cast<char*>(memory) + sizeof(MeterShmHeader));
+    header.store(h, std::memory_order_release);
+
+    writeName();
+}
+
+void MeterPublisher::destroyRing()
+{
+    header = nullptr;
+    frames = nullptr;
+
+#if JUCE_MAC || JUCE_LINUX
+    if (mappedMemory != nullptr)
+    {
+        munmap(mappedMemory, mappedSize);
+        close(shmFd);
+        shm_unlink(shmName.toRawUTF8());
+        mappedMemory = nullptr;
+    }
+
+    if (socketFd >= 0)
+        close(socketFd);
+    socketFd = -1;
+#endif
+
+    localMemory.free();
+}
+
+void MeterPublisher::run()
+{
+    while (! threadShouldExit())
+    {
+        sendNotification();
+        wait(MeterSharedMemory::notifyIntervalMs);
+    }
+}
+
+void MeterPublisher::sendNotification()
+{
+#if JUCE_MAC || JUCE_LINUX
+    auto* h = header.load(std::memory_order_acquire);
+    if (h == nullptr || socketFd < 0)
+        return;
+
+    auto count = h->writeCount.load(std::memory_order_acquire);
+    if (count == lastNotifiedCount)
+        return;
+
+    lastNotifiedCount = count;
+
+    MeterShmNotification notification {};
+    std::memcpy(notification.magic, "PFMN", 4);
+    notification.version = MeterSharedMemory::currentVersion;
+    notification.writeCount = count;
+    shmName.copyToUTF8(notification.shmName, sizeof(notification.shmName));
+    std::memcpy(&notification.latest, &frames[(count - 1) & (ringCapacity - 1)], sizeof(MeterShmFrame));
+    readName(notification.name, sizeof(notification.name));
+
+    auto now = juce::Time::getMillisecondCounter();
+    if (lastReaderScanMs == 0 || now - lastReaderScanMs >= static_cast<juce::uint32>(MeterSharedMemory::readerScanIntervalMs))
+    {
+        scanReaderSockets();
+        lastReaderScanMs = now;
+    }
+
+    for (int i = readerSockets.size(); --i >= 0;)
+    {
+        sockaddr_un address {};
+        address.sun_family = AF_UNIX;
+        readerSockets[i].copyToUTF8(address.sun_path, sizeof(address.sun_path));
+
+        // A full reader queue just misses this one. A reader that has gone
+        // away is dropped until the next scan finds it again, if ever.
+        if (sendto(socketFd, &notification, sizeof(notification), MSG_DONTWAIT,
+                   reinterpret_cast<const sockaddr*>(&address), sizeof(address)) < 0
+            && (errno == ECONNREFUSED || errno == ENOENT))
+            readerSockets.remove(i);
+    }
+#endif
+}
+
+void MeterPublisher::scanReaderSockets()
+{
+#if JUCE_MAC || JUCE_LINUX
+    readerSockets.clearQuick();
+
+    // No directory means no readers, the normal case
+    for (const auto& entry : juce::RangedDirectoryIterator(juce::File(MeterSharedMemory::notificationSocketDirectory),
+                                                           false, "*.sock", juce::File::findFiles))
+    {
+        auto path = entry.getFile().getFullPathName();
+
+        if (path.getNumBytesAsUTF8() < sizeof(sockaddr_un::sun_path))
+            readerSockets.add(path);
+    }
+#endif
+}
@@ -0,0 +1,64 @@
+//
+//  MeterPublisher.h
+//  PFM10
+//
+//  Publishes an instance's meter frames to other processes, in the layout
+//  described in MeterSharedMemory.h. Off unless the PFM10_PUBLISH_METERS
+//  environment variable is set to 1 when the plugin is loaded.
+//
+//  The audio thread writes each frame straight into the shared-memory ring
+//  (plain stores and one atomic, no system calls). A background thread
+//  sends the notification datagrams to every reader socket it finds.
+//
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "MeterLog.h"
+#include "MeterSharedMemory.h"
+
+class MeterPublisher : public MeterFrameSink, private juce::Thread
+{
+public:
+    static constexpr int frameIntervalMs = 50;
+    static constexpr juce::uint32 ringCapacity = 1024;     // ~51 s of frames
+
+    static bool isEnabledByEnvironment();
+
+    MeterPublisher();
+    ~MeterPublisher() override;
+
+    // Message thread. Creates the ring on the first call, later calls only update the sample rate.
+    void prepare(double sampleRate);
+    void setName(const juce::String& newName);
+
+    // Audio thread, wait-free. Frames pushed before prepare() are dropped.
+    bool push(const MeterLogFrame& frame) override;
+
+    bool isSharedMemory() const { return shmName.isNotEmpty(); }
+private:
+    juce::String name;
+    juce::String shmName;
+    int shmFd { -1 };
+    size_t mappedSize { 0 };
+    void* mappedMemory { nullptr };
+    juce::HeapBlock<char> localMemory;      // used instead when shared memory isn't available
+
+    std::atomic<MeterShmHeader*> header { nullptr };
+    MeterShmFrame* frames { nullptr };
+
+    int socketFd { -1 };
+    juce::uint64 lastNotifiedCount { 0 };
+
+    // Publisher thread only
+    juce::StringArray readerSockets;
+    juce::uint32 lastReaderScanMs { 0 };
+
+    void writeName();
+    void readName(char* dest, size_t destSize) const;
+    void scanReaderSockets();
+    void createRing();
+    void destroyRing();
+    void run() override;
+    void sendNotification();
+};
@@ -0,0 +1,102 @@
+//
+//  MeterSharedMemory.h
+//  PFM10 - Shared Code
+//
+//  Fixed binary layout of the meter frames PFM10 publishes for other
+//  processes. Plain C++ with no JUCE types, so external readers can include
+//  it as-is. All values are native-endian; publisher and readers share a
+//  machine.
+//
+//  Shared memory
+//  -------------
+//  Each instance creates one POSIX shared-memory object named
+//  "/pfm10-<pid>-<n>", laid out as a MeterShmHeader followed by `capacity`
+//  MeterShmFrames. Frame number k (counting from 0 since the instance
+//  started publishing) lives at index k % capacity.
+//
+//  The publisher writes frame k, then stores writeCount = k + 1 with
+//  release ordering. To read without locking:
+//      1. n = writeCount (acquire)
+//      2. copy the frames wanted, from the range [n - capacity + 1, n)
+//      3. n2 = writeCount (acquire); keep a copied frame k only if k > n2 - capacity
+//  Nothing is ever locked, so any number of readers can map the object
+//  read-only without slowing the publisher or each other.
+//
+//  Notification sockets
+//  --------------------
+//  Each reader that wants to be told about instances binds its own
+//  Unix-domain datagram socket inside notificationSocketDirectory, named
+//  "<reader pid>.sock", and removes it when it exits. The directory is
+//  created by whichever reader comes first.
+//
+//  Every notifyIntervalMs, if new frames were written, each instance sends
+//  a MeterShmNotification datagram to every socket in that directory; the
+//  list is rescanned every readerScanIntervalMs. Readers use them to
+//  discover instances and to sleep until there is something new. The
+//  datagram carries the latest frame, so a reader that can't map the
+//  shared memory (or a publisher that couldn't create it: shmName is then
+//  empty) still gets the meters, just at the notification rate.
+//
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+namespace MeterSharedMemory
+{
+    constexpr uint32_t currentVersion = 1;
+    constexpr const char* notificationSocketDirectory = "/tmp/pfm10-meters";
+    constexpr int notifyIntervalMs = 50;
+    constexpr int readerScanIntervalMs = 1000;
+
+    enum FrameFlags : uint32_t
+    {
+        overLeft      = 1 << 0,     // a sample reached 0 dBFS or above
+        overRight     = 1 << 1,
+        hostPlaying   = 1 << 2,
+        overThreshold = 1 << 3      // either peak went above the meter threshold setting
+    };
+}
+
+// Identical to MeterLogFrame in a session log
+struct MeterShmFrame
+{
+    int64_t hostTimeInSamples;      // -1 when the host doesn't report a position
+    float peakDb[2];
+    float rmsDb[2];
+    float correlation;
+    uint32_t flags;                 // MeterSharedMemory::FrameFlags
+};
+
+struct MeterShmHeader
+{
+    char magic[4];                      // "PFMS"
+    uint32_t version;                   // MeterSharedMemory::currentVersion
+    uint32_t headerSize;                // sizeof(MeterShmHeader), frames start here
+    uint32_t frameSize;                 // sizeof(MeterShmFrame)
+    uint32_t capacity;                  // frames in the ring, a power of two
+    uint32_t frameIntervalMs;
+    double sampleRate;
+    int64_t pid;
+    std::atomic<uint64_t> writeCount;   // frames written so far
+    std::atomic<uint32_t> nameSequence; // odd while name is being rewritten
+    uint32_t reserved0;
+    char name[64];                      // host track name, null-terminated
+    char reserved1[8];
+};
+
+struct MeterShmNotification
+{
+    char magic[4];                      // "PFMN"
+    uint32_t version;
+    uint64_t writeCount;
+    char shmName[48];                   // empty when the instance has no shared memory
+    MeterShmFrame latest;               // valid if writeCount > 0
+    char name[32];                      // host track name, truncated
+};
+
+static_assert(sizeof(MeterShmFrame) == 32, "MeterShmFrame is part of the published layout");
+static_assert(sizeof(MeterShmHeader) == 128, "MeterShmHeader is part of the published layout");
+static_assert(sizeof(MeterShmNotification) == 128, "MeterShmNotification is part of the published layout");
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "writeCount must be lock-free to live in shared memory");
@@ -0,0 +1,116 @@
+//
+//  OfflineRender.cpp
+//  PFM10
+//
+
+#include "OfflineRender.h"
+
+OfflineRender::OfflineRender(const juce::File& _logFile, const juce::String& _trackName, double _sampleRate, int maxBlockSize)
+    : logFile(_logFile),
+      trackName(_trackName),
+      sampleRate(_sampleRate),
+      startTimeMs(juce::Time::currentTimeMillis())
+{
+    engine.prepare(sampleRate, frameRateHz);
+    truePeakDetector.prepare(maxBlockSize);
+    logAccumulator.prepare(sampleRate, logFrameIntervalMs);
+
+    if (logFile == juce::File())
+        return;
+
+    // The file was claimed for us, so it's ours to write from the start
+    logSink.stream = std::make_unique<juce::FileOutputStream>(logFile, MeterLogWriter::streamBufferSize);
+
+    if (logSink.stream->failedToOpen())
+    {
+        logSink.stream.reset();
+        return;
+    }
+
+    MeterLogHeader header;
+    header.sampleRate = sampleRate;
+    header.frameIntervalMs = logFrameIntervalMs;
+    header.frameSize = sizeof(MeterLogFrame);
+    header.startTimeMs = startTimeMs;
+    logSink.stream->write(&header, sizeof(header));
+}
+
+bool OfflineRender::LogFileSink::push(const MeterLogFrame& frame)
+{
+    return stream != nullptr && stream->write(&frame, sizeof(frame));
+}
+
+void OfflineRender::process(const juce::AudioBuffer<float>& buffer,
+                            juce::int64 hostTimeInSamples,
+                            bool hostIsPlaying,
+                            float thresholdDb)
+{
+    int numBlockSamples = buffer.getNumSamples();
+
+    engine.process(buffer, 0, numBlockSamples);
+    truePeakDetector.process(buffer, 0, numBlockSamples);
+    logAccumulator.process(buffer, hostTimeInSamples, hostIsPlaying, thresholdDb, logSink);
+
+    numSamples += numBlockSamples;
+}
+
+juce::File OfflineRender::finish()
+{
+    truePeakDetector.flush();
+    logAccumulator.flush(logSink);
+    renderTimeMs = juce::Time::currentTimeMillis() - startTimeMs;
+
+    if (logSink.stream != nullptr)
+    {
+        logSink.stream->flush();
+        logSink.stream.reset();
+    }
+
+    if (logFile == juce::File())
+        return {};
+
+    // The log's name is unique among logs; a report left behind by an older one mustn't be overwritten
+    auto reportFile = logFile.withFileExtension(".json");
+    if (reportFile.existsAsFile())
+        reportFile = reportFile.getNonexistentSibling(false);
+
+    reportFile.replaceWithText(juce::JSON::toString(getReport()));
+
+    return reportFile;
+}
+
+juce::var OfflineRender::getReport() const
+{
+    const auto& statistics = engine.getStatistics();
+
+    auto perChannel = [](auto getter)
+    {
+        juce::Array<juce::var> values;
+        for (int channel = 0; channel < MeterStatistics::numChannels; ++channel)
+            values.add(getter(channel));
+        return juce::var(values);
+    };
+
+    juce::DynamicObject::Ptr report = new juce::DynamicObject();
+
+    report->setProperty("track", trackName);
+    report->setProperty("sampleRate", sampleRate);
+    report->setProperty("lengthInSamples", numSamples);
+    report->setProperty("lengthSeconds", static_cast<double>(numSamples) / sampleRate);
+    report->setProperty("renderTimeSeconds", renderTimeMs / 1000.0);
+    report->setProperty("log", logFile.getFullPathName());
+
+    report->setProperty("samplePeakDb", perChannel([&](int ch) { return statistics.getPeakDb(ch); }));
+    report->setProperty("truePeakDb",   perChannel([&](int ch) { return truePeakDetector.getTruePeakDb(ch); }));
+    report->setProperty("truePeakOvers", perChannel([&](int ch) { return truePeakDetector.getNumOvers(ch); }));
+    report->setProperty("rmsDb",        perChannel([&](int ch) { return statistics.getRmsDb(ch); }));
+    report->setProperty("integratedLufs", statistics.loudness.getIntegratedLufs());
+
+    juce::DynamicObject::Ptr correlation = new juce::DynamicObject();
+    correlation->setProperty("mean", statistics.getCorrelationMean());
+    correlation->setProperty("min", statistics.correlationMin);
+    correlation->setProperty("max", statistics.correlationMax);
+    report->setProperty("correlation", juce::var(correlation.get()));
+
+    return juce::var(report.get());
+}
@@ -0,0 +1,65 @@
+//
+//  OfflineRender.h
+//  PFM10
+//
+//  Exhaustive analysis for when the host bounces offline (isNonRealtime()).
+//  The audio thread isn't racing the clock then, so instead of the editor's
+//  sampled view every sample goes through:
+//
+//      - MeterAnalysisEngine: sample peak, RMS, correlation and integrated
+//        loudness with exact sliding windows
+//      - TruePeakDetector: 8x oversampled true peak and overs
+//      - a 1 ms meter log, the finest interval the log format holds. Frames
+//        alternate in length where 1 ms isn't a whole number of samples,
+//        and the last one holds whatever is left at the end.
+//
+//  Only runs with the render report setting on. When the render ends, a
+//  JSON report is written next to the log.
+//  Everything here runs on the audio thread, and blocks on file writes.
+//  That's fine offline and never happens in real time.
+//
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "MeterAnalysis.h"
+#include "MeterLog.h"
+
+class OfflineRender
+{
+public:
+    static constexpr int frameRateHz = 60;              // same frames as the editor, for the level distribution
+    static constexpr int logFrameIntervalMs = 1;
+
+    // logFile must be a new, empty file claimed for this render, or File() for no log and no report
+    OfflineRender(const juce::File& logFile, const juce::String& trackName, double sampleRate, int maxBlockSize);
+
+    void process(const juce::AudioBuffer<float>& buffer,
+                 juce::int64 hostTimeInSamples,
+                 bool hostIsPlaying,
+                 float thresholdDb);
+
+    // Writes the report and closes the log. Returns the report file, File() without a log.
+    juce::File finish();
+
+    juce::var getReport() const;
+private:
+    // Offline nothing is waiting on the audio thread, so frames go straight to the file
+    struct LogFileSink : MeterFrameSink
+    {
+        std::unique_ptr<juce::FileOutputStream> stream;
+        bool push(const MeterLogFrame& frame) override;
+    };
+
+    juce::File logFile;
+    juce::String trackName;
+    double sampleRate;
+    juce::int64 numSamples { 0 };
+    juce::int64 startTimeMs;
+    juce::int64 renderTimeMs { 0 };
+
+    MeterAnalysisEngine engine;
+    TruePeakDetector truePeakDetector;
+    MeterLogAccumulator logAccumulator;
+    LogFileSink logSink;
+};
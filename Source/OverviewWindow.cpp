@@ -0,0 +1,187 @@
+//
+//  OverviewWindow.cpp
+//  PFM10
+//
+
+#include "OverviewWindow.h"
+
+//==============================================================================
+//MARK: - OverviewComponent
+
+OverviewComponent::OverviewComponent(InstanceRegistry& _registry)
+    : registry(_registry),
+      strips(static_cast<size_t>(_registry.getNumSlots()))
+{
+    setOpaque(true);
+}
+
+OverviewComponent::~OverviewComponent()
+{
+    stopTimer();
+}
+
+void OverviewComponent::setActive(bool shouldBeActive)
+{
+    if (shouldBeActive)
+        startTimerHz(refreshRateHz);
+    else
+        stopTimer();
+}
+
+void OverviewComponent::timerCallback()
+{
+    TRACE_COMPONENT();
+
+    const float decayPerFrame = decayDbPerSec / refreshRateHz;
+    bool refreshNames = (--framesUntilNameRefresh <= 0);
+    if (refreshNames)
+        framesUntilNameRefresh = nameRefreshFrames;
+
+    for (int i = 0; i < registry.getNumSlots(); ++i)
+    {
+        auto* slot = registry.getSlot(i);
+        auto& strip = strips[static_cast<size_t>(i)];
+
+        strip.visible = slot->inUse.load();
+        if (! strip.visible)
+            continue;
+
+        // A different instance took over the slot
+        juce::uint32 generation = slot->generation.load();
+        if (generation != strip.generation)
+        {
+            strip = Strip();
+            strip.visible = true;
+            strip.generation = generation;
+            strip.name = slot->getName();
+        }
+        else if (refreshNames)
+        {
+            strip.name = slot->getName();
+        }
+
+        for (int ch = 0; ch < InstanceSlot::numChannels; ++ch)
+        {
+            auto index = static_cast<size_t>(ch);
+            float newPeakDb = juce::Decibels::gainToDecibels(slot->takePeak(ch), NEGATIVE_INFINITY);
+
+            strip.peakDb[index] = juce::jmax(newPeakDb, strip.peakDb[index] - decayPerFrame);
+            strip.rmsDb[index]  = juce::Decibels::gainToDecibels(slot->rms[index].load(), NEGATIVE_INFINITY);
+        }
+    }
+
+    repaint();
+}
+
+void OverviewComponent::paint(juce::Graphics& g)
+{
+    TRACE_COMPONENT();
+
+    g.fillAll(juce::Colours::darkgrey.darker());
+
+    auto bounds = getLocalBounds().reduced(stripGap);
+    int stripsPerRow = juce::jmax(1, (bounds.getWidth() + stripGap) / (stripWidth + stripGap));
+    int position = 0;
+
+    g.setFont(10.0f);
+
+    for (auto& strip : strips)
+    {
+        if (! strip.visible)
+            continue;
+
+        int column = position % stripsPerRow;
+        int row = position / stripsPerRow;
+        ++position;
+
+        juce::Rectangle<int> area(bounds.getX() + column * (stripWidth + stripGap),
+                                  bounds.getY() + row * (rowHeight + stripGap),
+                                  stripWidth,
+                                  rowHeight);
+
+        if (area.getY() > getHeight())
+            break;
+
+        paintStrip(g, strip, area);
+    }
+
+    if (position == 0)
+    {
+        g.setColour(juce::Colours::white);
+        g.drawText("No PFM10 instances", getLocalBounds(), juce::Justification::centred);
+    }
+}
+
+void OverviewComponent::paintStrip(juce::Graphics& g, const Strip& strip, juce::Rectangle<int> area)
+{
+    auto nameArea = area.removeFromBottom(nameHeight);
+    g.setColour(juce::Colours::white);
+    g.drawFittedText(strip.name, nameArea, juce::Justification::centred, 1, 0.7f);
+
+    g.setColour(juce::Colours::black);
+    g.fillRect(area);
+
+    auto meterArea = area.reduced(2).toFloat();
+    float barWidth = (meterArea.getWidth() - 2) / InstanceSlot::numChannels;
+
+    auto map = [=](float db)
+    {
+        return juce::jmap(juce::jlimit(NEGATIVE_INFINITY, MAX_DECIBELS, db),
+                          NEGATIVE_INFINITY, MAX_DECIBELS,
+                          meterArea.getBottom(), meterArea.getY());
+    };
+
+    for (int ch = 0; ch < InstanceSlot::numChannels; ++ch)
+    {
+        auto index = static_cast<size_t>(ch);
+        float x = meterArea.getX() + ch * (barWidth + 2);
+
+        float peakY = map(strip.peakDb[index]);
+        g.setColour(strip.peakDb[index] > 0.f ? juce::Colours::red.withAlpha(0.9f) : juce::Colours::green.withAlpha(0.5f));
+        g.fillRect(x, peakY, barWidth, meterArea.getBottom() - peakY);
+
+        float rmsY = map(strip.rmsDb[index]);
+        g.setColour(juce::Colours::green.withAlpha(0.9f));
+        g.fillRect(x, rmsY, barWidth, meterArea.getBottom() - rmsY);
+    }
+
+    // 0 dBFS line
+    g.setColour(juce::Colours::grey);
+    g.fillRect(meterArea.getX(), map(0.f), meterArea.getWidth(), 1.f);
+}
+
+//==============================================================================
+//MARK: - OverviewWindow
+
+OverviewWindow::OverviewWindow(InstanceRegistry& registry)
+    : juce::DocumentWindow("PFM10 Overview", juce::Colours::darkgrey.darker(), juce::DocumentWindow::closeButton)
+{
+    setUsingNativeTitleBar(true);
+    setContentOwned(new OverviewComponent(registry), false);
+    setResizable(true, false);
+    setResizeLimits(200, 160, 4000, 3000);
+    centreWithSize(760, 320);
+}
+
+void OverviewWindow::closeButtonPressed()
+{
+    // Kept around hidden, reopening is instant and keeps the window position
+    setVisible(false);
+}
+
+void OverviewWindow::visibilityChanged()
+{
+    juce::DocumentWindow::visibilityChanged();
+
+    if (auto* overview = dynamic_cast<OverviewComponent*>(getContentComponent()))
+        overview->setActive(isVisible());
+}
+
+void OverviewWindow::show(InstanceRegistry& registry)
+{
+    if (registry.overviewWindow == nullptr)
+        registry.overviewWindow = std::make_unique<OverviewWindow>(registry);
+
+    registry.overviewWindow->setVisible(true);
+    registry.overviewWindow->toFront(true);
+}
@@ -0,0 +1,68 @@
+//
+//  OverviewWindow.h
+//  PFM10
+//
+//  Meter bridge of every PFM10 instance in the process. One timer reads all
+//  of the InstanceRegistry slots and one paint() draws all the strips, so
+//  100 instances cost the same number of timers and repaints as one.
+//
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "InstanceRegistry.h"
+#include "MeterAnalysis.h"
+
+//==============================================================================
+//MARK: - OverviewComponent
+
+class OverviewComponent : public juce::Component, private juce::Timer
+{
+public:
+    static constexpr int refreshRateHz = 30;
+    static constexpr int nameRefreshFrames = refreshRateHz;     // names change rarely
+    static constexpr float decayDbPerSec = 24.f;
+
+    explicit OverviewComponent(InstanceRegistry& _registry);
+    ~OverviewComponent() override;
+
+    void paint(juce::Graphics& g) override;
+
+    // Only reads the slots while the window is on screen
+    void setActive(bool shouldBeActive);
+private:
+    InstanceRegistry& registry;
+
+    struct Strip
+    {
+        bool visible { false };
+        juce::uint32 generation { 0 };
+        std::array<float, InstanceSlot::numChannels> peakDb { NEGATIVE_INFINITY, NEGATIVE_INFINITY };
+        std::array<float, InstanceSlot::numChannels> rmsDb  { NEGATIVE_INFINITY, NEGATIVE_INFINITY };
+        juce::String name;
+    };
+    std::vector<Strip> strips;
+    int framesUntilNameRefresh { 0 };
+
+    int stripWidth { 34 };
+    int stripGap { 4 };
+    int nameHeight { 14 };
+    int rowHeight { 140 };
+
+    void timerCallback() override;
+    void paintStrip(juce::Graphics& g, const Strip& strip, juce::Rectangle<int> area);
+};
+
+//==============================================================================
+//MARK: - OverviewWindow
+
+class OverviewWindow : public juce::DocumentWindow
+{
+public:
+    explicit OverviewWindow(InstanceRegistry& registry);
+    void closeButtonPressed() override;
+    void visibilityChanged() override;
+
+    // Creates the window the first time, then just brings it to the front
+    static void show(InstanceRegistry& registry);
+};
@@ -44,71 +44,31 @@ void LAF_ThresholdSlider::drawLinearSlider(juce::Graphics& g, int x, int y, int
 //==============================================================================
 // JUCE Components and custom classes
 //==============================================================================
+//MARK: - MeterClock
 
-//MARK: - Averager
-template<typename T>
-Averager<T>::Averager(size_t _numElements, T _initialValue)
-{
-    resize(_numElements, _initialValue);
-}
-
-template<typename T>
-void Averager<T>::resize(size_t numElements, T initialValue)
-{
-    elements.resize(numElements);
-    clear(initialValue);
-}
-
-template<typename T>
-void Averager<T>::clear(T initialValue)
+juce::int64 MeterClock::now() const
 {
-    size_t numElements = elements.size();
-    for (size_t i = 0; i < numElements; i++)
-    {
-        elements[i] = initialValue;
-    }
-    
-    writeIndex = 0;
-    avg = initialValue;
-    sum = static_cast<T>(initialValue * numElements);
+    return replaying ? replayTimeMs.load() : juce::Time::currentTimeMillis();
 }
 
-template<typename T>
-void Averager<T>::add(T t)
+void MeterClock::setReplayTime(juce::int64 ms)
 {
-    // First, cache the atomics as local variables to work with
-    auto writeIndexTemp = writeIndex.load();
-    auto sumTemp = sum.load();
-    
-    sumTemp -= elements[writeIndexTemp];
-    sumTemp += t;
-    
-    elements[writeIndexTemp] = t;
-    
-    ++writeIndexTemp;
-    if (writeIndexTemp > (elements.size() - 1))
-    {
-        writeIndexTemp = 0;
-    }
-    
-    writeIndex = writeIndexTemp;
-    sum = sumTemp;
-    avg = sumTemp / elements.size();
+    replayTimeMs = ms;
+    replaying = true;
 }
 
 //==============================================================================
 //MARK: - DecayingValueHolder
 
-DecayingValueHolder::DecayingValueHolder(juce::ValueTree _vt)
-: vt(_vt)
+DecayingValueHolder::DecayingValueHolder(juce::ValueTree _vt, const MeterClock& _clock)
+: vt(_vt),
+  clock(_clock)
 {
     vt.addListener(this);
     
     startTimerHz(60);
     
-    setHoldForInf( vt.getProperty(IDs::peakHoldInf) );
-    setHoldTime( vt.getProperty(IDs::peakHoldDuration) );
-    setDecayRate( vt.getProperty(IDs::decayRate) );
+    loadSettings(vt);
 }
 
 DecayingValueHolder::~DecayingValueHolder()
@@ -116,9 +76,26 @@ DecayingValueHolder::~DecayingValueHolder()
     stopTimer();
 }
 
+void DecayingValueHolder::loadSettings(juce::ValueTree& tree)
+{
+    setHoldForInf( tree.getProperty(IDs::peakHoldInf) );
+    setHoldTime( tree.getProperty(IDs::peakHoldDuration) );
+    setDecayRate( tree.getProperty(IDs::decayRate) );
+}
+
 void DecayingValueHolder::valueTreePropertyChanged(juce::ValueTree& _vt, const juce::Identifier& _ID)
 {
-    if (_ID == IDs::decayRate)
+    if (SettingsBatch::isApplying())
+    {
+        return;
+    }
+    else if (_ID == IDs::settingsChanged)
+    {
+        loadSettings(_vt);
+        
+        return;
+    }
+    else if (_ID == IDs::decayRate)
     {
         int decayRate = _vt.getProperty(IDs::decayRate);
         
@@ -148,87 +125,79 @@ void DecayingValueHolder::updateHeldValue(float input)
 {
     std::lock_guard<std::mutex> lock(heldValueMutex);
     
-    if (input > heldValue)
-    {
-        peakTimeMutex.lock();
-        peakTime = getNow();
-        peakTimeMutex.unlock();
-        
-        heldValue = input;
-    }
+    decayingValue.update(input, getNow());
 }
 
 void DecayingValueHolder::resetHeldValue()
 {
     std::lock_guard<std::mutex> lock(heldValueMutex);
-    heldValue = NEGATIVE_INFINITY;
+    decayingValue.reset();
 }
 
 bool DecayingValueHolder::isOverThreshold() const
 {
-    return (heldValue > threshold);
+    return (decayingValue.getHeldValue() > threshold);
 }
 
 void DecayingValueHolder::setHoldTime(int ms)
 {
-    holdTimeMs = ms;
+    decayingValue.setHoldTime(ms);
 }
 
 void DecayingValueHolder::setDecayRate(int dbPerSec)
 {
-    // note: getTimerInterval() returns milliseconds
-    decayRatePerFrame = static_cast<float>(dbPerSec) * getTimerInterval() / 1000;
+    decayingValue.setDecayRate(static_cast<float>(dbPerSec));
 }
 
 void DecayingValueHolder::setHoldForInf(bool b)
 {
-    holdForInf = b;
+    decayingValue.setHoldForInf(b);
     
     if (! b) resetHeldValue();
 }
 
 void DecayingValueHolder::timerCallback()
 {
-    juce::int64 now = getNow();
+    if (clock.isReplaying())
+        return;
     
-    peakTimeMutex.lock();
-    juce::int64 peakTimeCached = peakTime;
-    peakTimeMutex.unlock();
+    tick();
+}
+
+void DecayingValueHolder::tick()
+{
+    std::lock_guard<std::mutex> lock(heldValueMutex);
     
-    if (! holdForInf)
-    {
-        if ((now - peakTimeCached) > holdTimeMs)
-        {
-            std::lock_guard<std::mutex> lock(heldValueMutex);
-            
-            heldValue -= decayRatePerFrame;
-            
-            heldValue = juce::jlimit(NEGATIVE_INFINITY,
-                                     MAX_DECIBELS,
-                                     heldValue);
-        }
-    }
+    // note: getTimerInterval() returns milliseconds
+    decayingValue.decay(getNow(), static_cast<float>(getTimerInterval()));
+}
+
+void DecayingValueHolder::setTicking(bool shouldTick)
+{
+    if (shouldTick)
+        startTimerHz(60);
+    else
+        stopTimer();
 }
 
-juce::int64 DecayingValueHolder::getNow()
+bool DecayingValueHolder::isSettled() const
 {
-    return juce::Time::currentTimeMillis();
+    return decayingValue.isHoldingForInf() || decayingValue.getHeldValue() <= NEGATIVE_INFINITY;
 }
 
 //==============================================================================
 //MARK: - ValueHolder
 
-ValueHolder::ValueHolder(juce::ValueTree _vt)
-: vt(_vt)
+ValueHolder::ValueHolder(juce::ValueTree _vt, const MeterClock& _clock)
+: vt(_vt),
+  clock(_clock)
 {
     vt.addListener(this);
     
-    timeOfPeak = juce::Time::currentTimeMillis();
+    timeOfPeak = clock.now();
     startTimerHz(60);
     
-    setHoldForInf( vt.getProperty(IDs::peakHoldInf) );
-    setHoldDuration( vt.getProperty(IDs::peakHoldDuration) );
-    setHoldEnabled( vt.getProperty(IDs::peakHoldEnabled) );
+    loadSettings(vt);
 }
 
 ValueHolder::~ValueHolder()
@@ -236,9 +205,26 @@ ValueHolder::~ValueHolder()
     stopTimer();
 }
 
+void ValueHolder::loadSettings(juce::ValueTree& tree)
+{
+    setHoldForInf( tree.getProperty(IDs::peakHoldInf) );
+    setHoldDuration( tree.getProperty(IDs::peakHoldDuration) );
+    setHoldEnabled( tree.getProperty(IDs::peakHoldEnabled) );
+}
+
 void ValueHolder::valueTreePropertyChanged(juce::ValueTree& _vt, const juce::Identifier& _ID)
 {
-    if (_ID == IDs::peakHoldDuration)
+    if (SettingsBatch::isApplying())
+    {
+        return;
+    }
+    else if (_ID == IDs::settingsChanged)
+    {
+        loadSettings(_vt);
+        
+        return;
+    }
+    else if (_ID == IDs::peakHoldDuration)
     {
         int newHoldDurationMs = _vt.getProperty(IDs::peakHoldDuration);
         
@@ -266,7 +252,15 @@ void ValueHolder::valueTreePropertyChanged(juce::ValueTree& _vt, const juce::Ide
 
 void ValueHolder::timerCallback()
 {
-    juce::int64 now = juce::Time::currentTimeMillis();
+    if (clock.isReplaying())
+        return;
+    
+    tick();
+}
+
+void ValueHolder::tick()
+{
+    juce::int64 now = clock.now();
     timeOfPeakMutex.lock();
     juce::int64 elapsed = now - timeOfPeak;
     timeOfPeakMutex.unlock();
@@ -278,6 +272,19 @@ void ValueHolder::timerCallback()
     }
 }
 
+void ValueHolder::setTicking(bool shouldTick)
+{
+    if (shouldTick)
+        startTimerHz(60);
+    else
+        stopTimer();
+}
+
+bool ValueHolder::isSettled() const
+{
+    return holdForInf || heldValue.load() <= currentValue.load();
+}
+
 void ValueHolder::setThreshold(float th)
 {
     threshold = th;
@@ -301,7 +308,7 @@ bool ValueHolder::updateHeldValue(float v)
     if (v >= heldValue.load())
     {
         timeOfPeakMutex.lock();
-        timeOfPeak = juce::Time::currentTimeMillis();
+        timeOfPeak = clock.now();
         timeOfPeakMutex.unlock();
         
         heldValue = v;
@@ -321,8 +328,8 @@ void ValueHolder::resetHeldValue()
 //==============================================================================
 //MARK: - TextMeter
 
-TextMeter::TextMeter(juce::ValueTree _vt)
-: valueHolder(_vt)
+TextMeter::TextMeter(juce::ValueTree _vt, const MeterClock& clock)
+: valueHolder(_vt, clock)
 {
     valueHolder.setThreshold(0.f);
     valueHolder.updateHeldValue(NEGATIVE_INFINITY);
@@ -398,8 +405,8 @@ void TextMeter::resetHold()
 //==============================================================================
 //MARK: - Meter
 
-Meter::Meter(juce::ValueTree _vt)
-: decayingValueHolder(_vt)
+Meter::Meter(juce::ValueTree _vt, const MeterClock& clock)
+: decayingValueHolder(_vt, clock)
 {
     setPeakHoldEnabled(_vt.getProperty(IDs::peakHoldEnabled));
     
@@ -422,11 +429,11 @@ void Meter::paint(juce::Graphics& g)
     float yMax = meterBounds.getY();
     
     auto dbThresholdCached = dbThreshold;
-    auto yThreshold = juce::jmap(dbThresholdCached, NEGATIVE_INFINITY, MAX_DECIBELS, yMin, yMax);
+    auto yThreshold = juce::jmap(dbThresholdCached, minDb, maxDb, yMin, yMax);
             
     std::lock_guard<std::mutex> lock(dbPeakMutex);
 
-    auto dbPeakMapped = juce::jmap(dbPeak, NEGATIVE_INFINITY, MAX_DECIBELS, yMin, yMax);
+    auto dbPeakMapped = juce::jmap(juce::jmax(dbPeak, minDb), minDb, maxDb, yMin, yMax);
     dbPeakMapped = juce::jmax(dbPeakMapped, yMax);
     
     juce::Rectangle<float> meterFillRect = meterBounds.withY(dbPeakMapped);
@@ -447,9 +454,9 @@ void Meter::paint(juce::Graphics& g)
     // Decaying Peak Level Tick Mark
     juce::Rectangle<float> peakLevelTickMark(meterFillRect);
     
-    auto peakLevelTickYMapped = juce::jmap(peakHoldEnabled ? decayingValueHolder.getHeldValue() : dbPeak,
-                                           NEGATIVE_INFINITY,
-                                           MAX_DECIBELS,
+    auto peakLevelTickYMapped = juce::jmap(juce::jmax(peakHoldEnabled ? decayingValueHolder.getHeldValue() : dbPeak, minDb),
+                                           minDb,
+                                           maxDb,
                                            yMin,
                                            yMax);
     peakLevelTickYMapped = juce::jlimit(yMax, meterFillRect.getY(), peakLevelTickYMapped);
@@ -484,13 +491,21 @@ void Meter::resetHold()
     decayingValueHolder.resetHeldValue();
 }
 
+bool Meter::isSettled()
+{
+    std::lock_guard<std::mutex> lock(dbPeakMutex);
+    
+    // The averaged level can sit a rounding error above the floor
+    return dbPeak < NEGATIVE_INFINITY + 0.1f && decayingValueHolder.isSettled();
+}
+
 //==============================================================================
 //MARK: - MacroMeter
 
-MacroMeter::MacroMeter(juce::ValueTree _vt)
-: peakTextMeter(_vt),
-  peakMeter(_vt),
-  averageMeter(_vt),
+MacroMeter::MacroMeter(juce::ValueTree _vt, const MeterClock& clock)
+: peakTextMeter(_vt, clock),
+  peakMeter(_vt, clock),
+  averageMeter(_vt, clock),
   averager(30, NEGATIVE_INFINITY)
 {
     addAndMakeVisible(peakTextMeter);
@@ -529,6 +544,7 @@ void MacroMeter::updateLevel(float level)
     
     peakTextMeter.update(level);
     peakMeter.update(level);
+    lastLevel = level;
     
     averager.add(level);
     averageMeter.update(averager.getAvg());
@@ -543,6 +559,10 @@ void MacroMeter::updateThreshold(float dbLevel)
 
 void MacroMeter::setAveragerIntervals(int numElements)
 {
+    // Resizing clears the averager, don't do it for nothing
+    if (averager.getSize() == size_t(numElements))
+        return;
+    
     averager.resize(size_t(numElements), averager.getAvg());
 }
 
@@ -552,6 +572,12 @@ void MacroMeter::setPeakHoldEnabled(bool isEnabled)
     averageMeter.setPeakHoldEnabled(isEnabled);
 }
 
+void MacroMeter::setRange(float minDb, float maxDb)
+{
+    peakMeter.setRange(minDb, maxDb);
+    averageMeter.setRange(minDb, maxDb);
+}
+
 void MacroMeter::resetHold()
 {
     peakTextMeter.resetHold();
@@ -559,6 +585,33 @@ void MacroMeter::resetHold()
     averageMeter.resetHold();
 }
 
+void MacroMeter::tickBallistics()
+{
+    peakTextMeter.tickBallistics();
+    peakMeter.tickBallistics();
+    averageMeter.tickBallistics();
+}
+
+void MacroMeter::setBallisticsRunning(bool shouldRun)
+{
+    peakTextMeter.setBallisticsRunning(shouldRun);
+    peakMeter.setBallisticsRunning(shouldRun);
+    averageMeter.setBallisticsRunning(shouldRun);
+}
+
+bool MacroMeter::isSettled()
+{
+    return peakTextMeter.isSettled() && peakMeter.isSettled() && averageMeter.isSettled();
+}
+
+bool MacroMeter::isSettledOnLevel()
+{
+    return peakTextMeter.isSettled()
+        && peakMeter.isHoldSettled()
+        && averageMeter.isHoldSettled()
+        && std::abs(averager.getAvg() - lastLevel.load()) < 0.1f;
+}
+
 //==============================================================================
 //MARK: - DbScale
 
@@ -660,10 +713,10 @@ void DbScale::buildBackgroundImage(int dbDivision,
 //==============================================================================
 //MARK: - StereoMeter
 
-StereoMeter::StereoMeter(juce::ValueTree _vt, juce::String _meterName)
+StereoMeter::StereoMeter(juce::ValueTree _vt, juce::String _meterName, const MeterClock& clock)
     : vt(_vt),
-      leftMacroMeter(_vt),
-      rightMacroMeter(_vt)
+      leftMacroMeter(_vt, clock),
+      rightMacroMeter(_vt, clock)
 {
     vt.addListener(this);
     
@@ -684,9 +737,7 @@ StereoMeter::StereoMeter(juce::ValueTree _vt, juce::String _meterName)
     thresholdSlider.setLookAndFeel(&thresholdSliderLAF);
     addAndMakeVisible(thresholdSlider);
     
-    float initialThresholdValue = vt.getProperty(IDs::thresholdValue);
-    leftMacroMeter.updateThreshold(initialThresholdValue);
-    rightMacroMeter.updateThreshold(initialThresholdValue);
+    loadSettings(vt);
 }
 
 StereoMeter::~StereoMeter()
@@ -694,9 +745,34 @@ StereoMeter::~StereoMeter()
     thresholdSlider.setLookAndFeel(nullptr);
 }
 
+void StereoMeter::loadSettings(juce::ValueTree& tree)
+{
+    float dbLevel = tree.getProperty(IDs::thresholdValue);
+    leftMacroMeter.updateThreshold(dbLevel);
+    rightMacroMeter.updateThreshold(dbLevel);
+    
+    int numAveragerIntervals = tree.getProperty(IDs::averagerIntervals);
+    leftMacroMeter.setAveragerIntervals(numAveragerIntervals);
+    rightMacroMeter.setAveragerIntervals(numAveragerIntervals);
+    
+    bool peakHoldEnabled = tree.getProperty(IDs::peakHoldEnabled);
+    leftMacroMeter.setPeakHoldEnabled(peakHoldEnabled);
+    rightMacroMeter.setPeakHoldEnabled(peakHoldEnabled);
+}
+
 void StereoMeter::valueTreePropertyChanged(juce::ValueTree& _vt, const juce::Identifier& _ID)
 {
-    if (_ID == IDs::thresholdValue)
+    if (SettingsBatch::isApplying())
+    {
+        return;
+    }
+    else if (_ID == IDs::settingsChanged)
+    {
+        loadSettings(_vt);
+        
+        return;
+    }
+    else if (_ID == IDs::thresholdValue)
     {
         float dbLevel = _vt.getProperty(IDs::thresholdValue);
         
@@ -731,6 +807,23 @@ void StereoMeter::resetHold()
     rightMacroMeter.resetHold();
 }
 
+void StereoMeter::tickBallistics()
+{
+    leftMacroMeter.tickBallistics();
+    rightMacroMeter.tickBallistics();
+}
+
+void StereoMeter::setBallisticsRunning(bool shouldRun)
+{
+    leftMacroMeter.setBallisticsRunning(shouldRun);
+    rightMacroMeter.setBallisticsRunning(shouldRun);
+}
+
+bool StereoMeter::isSettled()
+{
+    return leftMacroMeter.isSettled() && rightMacroMeter.isSettled();
+}
+
 void StereoMeter::resized()
 {
     auto bounds = getLocalBounds();
@@ -772,6 +865,89 @@ void StereoMeter::update(float leftChannelDb, float rightChannelDb)
     rightMacroMeter.updateLevel(rightChannelDb);
 }
 
+//==============================================================================
+//MARK: - LowEndMeter
+
+LowEndMeter::LowEndMeter()
+{
+    for (size_t ch = 0; ch < PeakTracker::numChannels; ++ch)
+    {
+        dcOffset[ch] = 0.f;
+        subsonicDb[ch] = NEGATIVE_INFINITY;
+    }
+}
+
+void LowEndMeter::resized()
+{
+    auto bounds = getLocalBounds().withTrimmedTop(16);
+    int rowHeight = bounds.getHeight() / PeakTracker::numChannels;
+    
+    for (size_t ch = 0; ch < PeakTracker::numChannels; ++ch)
+    {
+        auto row = bounds.removeFromTop(rowHeight).withTrimmedLeft(labelWidth);
+        dcTextAreas[ch] = row.removeFromTop(row.getHeight() / 2);
+        subsonicBarAreas[ch] = row.reduced(0, 3);
+    }
+    
+    labelsImage = juce::Image(juce::Image::ARGB, getWidth(), getHeight(), true);
+    juce::Graphics g(labelsImage);
+    buildLabelsImage(g);
+}
+
+void LowEndMeter::buildLabelsImage(juce::Graphics& g)
+{
+    g.setColour(juce::Colours::white);
+    g.setFont(12.f);
+    g.drawText("DC / < 20 Hz", 0, 0, getWidth(), 16, juce::Justification::centred);
+    
+    const char* names[] = { "L", "R" };
+    for (size_t ch = 0; ch < PeakTracker::numChannels; ++ch)
+    {
+        auto& area = dcTextAreas[ch];
+        g.drawText(names[ch], 0, area.getY(), labelWidth, area.getHeight(), juce::Justification::centredLeft);
+    }
+}
+
+void LowEndMeter::paint(juce::Graphics& g)
+{
+    TRACE_COMPONENT();
+    
+    g.drawImageAt(labelsImage, 0, 0);
+    g.setFont(12.f);
+    
+    for (size_t ch = 0; ch < PeakTracker::numChannels; ++ch)
+    {
+        float dc = dcOffset[ch].load();
+        g.setColour(std::abs(dc) >= dcWarningLevel ? juce::Colours::red : juce::Colours::white);
+        g.drawText((dc >= 0.f ? "+" : "") + juce::String(dc * 100.f, 2) + " %",
+                   dcTextAreas[ch], juce::Justification::centredRight);
+        
+        auto& bar = subsonicBarAreas[ch];
+        g.setColour(juce::Colours::black);
+        g.fillRect(bar);
+        
+        float db = juce::jlimit(minSubsonicDb, 0.f, subsonicDb[ch].load());
+        g.setColour(juce::Colours::orange);
+        g.fillRect(bar.toFloat().withWidth(juce::jmap(db, minSubsonicDb, 0.f, 0.f, float(bar.getWidth()))));
+    }
+}
+
+void LowEndMeter::setLevels(const LowEndLevels& levels)
+{
+    for (size_t ch = 0; ch < PeakTracker::numChannels; ++ch)
+    {
+        dcOffset[ch] = levels.dcOffset[ch];
+        subsonicDb[ch] = levels.subsonicDb[ch];
+    }
+}
+
+void LowEndMeter::update()
+{
+    TRACE_EVENT_BEGIN("component", "LowEndMeterRepaint");
+    juce::MessageManager::getInstance()->callAsync( [this] { repaint(); } );
+    TRACE_EVENT_END("component");
+}
+
 //==============================================================================
 //MARK: - ReadAllAfterWriteCircularBuffer
 
@@ -855,7 +1031,10 @@ Histogram::Histogram(juce::ValueTree _vt, const juce::String& _title)
 
 void Histogram::valueTreePropertyChanged(juce::ValueTree& _vt, const juce::Identifier& _ID)
 {
-    if (_ID == IDs::thresholdValue)
+    if (SettingsBatch::isApplying())
+        return;
+    
+    if (_ID == IDs::thresholdValue || _ID == IDs::settingsChanged)
     {
         dbThreshold = _vt.getProperty(IDs::thresholdValue);
     }
@@ -874,7 +1053,13 @@ void Histogram::paint(juce::Graphics &g)
         g.fillRect(pathArea.getX(), tickY, pathArea.getWidth(), 1);
     }
 
-    displayPath(g, pathArea.toFloat());
+    if (logReader != nullptr)
+        displayLogSpans(g, pathArea.toFloat());
+    else
+    {
+        displayPath(g, pathArea.toFloat());
+        displayNoiseFloor(g, pathArea.toFloat());
+    }
     
     g.drawImageAt(titleImage, titleImagePosition.x, titleImagePosition.y);
     
@@ -929,6 +1114,7 @@ void Histogram::resized()
     histogramColourGradient.point2 = pathArea.getTopLeft().toFloat();
     
     buffer.resize(static_cast<size_t>(pathArea.getWidth()), NEGATIVE_INFINITY);
+    limitView();
     
     titleImage = juce::Image(juce::Image::ARGB, titleWidth, titleHeight, true);
     juce::Graphics g(titleImage);
@@ -946,8 +1132,17 @@ void Histogram::buildTitleImage(juce::Graphics &g)
 
 void Histogram::mouseDown(__attribute__((unused)) const juce::MouseEvent &e)
 {
+    if (logReader != nullptr)
+    {
+        dragStartFrame = viewStartFrame;
+        return;
+    }
+    
     buffer.clear(NEGATIVE_INFINITY);
     
+    if (onClear)
+        onClear();
+    
     TRACE_EVENT_BEGIN("component", "HistogramRepaint");
     repaint(pathArea);
     TRACE_EVENT_END("component");
@@ -982,48 +1177,141 @@ void Histogram::mouseExit(__attribute__((unused)) const juce::MouseEvent &e)
     isMouseHovered = false;
 }
 
+void Histogram::mouseDrag(const juce::MouseEvent &e)
+{
+    if (logReader == nullptr)
+        return;
+    
+    // Drag right to move back in time
+    viewStartFrame = dragStartFrame - e.getDistanceFromDragStartX() * framesPerPixel;
+    limitView();
+    repaint(pathArea);
+}
+
+void Histogram::mouseWheelMove(const juce::MouseEvent &e, const juce::MouseWheelDetails &wheel)
+{
+    if (logReader == nullptr)
+        return;
+    
+    if (e.mods.isCommandDown() || e.mods.isCtrlDown())
+    {
+        // Zoom around the frame under the cursor
+        double anchorX = e.position.x - pathArea.getX();
+        double anchorFrame = viewStartFrame + anchorX * framesPerPixel;
+        
+        framesPerPixel *= std::pow(2.0, -wheel.deltaY * 4.0);
+        framesPerPixel = juce::jlimit(minFramesPerPixel, getMaxFramesPerPixel(), framesPerPixel);
+        viewStartFrame = anchorFrame - anchorX * framesPerPixel;
+    }
+    else
+    {
+        float delta = std::abs(wheel.deltaX) > std::abs(wheel.deltaY) ? wheel.deltaX : wheel.deltaY;
+        viewStartFrame -= delta * pathArea.getWidth() * framesPerPixel;
+    }
+    
+    limitView();
+    repaint(pathArea);
+}
+
 void Histogram::update(float value)
 {
     TRACE_COMPONENT();
     
     buffer.write(value);
     
+    if (logReader != nullptr)
+        return;
+    
     TRACE_EVENT_BEGIN("component", "HistogramRepaint");
     juce::MessageManager::getInstance()->callAsync( [this] { repaint(pathArea); } );
     TRACE_EVENT_END("component");}
 
-void Histogram::displayPath(juce::Graphics &g, juce::Rectangle<float> bounds)
+void Histogram::restore(const std::vector<float>& values)
 {
-    TRACE_COMPONENT();
+    buffer.clear(NEGATIVE_INFINITY);
     
-    juce::Path fillPath = buildPath(path, buffer, bounds);
+    // Only the newest values fit on screen
+    size_t first = values.size() > buffer.getSize() ? values.size() - buffer.getSize() : 0;
     
-    if (!fillPath.isEmpty())
-    {
-        float dbThresholdMapped = juce::jmap(dbThreshold,
-                                             NEGATIVE_INFINITY, MAX_DECIBELS,
-                                             0.0f, 1.0f);
+    for (size_t i = first; i < values.size(); ++i)
+        buffer.write(values[i]);
     
-        histogramColourGradient.clearColours();
-        histogramColourGradient.addColour(0, bottomColour);
-        histogramColourGradient.addColour(dbThresholdMapped, belowThresholdColour);
-        histogramColourGradient.addColour(juce::jmin(dbThresholdMapped + 0.01f, 1.0f), aboveThresholdColour);
-        histogramColourGradient.addColour(1, aboveThresholdColour);
-        
-        g.setGradientFill(histogramColourGradient);
-        g.fillPath(fillPath);
-    }
+    repaint(pathArea);
 }
 
-juce::Path Histogram::buildPath(juce::Path &p, ReadAllAfterWriteCircularBuffer<float> &buffer, juce::Rectangle<float> bounds)
+void Histogram::setLogReader(MeterLogReader *reader)
+{
+    logReader = reader;
+    
+    // Start zoomed out to the whole log, which has no frames until it's loaded
+    viewStartFrame = 0;
+    framesPerPixel = getMaxFramesPerPixel();
+    limitView();
+    
+    if (logReader != nullptr)
+        startTimerHz(logRefreshHz);
+    else
+        stopTimer();
+    
+    repaint();
+}
+
+void Histogram::timerCallback()
+{
+    if (logReader == nullptr)
+        return;
+    
+    // A view of the whole log, or of its end, follows it as it grows
+    bool wasZoomedOut = framesPerPixel >= getMaxFramesPerPixel();
+    bool wasShowingEnd = viewStartFrame + pathArea.getWidth() * framesPerPixel >= logReader->getNumFrames();
+    
+    if (! logReader->refresh())
+        return;
+    
+    if (wasZoomedOut)
+        framesPerPixel = getMaxFramesPerPixel();
+    
+    if (wasShowingEnd)
+        viewStartFrame = logReader->getNumFrames() - pathArea.getWidth() * framesPerPixel;
+    
+    limitView();
+    repaint(pathArea);
+}
+
+double Histogram::getMaxFramesPerPixel() const
+{
+    if (logReader == nullptr || pathArea.getWidth() <= 0)
+        return minFramesPerPixel;
+    
+    return juce::jmax(minFramesPerPixel, static_cast<double>(logReader->getNumFrames()) / pathArea.getWidth());
+}
+
+void Histogram::limitView()
+{
+    if (logReader == nullptr)
+        return;
+    
+    framesPerPixel = juce::jlimit(minFramesPerPixel, getMaxFramesPerPixel(), framesPerPixel);
+    
+    double lastStartFrame = logReader->getNumFrames() - pathArea.getWidth() * framesPerPixel;
+    viewStartFrame = juce::jlimit(0.0, juce::jmax(0.0, lastStartFrame), viewStartFrame);
+}
+
+void Histogram::displayLogSpans(juce::Graphics &g, juce::Rectangle<float> bounds)
 {
     TRACE_COMPONENT();
     
-    p.clear();
+    if (logReader->isLoading())
+    {
+        g.setColour(juce::Colours::grey);
+        g.setFont(14.f);
+        g.drawText("Loading " + logReader->getFile().getFileName() + "...", bounds, juce::Justification::centred);
+        return;
+    }
+    
+    int numColumns = static_cast<int>(bounds.getWidth());
+    logReader->getSpans(viewStartFrame, framesPerPixel, numColumns, logSpans);
     
-    size_t bufferSizeCached = buffer.getSize();
-    size_t readIndexCached = buffer.getReadIndex();
-    std::vector<float>& dataCached = buffer.getData();
     float bottom = bounds.getBottom();
     float top = bounds.getY();
     float left = bounds.getX();
@@ -1035,23 +1323,121 @@ juce::Path Histogram::buildPath(juce::Path &p, ReadAllAfterWriteCircularBuffer<f
                           bottom, top);
     };
     
-    auto incrementAndWrap = [=](std::size_t readIndex)
+    // One vertical bar per column from the quietest to the loudest frame it covers
+    juce::RectangleList<float> bars;
+    for (int x = 0; x < numColumns; ++x)
     {
-        return (readIndex == bufferSizeCached - 1) ? 0 : readIndex + 1;
-    };
-            
-    p.startNewSubPath(left + 1, map(dataCached[readIndexCached]));
-    readIndexCached = incrementAndWrap(readIndexCached);
+        auto& span = logSpans[static_cast<size_t>(x)];
+        if (span.isEmpty())
+            continue;
         
-    for (size_t x = 1; x < bufferSizeCached - 1; ++x)
-    {
-        p.lineTo(left + 1 + x, map(dataCached[readIndexCached]));
-        readIndexCached = incrementAndWrap(readIndexCached);
+        float yMax = map(span.maxDb);
+        float yMin = map(span.minDb);
+        bars.addWithoutMerging({ left + x, yMax, 1.f, juce::jmax(1.f, yMin - yMax) });
     }
     
-    if (bounds.getHeight() <= 0)
-    {
-        return juce::Path();
+    setGradientColours();
+    g.setGradientFill(histogramColourGradient);
+    g.fillRectList(bars);
+}
+
+void Histogram::setGradientColours()
+{
+    float dbThresholdMapped = juce::jmap(dbThreshold,
+                                         NEGATIVE_INFINITY, MAX_DECIBELS,
+                                         0.0f, 1.0f);
+    
+    histogramColourGradient.clearColours();
+    histogramColourGradient.addColour(0, bottomColour);
+    histogramColourGradient.addColour(dbThresholdMapped, belowThresholdColour);
+    histogramColourGradient.addColour(juce::jmin(dbThresholdMapped + 0.01f, 1.0f), aboveThresholdColour);
+    histogramColourGradient.addColour(1, aboveThresholdColour);
+}
+
+void Histogram::displayPath(juce::Graphics &g, juce::Rectangle<float> bounds)
+{
+    TRACE_COMPONENT();
+    
+    juce::Path fillPath = buildPath(path, buffer, bounds);
+    
+    if (!fillPath.isEmpty())
+    {
+        setGradientColours();
+        g.setGradientFill(histogramColourGradient);
+        g.fillPath(fillPath);
+    }
+}
+
+void Histogram::setNoiseFloor(float floorDb, float _snrDb)
+{
+    noiseFloorDb = floorDb;
+    snrDb = _snrDb;
+}
+
+void Histogram::displayNoiseFloor(juce::Graphics &g, juce::Rectangle<float> bounds)
+{
+    float floorDb = noiseFloorDb;
+    float snr = snrDb;
+    
+    juce::String text = "Noise -  SNR -";
+    
+    if (floorDb > NEGATIVE_INFINITY)
+    {
+        float y = juce::jmap(juce::jmin(floorDb, MAX_DECIBELS),
+                             NEGATIVE_INFINITY, MAX_DECIBELS,
+                             bounds.getBottom(), bounds.getY());
+        
+        g.setColour(noiseFloorColour);
+        g.drawHorizontalLine(juce::roundToInt(y), bounds.getX(), bounds.getRight());
+        
+        text = "Noise " + juce::String(floorDb, 1) + " dB  SNR "
+             + (snr > NEGATIVE_INFINITY ? juce::String(snr, 1) + " dB" : juce::String("-"));
+    }
+    
+    g.setColour(noiseFloorColour);
+    g.setFont(12.0f);
+    g.drawText(text,
+               bounds.withWidth(static_cast<float>(noiseFloorTextAreaWidth)).withHeight(16.f).translated(4.f, 2.f),
+               juce::Justification::centredLeft);
+}
+
+juce::Path Histogram::buildPath(juce::Path &p, ReadAllAfterWriteCircularBuffer<float> &buffer, juce::Rectangle<float> bounds)
+{
+    TRACE_COMPONENT();
+    
+    p.clear();
+    
+    size_t bufferSizeCached = buffer.getSize();
+    size_t readIndexCached = buffer.getReadIndex();
+    std::vector<float>& dataCached = buffer.getData();
+    float bottom = bounds.getBottom();
+    float top = bounds.getY();
+    float left = bounds.getX();
+    
+    auto map = [=](float db)
+    {
+        return juce::jmap(juce::jlimit(NEGATIVE_INFINITY, MAX_DECIBELS, db),
+                          NEGATIVE_INFINITY, MAX_DECIBELS,
+                          bottom, top);
+    };
+    
+    auto incrementAndWrap = [=](std::size_t readIndex)
+    {
+        return (readIndex == bufferSizeCached - 1) ? 0 : readIndex + 1;
+    };
+            
+    p.startNewSubPath(left + 1, map(dataCached[readIndexCached]));
+    readIndexCached = incrementAndWrap(readIndexCached);
+        
+    for (size_t x = 1; x < bufferSizeCached - 1; ++x)
+    {
+        p.lineTo(left + 1 + x, map(dataCached[readIndexCached]));
+        readIndexCached = incrementAndWrap(readIndexCached);
+    }
+    
+    if (bounds.getHeight() <= 0)
+    {
+        return juce::Path();
     }
     else
     {
@@ -1254,6 +1640,7 @@ void Goniometer::update()
     std::lock_guard<std::mutex> lock(pointCloudMutex);
     
     pointCloud.multiplyAllAlphas(0.99f);
+    midSideSums.reset();
     
     for (int i = 0; i < numSamples; ++i)
     {
@@ -1290,6 +1677,9 @@ void Goniometer::update()
         jassert( ! std::isnan(mid) && ! std::isinf(mid) );
         jassert( ! std::isnan(side) && ! std::isinf(side) );
         
+        // The width meters read these; the scale cancels out of their ratios
+        midSideSums.add(mid, side);
+        
         // 0 dBfs (1.0f) samples should reach the edge of the circle
         midMapped = juce::jmap(mid,
                                -1.f,
@@ -1343,20 +1733,7 @@ void Goniometer::update()
 CorrelationMeter::CorrelationMeter(juce::AudioBuffer<float>& _buffer, double _sampleRate)
     : buffer(_buffer)
 {
-    // Initialize moving-average windows via FIR low-pass filters
-    
-    using FilterDesign = juce::dsp::FilterDesign<float>;
-    using WindowingMethod = juce::dsp::WindowingFunction<float>::WindowingMethod;
-    
-    FilterDesign::FIRCoefficientsPtr coefficientsPtr( FilterDesign::designFIRLowpassWindowMethod(10.f, //frequency
-                                                                                                 _sampleRate,
-                                                                                                 1, //order
-                                                                                                 WindowingMethod::rectangular) );
-
-    for (juce::dsp::FIR::Filter<float> &filter : filters)
-    {
-        filter = juce::dsp::FIR::Filter<float>(coefficientsPtr);
-    }
+    correlationAnalyser.prepare(_sampleRate);
 }
 
 void CorrelationMeter::paint(juce::Graphics &g)
@@ -1432,22 +1809,11 @@ void CorrelationMeter::update()
         float rightSample = buffer.getSample(1, iSample);
         
         // Feed L and R samples into correlation math equation
-        float numerator = filters[0].processSample( leftSample * rightSample );
-        float denominator = sqrt( filters[1].processSample(juce::square(leftSample))
-                                * filters[2].processSample(juce::square(rightSample)) );
-        float c = numerator / denominator;
+        float c = correlationAnalyser.processSample(leftSample, rightSample);
                 
         // Feed correlation result into averagers
-        if ( std::isnan(c) || std::isinf(c) )
-        {
-            slowAverager.add(0);
-            peakAverager.add(0);
-        }
-        else
-        {
-            slowAverager.add(c);
-            peakAverager.add(c);
-        }
+        slowAverager.add(c);
+        peakAverager.add(c);
     }
     
     TRACE_EVENT_END("component");
@@ -1496,25 +1862,211 @@ void CorrelationMeter::drawAverage(juce::Graphics& g,
     }
 }
 
+//==============================================================================
+//MARK: - StereoFieldMeter
+
+StereoFieldMeter::StereoFieldMeter(juce::ValueTree _vt, const MeterClock& clock)
+    : vt(_vt),
+      widthHold(_vt, clock),
+      monoLossHold(_vt, clock)
+{
+    vt.addListener(this);
+    
+    setAveragerIntervals(vt.getProperty(IDs::averagerIntervals));
+}
+
+StereoFieldMeter::~StereoFieldMeter()
+{
+    vt.removeListener(this);
+}
+
+void StereoFieldMeter::valueTreePropertyChanged(juce::ValueTree& _vt, const juce::Identifier& _ID)
+{
+    if (SettingsBatch::isApplying())
+        return;
+    
+    if (_ID == IDs::averagerIntervals || _ID == IDs::settingsChanged)
+        setAveragerIntervals(_vt.getProperty(IDs::averagerIntervals));
+}
+
+void StereoFieldMeter::setAveragerIntervals(int numElements)
+{
+    // Resizing clears the averagers, don't do it for nothing
+    if (numElements <= 0 || widthAverager.getSize() == size_t(numElements))
+        return;
+    
+    widthAverager.resize(size_t(numElements), widthAverager.getAvg());
+    balanceAverager.resize(size_t(numElements), balanceAverager.getAvg());
+    monoLossAverager.resize(size_t(numElements), monoLossAverager.getAvg());
+}
+
+void StereoFieldMeter::resized()
+{
+    auto bounds = getLocalBounds();
+    bounds.removeFromBottom(labelHeight);
+    
+    int barWidth = bounds.getWidth() / 3;
+    widthBarArea    = bounds.removeFromLeft(barWidth).reduced(3, 0);
+    balanceBarArea  = bounds.removeFromLeft(barWidth).reduced(3, 0);
+    monoLossBarArea = bounds.reduced(3, 0);
+    
+    labelsImage = juce::Image(juce::Image::ARGB, getWidth(), getHeight(), true);
+    juce::Graphics g(labelsImage);
+    buildLabelsImage(g);
+}
+
+void StereoFieldMeter::buildLabelsImage(juce::Graphics& g)
+{
+    g.setColour(juce::Colours::white);
+    g.setFont(10.f);
+    
+    auto drawLabel = [&g, this](const juce::String& text, juce::Rectangle<int> barArea)
+    {
+        g.drawFittedText(text,
+                         barArea.getX() - 3, barArea.getBottom(), barArea.getWidth() + 6, labelHeight,
+                         juce::Justification::centred, 1, 1.f);
+    };
+    
+    drawLabel("Wid",  widthBarArea);
+    drawLabel("Bal",  balanceBarArea);
+    drawLabel("Mono", monoLossBarArea);
+}
+
+void StereoFieldMeter::paint(juce::Graphics& g)
+{
+    TRACE_COMPONENT();
+    
+    drawBar(g, widthBarArea, widthAverager.getAvg(), minWidthDb, minWidthDb, maxWidthDb, juce::Colours::skyblue);
+    drawHold(g, widthBarArea, widthHold.getHeldValue(), minWidthDb, maxWidthDb);
+    
+    // Left louder goes up
+    drawBar(g, balanceBarArea, balanceAverager.getAvg(), 0.f, -maxBalanceDb, maxBalanceDb, juce::Colours::gold);
+    
+    drawBar(g, monoLossBarArea, monoLossAverager.getAvg(), 0.f, 0.f, maxMonoLossDb, juce::Colours::orange);
+    drawHold(g, monoLossBarArea, monoLossHold.getHeldValue(), 0.f, maxMonoLossDb);
+    
+    // 0 dB marks: as much side as mid, and centred balance
+    g.setColour(juce::Colours::grey);
+    for (auto [area, minValue, maxValue] : { std::make_tuple(widthBarArea, minWidthDb, maxWidthDb),
+                                             std::make_tuple(balanceBarArea, -maxBalanceDb, maxBalanceDb) })
+    {
+        int y = juce::roundToInt(juce::jmap(0.f, minValue, maxValue, float(area.getBottom()), float(area.getY())));
+        g.fillRect(area.getX(), y, area.getWidth(), 1);
+    }
+    
+    g.drawImageAt(labelsImage, 0, 0);
+}
+
+void StereoFieldMeter::drawBar(juce::Graphics& g,
+                               juce::Rectangle<int> bounds,
+                               float value,
+                               float originValue,
+                               float minValue,
+                               float maxValue,
+                               juce::Colour colour)
+{
+    g.setColour(juce::Colours::black);
+    g.fillRect(bounds);
+    
+    auto toY = [&bounds, minValue, maxValue](float v)
+    {
+        return juce::jmap(juce::jlimit(minValue, maxValue, v), minValue, maxValue, float(bounds.getBottom()), float(bounds.getY()));
+    };
+    
+    float valueY = toY(value);
+    float originY = toY(originValue);
+    
+    g.setColour(colour);
+    g.fillRect(juce::Rectangle<float>(float(bounds.getX()), juce::jmin(valueY, originY),
+                                      float(bounds.getWidth()), std::abs(originY - valueY)));
+}
+
+void StereoFieldMeter::drawHold(juce::Graphics& g,
+                                juce::Rectangle<int> bounds,
+                                float value,
+                                float minValue,
+                                float maxValue)
+{
+    if (value < minValue)
+        return;
+    
+    float y = juce::jmap(juce::jmin(value, maxValue), minValue, maxValue, float(bounds.getBottom()), float(bounds.getY()));
+    
+    g.setColour(juce::Colours::white);
+    g.fillRect(juce::Rectangle<float>(float(bounds.getX()), juce::jmax(float(bounds.getY()), y - 1.f), float(bounds.getWidth()), 2.f));
+}
+
+void StereoFieldMeter::update(const MidSideSums& sums)
+{
+    TRACE_COMPONENT();
+    
+    float widthDb = sums.getWidthDb();
+    float monoLossDb = sums.getMonoLossDb();
+    
+    widthAverager.add(widthDb);
+    balanceAverager.add(sums.getBalanceDb());
+    monoLossAverager.add(monoLossDb);
+    
+    widthHold.updateHeldValue(widthDb);
+    monoLossHold.updateHeldValue(monoLossDb);
+    
+    TRACE_EVENT_BEGIN("component", "StereoFieldMeterRepaint");
+    juce::MessageManager::getInstance()->callAsync( [this] { repaint(); } );
+    TRACE_EVENT_END("component");
+}
+
+void StereoFieldMeter::resetHold()
+{
+    widthHold.resetHeldValue();
+    monoLossHold.resetHeldValue();
+}
+
+void StereoFieldMeter::tickBallistics()
+{
+    widthHold.tick();
+    monoLossHold.tick();
+}
+
+void StereoFieldMeter::setBallisticsRunning(bool shouldRun)
+{
+    widthHold.setTicking(shouldRun);
+    monoLossHold.setTicking(shouldRun);
+}
+
+bool StereoFieldMeter::isSettled() const
+{
+    // The averages of silence sit at the floor, or at the centre for the balance
+    return widthAverager.getAvg() < NEGATIVE_INFINITY + 0.1f
+        && monoLossAverager.getAvg() < NEGATIVE_INFINITY + 0.1f
+        && std::abs(balanceAverager.getAvg()) < 0.1f
+        && widthHold.isSettled()
+        && monoLossHold.isSettled();
+}
+
 //==============================================================================
 //MARK: - StereoImageMeter
 
-StereoImageMeter::StereoImageMeter(juce::ValueTree _vt, juce::AudioBuffer<float>& _buffer, double _sampleRate)
+StereoImageMeter::StereoImageMeter(juce::ValueTree _vt, juce::AudioBuffer<float>& _buffer, double _sampleRate, const MeterClock& clock)
     : vt(_vt),
       goniometer(_buffer),
-      correlationMeter(_buffer, _sampleRate)
+      correlationMeter(_buffer, _sampleRate),
+      stereoFieldMeter(_vt, clock)
 {
     vt.addListener(this);
     
     addAndMakeVisible(goniometer);
     addAndMakeVisible(correlationMeter);
+    addAndMakeVisible(stereoFieldMeter);
     
     goniometer.setScale( vt.getProperty(IDs::goniometerScale) );
 }
 
 void StereoImageMeter::valueTreePropertyChanged(juce::ValueTree& _vt, const juce::Identifier& _ID)
 {
-    if (_ID == IDs::goniometerScale)
+    if (SettingsBatch::isApplying())
+        return;
+    
+    if (_ID == IDs::goniometerScale || _ID == IDs::settingsChanged)
     {
         goniometer.setScale( _vt.getProperty(IDs::goniometerScale) );
     }
@@ -1537,6 +2089,12 @@ void StereoImageMeter::resized()
                                        1.0f - gonioToCorrMeterHeightRatio);
     int sideTrim = correlationMeter.getMeterAreaTrimSide();
     correlationMeter.setBounds(correlationMeter.getBounds().withTrimmedLeft(sideTrim).withTrimmedRight(sideTrim));
+    
+    // Right of the goniometer, below the scale slider and the overview button
+    stereoFieldMeter.setBoundsRelative(0.879f,
+                                       0.48f,
+                                       0.121f,
+                                       gonioToCorrMeterHeightRatio - 0.48f);
 }
 
 void StereoImageMeter::update()
@@ -1547,92 +2105,1246 @@ void StereoImageMeter::update()
     
     correlationMeter.update();
     
+    stereoFieldMeter.update(goniometer.getMidSideSums());
+    
     TRACE_EVENT_END("component");
 }
 
 //==============================================================================
-//==============================================================================
-//MARK: - PFM10AudioProcessorEditor
+//MARK: - Oscilloscope
 
-PFM10AudioProcessorEditor::PFM10AudioProcessorEditor (PFM10AudioProcessor& p)
-    : AudioProcessorEditor (&p),
-      audioProcessor (p),
-      valueTree(p.valueTree),
-      editorAudioBuffer(2, 512),
-      background(juce::ImageFileFormat::loadFrom(BinaryData::plugin_bg_half_png, BinaryData::plugin_bg_half_pngSize)),
-      peakStereoMeter(valueTree, juce::String("Peak")),
-      peakHistogram(valueTree, juce::String("Peak")),
-      stereoImageMeter(valueTree, editorAudioBuffer, audioProcessor.getSampleRate())
+Oscilloscope::Oscilloscope(juce::ValueTree _vt, double _sampleRate)
+    : vt(_vt)
 {
-    setSize (pluginWidth, pluginHeight);
-    
-    //setResizable(true, true);
-    //setResizeLimits(600, 600,    //min
-    //                900, 900);  //max
+    prepare(_sampleRate);
     
-    addAndMakeVisible(peakStereoMeter);
-    addAndMakeVisible(peakHistogram);
-    addAndMakeVisible(stereoImageMeter);
+    triggerMenu.addItem("Free",  TRIGGER_FREE + 1);
+    triggerMenu.addItem("Zero",  TRIGGER_ZERO + 1);
+    triggerMenu.addItem("Level", TRIGGER_LEVEL + 1);
+    triggerMenu.setTooltip("Trigger on rising zero crossings or on the threshold level");
+    triggerMenu.onChange = [this] { vt.setProperty(IDs::scopeTrigger, triggerMenu.getSelectedId() - 1, nullptr); };
+    addAndMakeVisible(triggerMenu);
     
-    initMenus();
+    for (int ms : { 5, 20, 50, 200, 1000, maxWindowMs })
+        windowMenu.addItem(ms < 1000 ? juce::String(ms) + "ms" : juce::String(ms / 1000) + "s", ms);
+    windowMenu.setTooltip("Oscilloscope window length");
+    windowMenu.onChange = [this] { vt.setProperty(IDs::scopeWindowMs, windowMenu.getSelectedId(), nullptr); };
+    addAndMakeVisible(windowMenu);
     
-    startTimerHz(refreshRateHz);
+    vt.addListener(this);
+    loadSettings(vt);
+}
+
+void Oscilloscope::prepare(double sampleRate)
+{
+    // A full window after the trigger, and a window before it to search in
+    std::lock_guard<std::mutex> lock(historyMutex);
+    history.prepare(sampleRate, 2 * maxWindowMs / 1000.0);
+}
+
+Oscilloscope::~Oscilloscope()
+{
+    vt.removeListener(this);
+}
+
+void Oscilloscope::loadSettings(juce::ValueTree& tree)
+{
+    triggerMode = static_cast<int>(tree.getProperty(IDs::scopeTrigger));
+    windowMs = juce::jlimit(1, maxWindowMs, static_cast<int>(tree.getProperty(IDs::scopeWindowMs)));
+    triggerLevel = juce::Decibels::decibelsToGain(static_cast<float>(tree.getProperty(IDs::thresholdValue)));
     
-    updateThread.fn = std::function<void()>( [this] { update(); } );
-    updateThread.startThread();
+    triggerMenu.setSelectedId(triggerMode.load() + 1, juce::dontSendNotification);
+    windowMenu.setSelectedId(windowMs.load(), juce::dontSendNotification);
 }
 
-PFM10AudioProcessorEditor::~PFM10AudioProcessorEditor()
+void Oscilloscope::valueTreePropertyChanged(juce::ValueTree& _vt, const juce::Identifier& _ID)
 {
+    if (SettingsBatch::isApplying())
+        return;
+    
+    if (_ID == IDs::scopeTrigger || _ID == IDs::scopeWindowMs || _ID == IDs::thresholdValue || _ID == IDs::settingsChanged)
+    {
+        loadSettings(_vt);
+    }
 }
 
-void PFM10AudioProcessorEditor::initMenus()
+void Oscilloscope::resized()
 {
-    // Decay Rate Menu
+    auto bounds = getLocalBounds();
+    auto menuArea = bounds.removeFromTop(menuHeight);
     
-    decayRateMenuLabel.setJustificationType(juce::Justification::centred);
-    decayRateMenuLabel.setBufferedToImage(true);
-    addAndMakeVisible(decayRateMenuLabel);
+    triggerMenu.setBounds(menuArea.removeFromLeft(menuArea.getWidth() / 2).reduced(2, 0));
+    windowMenu.setBounds(menuArea.reduced(2, 0));
     
-    decayRateMenu.addItem("-3dB/s",  DB_PER_SEC_3);
-    decayRateMenu.addItem("-6dB/s",  DB_PER_SEC_6);
-    decayRateMenu.addItem("-12dB/s", DB_PER_SEC_12);
-    decayRateMenu.addItem("-24dB/s", DB_PER_SEC_24);
-    decayRateMenu.addItem("-36dB/s", DB_PER_SEC_36);
-    decayRateMenu.setTooltip("Peak Marker Decay Rate");
-    decayRateMenu.onChange = [this] { onDecayRateMenuChanged(); };
-    decayRateMenu.setSelectedId( decayRateMenuSelectByValue(valueTree.getProperty(IDs::decayRate)) );
-    decayRateMenu.setBufferedToImage(true);
-    addAndMakeVisible(decayRateMenu);
+    // update() reads the area under traceMutex too
+    std::lock_guard<std::mutex> lock(traceMutex);
+    traceArea = bounds.withTrimmedTop(6);
     
-    // Averager Duration Menu
+    backgroundImage = juce::Image(juce::Image::ARGB, getWidth(), getHeight(), true);
+    juce::Graphics g(backgroundImage);
+    buildBackground(g);
     
-    averagerDurationMenuLabel.setJustificationType(juce::Justification::centred);
-    averagerDurationMenuLabel.setBufferedToImage(true);
-    addAndMakeVisible(averagerDurationMenuLabel);
+    trace = juce::Image(juce::Image::ARGB, juce::jmax(1, traceArea.getWidth()), juce::jmax(1, traceArea.getHeight()), true);
+}
 
-    averagerDurationMenu.addItem("100ms",  AVERAGER_DURATION_MS_100);
-    averagerDurationMenu.addItem("250ms",  AVERAGER_DURATION_MS_250);
-    averagerDurationMenu.addItem("500ms",  AVERAGER_DURATION_MS_500);
-    averagerDurationMenu.addItem("1000ms", AVERAGER_DURATION_MS_1000);
-    averagerDurationMenu.addItem("2000ms", AVERAGER_DURATION_MS_2000);
-    averagerDurationMenu.setTooltip("Averaging duration for RMS meters");
-    averagerDurationMenu.onChange = [this] { onAveragerDurationMenuChanged(); };
-    averagerDurationMenu.setSelectedId( averagerDurationMenuSelectByValue(valueTree.getProperty(IDs::averagerIntervals)) );
-    averagerDurationMenu.setBufferedToImage(true);
-    addAndMakeVisible(averagerDurationMenu);
+void Oscilloscope::buildBackground(juce::Graphics& g)
+{
+    g.setColour(juce::Colours::black);
+    g.fillRect(traceArea);
     
-    // Peak Hold Duration Menu
+    // Zero line and +-6 dB lines
+    g.setColour(juce::Colours::darkgrey.darker());
+    float halfGain = juce::Decibels::decibelsToGain(-6.f);
+    for (float level : { halfGain, -halfGain })
+    {
+        g.fillRect(traceArea.getX(),
+                   juce::roundToInt(juce::jmap(level, 1.f, -1.f, float(traceArea.getY()), float(traceArea.getBottom()))),
+                   traceArea.getWidth(),
+                   1);
+    }
     
-    peakHoldDurationMenuLabel.setJustificationType(juce::Justification::centred);
-    peakHoldDurationMenuLabel.setBufferedToImage(true);
-    addAndMakeVisible(peakHoldDurationMenuLabel);
+    g.setColour(juce::Colours::grey);
+    g.fillRect(traceArea.getX(), traceArea.getCentreY(), traceArea.getWidth(), 1);
+    g.drawRect(traceArea);
+}
 
-    peakHoldDurationMenu.addItem("0s",   PEAK_HOLD_DURATION_MS_0);
-    peakHoldDurationMenu.addItem("0.5s", PEAK_HOLD_DURATION_MS_500);
-    peakHoldDurationMenu.addItem("2s",   PEAK_HOLD_DURATION_MS_2000);
-    peakHoldDurationMenu.addItem("4s",   PEAK_HOLD_DURATION_MS_4000);
-    peakHoldDurationMenu.addItem("6s",   PEAK_HOLD_DURATION_MS_6000);
+void Oscilloscope::paint(juce::Graphics& g)
+{
+    TRACE_COMPONENT();
+    
+    g.drawImageAt(backgroundImage, 0, 0);
+    
+    std::lock_guard<std::mutex> lock(traceMutex);
+    g.drawImageAt(trace, traceArea.getX(), traceArea.getY());
+}
+
+void Oscilloscope::push(const juce::AudioBuffer<float>& block)
+{
+    std::lock_guard<std::mutex> lock(historyMutex);
+    history.push(block);
+}
+
+void Oscilloscope::reset()
+{
+    std::lock_guard<std::mutex> lock(historyMutex);
+    history.clear();
+}
+
+void Oscilloscope::update()
+{
+    juce::Rectangle<int> area;
+    {
+        std::lock_guard<std::mutex> lock(traceMutex);
+        area = traceArea;
+    }
+    
+    int numColumns = area.getWidth();
+    if (numColumns <= 0)
+        return;
+    
+    TRACE_EVENT_BEGIN("component", "oscilloscope update");
+    
+    double windowSamples = windowMs.load() * history.getSampleRate() / 1000.0;
+    auto windowLength = static_cast<juce::int64>(windowSamples);
+    
+    {
+        std::lock_guard<std::mutex> lock(historyMutex);
+        
+        auto end = history.getNumWritten();
+        auto start = end - windowLength;
+        
+        // Latest trigger that still has a whole window after it, searched one window back
+        if (triggerMode.load() != TRIGGER_FREE)
+        {
+            float level = triggerMode.load() == TRIGGER_LEVEL ? triggerLevel.load() : 0.f;
+            auto found = history.findRisingCrossing(level, start - windowLength, start);
+            
+            if (found >= 0)
+                start = found;
+        }
+        
+        history.getSpans(static_cast<double>(start), windowSamples / numColumns, numColumns, spans);
+    }
+    
+    renderTrace();
+    
+    TRACE_EVENT_END("component");
+    
+    TRACE_EVENT_BEGIN("component", "OscilloscopeRepaint");
+    juce::MessageManager::getInstance()->callAsync( [this, area] { repaint(area); } );
+    TRACE_EVENT_END("component");
+}
+
+void Oscilloscope::renderTrace()
+{
+    std::lock_guard<std::mutex> lock(traceMutex);
+    
+    juce::Image::BitmapData pixels(trace, juce::Image::BitmapData::writeOnly);
+    int height = pixels.height;
+    int numColumns = juce::jmin(pixels.width, static_cast<int>(spans.size()));
+    
+    for (int y = 0; y < height; ++y)
+        std::memset(pixels.getLinePointer(y), 0, static_cast<size_t>(pixels.width * pixels.pixelStride));
+    
+    auto toY = [height](float sample)
+    {
+        return juce::jlimit(0, height - 1, juce::roundToInt((1.f - sample) * 0.5f * (height - 1)));
+    };
+    
+    int previousTop = -1, previousBottom = -1;
+    
+    for (int x = 0; x < numColumns; ++x)
+    {
+        const auto& span = spans[static_cast<size_t>(x)];
+        if (span.isEmpty())
+        {
+            previousTop = -1;
+            continue;
+        }
+        
+        int top = toY(span.max);
+        int bottom = toY(span.min);
+        
+        // Close the gap to the previous column, so a zoomed-in trace stays connected
+        if (previousTop >= 0)
+        {
+            top = juce::jmin(top, previousBottom);
+            bottom = juce::jmax(bottom, previousTop);
+        }
+        
+        for (int y = top; y <= bottom; ++y)
+            *reinterpret_cast<juce::PixelARGB*>(pixels.getPixelPointer(x, y)) = traceColour;
+        
+        previousTop = toY(span.max);
+        previousBottom = toY(span.min);
+    }
+}
+
+//==============================================================================
+//MARK: - DynamicsMeter
+
+DynamicsMeter::DynamicsMeter(juce::ValueTree _vt, double _sampleRate, const MeterClock& clock)
+    : vt(_vt),
+      sampleRate(_sampleRate),
+      crestFactorMeter(_vt, clock),
+      psrMeter(_vt, clock),
+      plrMeter(_vt, clock)
+{
+    for (int seconds : { 1, 3, 10, 30, 60 })
+        windowMenu.addItem(juce::String(seconds) + "s", seconds);
+    windowMenu.setTooltip("Crest factor and PSR window, restarts PLR");
+    windowMenu.onChange = [this] { vt.setProperty(IDs::dynamicsWindowSeconds, windowMenu.getSelectedId(), nullptr); };
+    addAndMakeVisible(windowMenu);
+    
+    // None of the readings has a threshold, keep them out of the red
+    for (auto* meter : { &crestFactorMeter, &psrMeter, &plrMeter })
+    {
+        meter->setRange(0.f, maxDb);
+        meter->updateThreshold(maxDb);
+        addAndMakeVisible(meter);
+    }
+    
+    vt.addListener(this);
+    setWindowSeconds(vt.getProperty(IDs::dynamicsWindowSeconds));
+    loadMeterSettings(vt);
+}
+
+DynamicsMeter::~DynamicsMeter()
+{
+    vt.removeListener(this);
+}
+
+void DynamicsMeter::valueTreePropertyChanged(juce::ValueTree& _vt, const juce::Identifier& _ID)
+{
+    if (SettingsBatch::isApplying())
+        return;
+    
+    if (_ID == IDs::dynamicsWindowSeconds || _ID == IDs::settingsChanged)
+        setWindowSeconds(_vt.getProperty(IDs::dynamicsWindowSeconds));
+    
+    // Same averaging and hold as the level meters
+    if (_ID == IDs::averagerIntervals || _ID == IDs::peakHoldEnabled || _ID == IDs::settingsChanged)
+        loadMeterSettings(_vt);
+}
+
+void DynamicsMeter::loadMeterSettings(juce::ValueTree& tree)
+{
+    for (auto* meter : { &crestFactorMeter, &psrMeter, &plrMeter })
+    {
+        meter->setAveragerIntervals(tree.getProperty(IDs::averagerIntervals));
+        meter->setPeakHoldEnabled(tree.getProperty(IDs::peakHoldEnabled));
+    }
+}
+
+void DynamicsMeter::setWindowSeconds(int seconds)
+{
+    int maxSeconds = static_cast<int>(DynamicRangeAnalyser::maxWindowSteps * DynamicRangeAnalyser::stepSeconds);
+    seconds = juce::jlimit(1, maxSeconds, seconds);
+    windowMenu.setSelectedId(seconds, juce::dontSendNotification);
+    
+    // Starts the window over, the readings refill as audio arrives
+    std::lock_guard<std::mutex> lock(analyserMutex);
+    windowSeconds = seconds;
+    analyser.prepare(sampleRate, windowSeconds);
+}
+
+void DynamicsMeter::prepare(double _sampleRate)
+{
+    std::lock_guard<std::mutex> lock(analyserMutex);
+    sampleRate = _sampleRate;
+    analyser.prepare(sampleRate, windowSeconds);
+}
+
+void DynamicsMeter::resized()
+{
+    auto bounds = getLocalBounds();
+    
+    auto menuArea = bounds.removeFromTop(menuHeight);
+    windowMenu.setBounds(menuArea.removeFromRight(menuWidth));
+    
+    // Label and meter pairs, from the left
+    bounds.removeFromTop(2);
+    bounds.removeFromLeft(labelWidth);
+    crestFactorMeter.setBounds(bounds.removeFromLeft(meterWidth));
+    bounds.removeFromLeft(labelWidth);
+    psrMeter.setBounds(bounds.removeFromLeft(meterWidth));
+    bounds.removeFromLeft(labelWidth);
+    plrMeter.setBounds(bounds.removeFromLeft(meterWidth));
+    
+    labelsImage = juce::Image(juce::Image::ARGB, getWidth(), getHeight(), true);
+    juce::Graphics g(labelsImage);
+    buildLabelsImage(g);
+}
+
+void DynamicsMeter::buildLabelsImage(juce::Graphics& g)
+{
+    g.setColour(juce::Colours::white);
+    g.setFont(14.f);
+    
+    g.drawText("Dynamics", 0, 0, getWidth() - menuWidth, menuHeight, juce::Justification::centredLeft);
+    
+    // Beside the bars, below the value readouts
+    g.setFont(12.f);
+    auto drawLabel = [&](const MacroMeter& meter, const juce::String& name)
+    {
+        auto bars = meter.getBounds().withTrimmedTop(meter.getTextHeight());
+        g.drawText(name, bars.getX() - labelWidth, bars.getY(), labelWidth - 4, bars.getHeight(), juce::Justification::centredRight);
+    };
+    
+    drawLabel(crestFactorMeter, "Crest");
+    drawLabel(psrMeter, "PSR");
+    drawLabel(plrMeter, "PLR");
+}
+
+void DynamicsMeter::paint(juce::Graphics& g)
+{
+    TRACE_COMPONENT();
+    
+    g.drawImageAt(labelsImage, 0, 0);
+}
+
+void DynamicsMeter::resetHold()
+{
+    crestFactorMeter.resetHold();
+    psrMeter.resetHold();
+    plrMeter.resetHold();
+}
+
+void DynamicsMeter::tickBallistics()
+{
+    crestFactorMeter.tickBallistics();
+    psrMeter.tickBallistics();
+    plrMeter.tickBallistics();
+}
+
+void DynamicsMeter::setBallisticsRunning(bool shouldRun)
+{
+    crestFactorMeter.setBallisticsRunning(shouldRun);
+    psrMeter.setBallisticsRunning(shouldRun);
+    plrMeter.setBallisticsRunning(shouldRun);
+}
+
+bool DynamicsMeter::isSettled()
+{
+    return crestFactorMeter.isSettledOnLevel() && psrMeter.isSettledOnLevel() && plrMeter.isSettledOnLevel();
+}
+
+void DynamicsMeter::push(const juce::AudioBuffer<float>& block)
+{
+    std::lock_guard<std::mutex> lock(analyserMutex);
+    analyser.process(block, 0, block.getNumSamples());
+}
+
+void DynamicsMeter::reset()
+{
+    std::lock_guard<std::mutex> lock(analyserMutex);
+    analyser.reset();
+}
+
+void DynamicsMeter::update()
+{
+    TRACE_EVENT_BEGIN("component", "dynamics meter update");
+    
+    float crestFactorDb, psrDb, plrDb;
+    {
+        std::lock_guard<std::mutex> lock(analyserMutex);
+        crestFactorDb = analyser.getCrestFactorDb();
+        psrDb = analyser.getPsrDb();
+        plrDb = analyser.getPlrDb();
+    }
+    
+    // The meters repaint themselves
+    crestFactorMeter.updateLevel(crestFactorDb);
+    psrMeter.updateLevel(psrDb);
+    plrMeter.updateLevel(plrDb);
+    
+    TRACE_EVENT_END("component");
+}
+
+//==============================================================================
+//MARK: - ScrollingWaveform
+
+ScrollingWaveform::ScrollingWaveform(juce::ValueTree _vt, double _sampleRate)
+    : vt(_vt)
+{
+    prepare(_sampleRate);
+    
+    for (int s : { 30, 60, 120, maxSeconds })
+        secondsMenu.addItem(juce::String(s) + "s", s);
+    secondsMenu.setTooltip("Waveform overview length");
+    secondsMenu.onChange = [this] { vt.setProperty(IDs::waveformSeconds, secondsMenu.getSelectedId(), nullptr); };
+    addAndMakeVisible(secondsMenu);
+    
+    vt.addListener(this);
+    seconds = juce::jlimit(1, maxSeconds, static_cast<int>(vt.getProperty(IDs::waveformSeconds)));
+    secondsMenu.setSelectedId(seconds.load(), juce::dontSendNotification);
+}
+
+void ScrollingWaveform::prepare(double sampleRate)
+{
+    std::lock_guard<std::mutex> lock(overviewMutex);
+    overview.prepare(sampleRate, maxSeconds);
+}
+
+ScrollingWaveform::~ScrollingWaveform()
+{
+    vt.removeListener(this);
+}
+
+void ScrollingWaveform::valueTreePropertyChanged(juce::ValueTree& _vt, const juce::Identifier& _ID)
+{
+    if (SettingsBatch::isApplying())
+        return;
+    
+    if (_ID == IDs::waveformSeconds || _ID == IDs::settingsChanged)
+    {
+        seconds = juce::jlimit(1, maxSeconds, static_cast<int>(_vt.getProperty(IDs::waveformSeconds)));
+        secondsMenu.setSelectedId(seconds.load(), juce::dontSendNotification);
+    }
+}
+
+void ScrollingWaveform::resized()
+{
+    auto bounds = getLocalBounds();
+    
+    secondsMenu.setBounds(bounds.removeFromRight(menuWidth).withHeight(24));
+    
+    // update() reads the area under waveformMutex too
+    std::lock_guard<std::mutex> lock(waveformMutex);
+    waveformArea = bounds.withTrimmedRight(4);
+    waveform = juce::Image(juce::Image::ARGB, juce::jmax(1, waveformArea.getWidth()), juce::jmax(1, waveformArea.getHeight()), true);
+}
+
+void ScrollingWaveform::paint(juce::Graphics& g)
+{
+    TRACE_COMPONENT();
+    
+    g.setColour(juce::Colours::black);
+    g.fillRect(waveformArea);
+    
+    // Lane divider between left (top) and right (bottom)
+    g.setColour(juce::Colours::darkgrey);
+    g.fillRect(waveformArea.getX(), waveformArea.getCentreY(), waveformArea.getWidth(), 1);
+    
+    std::lock_guard<std::mutex> lock(waveformMutex);
+    g.drawImageAt(waveform, waveformArea.getX(), waveformArea.getY());
+}
+
+void ScrollingWaveform::push(const juce::AudioBuffer<float>& block)
+{
+    std::lock_guard<std::mutex> lock(overviewMutex);
+    overview.push(block);
+}
+
+void ScrollingWaveform::reset()
+{
+    std::lock_guard<std::mutex> lock(overviewMutex);
+    overview.clear();
+}
+
+void ScrollingWaveform::update()
+{
+    juce::Rectangle<int> area;
+    {
+        std::lock_guard<std::mutex> lock(waveformMutex);
+        area = waveformArea;
+    }
+    
+    int numColumns = area.getWidth();
+    if (numColumns <= 0)
+        return;
+    
+    TRACE_EVENT_BEGIN("component", "scrolling waveform update");
+    
+    double samplesPerColumn = seconds.load() * overview.getSampleRate() / numColumns;
+    
+    {
+        std::lock_guard<std::mutex> lock(overviewMutex);
+        
+        // The newest whole column ends at the right edge
+        auto lastColumn = static_cast<juce::int64>(overview.getNumWritten() / samplesPerColumn);
+        double startSample = (lastColumn - numColumns) * samplesPerColumn;
+        
+        for (int ch = 0; ch < WaveformOverview::numChannels; ++ch)
+            overview.getSpans(ch, startSample, samplesPerColumn, numColumns, spans[static_cast<size_t>(ch)]);
+    }
+    
+    renderWaveform();
+    
+    TRACE_EVENT_END("component");
+    
+    TRACE_EVENT_BEGIN("component", "ScrollingWaveformRepaint");
+    juce::MessageManager::getInstance()->callAsync( [this, area] { repaint(area); } );
+    TRACE_EVENT_END("component");
+}
+
+void ScrollingWaveform::renderWaveform()
+{
+    std::lock_guard<std::mutex> lock(waveformMutex);
+    
+    juce::Image::BitmapData pixels(waveform, juce::Image::BitmapData::writeOnly);
+    int laneHeight = pixels.height / WaveformOverview::numChannels;
+    
+    for (int y = 0; y < pixels.height; ++y)
+        std::memset(pixels.getLinePointer(y), 0, static_cast<size_t>(pixels.width * pixels.pixelStride));
+    
+    if (laneHeight < 2)
+        return;
+    
+    for (int ch = 0; ch < WaveformOverview::numChannels; ++ch)
+    {
+        const auto& laneSpans = spans[static_cast<size_t>(ch)];
+        int laneTop = ch * laneHeight;
+        int numColumns = juce::jmin(pixels.width, static_cast<int>(laneSpans.size()));
+        
+        auto toY = [laneTop, laneHeight](float sample)
+        {
+            return laneTop + juce::jlimit(0, laneHeight - 1, juce::roundToInt((1.f - sample) * 0.5f * (laneHeight - 1)));
+        };
+        
+        for (int x = 0; x < numColumns; ++x)
+        {
+            const auto& span = laneSpans[static_cast<size_t>(x)];
+            if (span.isEmpty())
+                continue;
+            
+            for (int y = toY(span.max), bottom = toY(span.min); y <= bottom; ++y)
+                *reinterpret_cast<juce::PixelARGB*>(pixels.getPixelPointer(x, y)) = waveformColour;
+        }
+    }
+}
+
+//==============================================================================
+//MARK: - Heatmap
+
+Heatmap::Heatmap(juce::ValueTree _vt, LevelHeatmap& _levels)
+    : vt(_vt),
+      processorLevels(_levels),
+      source(&_levels)
+{
+    buildColourLut();
+    
+    for (int level = 0; level < LevelHeatmap::numLevels; ++level)
+        zoomMenu.addItem(juce::String(LevelHeatmap::secondsPerColumn << level) + "s/px", level + 1);
+    zoomMenu.setTooltip("Heatmap time per column");
+    zoomMenu.onChange = [this] { vt.setProperty(IDs::heatmapZoom, zoomMenu.getSelectedId() - 1, nullptr); };
+    addAndMakeVisible(zoomMenu);
+    
+    vt.addListener(this);
+    zoomLevel = juce::jlimit(0, LevelHeatmap::numLevels - 1, static_cast<int>(vt.getProperty(IDs::heatmapZoom)));
+    zoomMenu.setSelectedId(zoomLevel.load() + 1, juce::dontSendNotification);
+}
+
+Heatmap::~Heatmap()
+{
+    vt.removeListener(this);
+}
+
+void Heatmap::valueTreePropertyChanged(juce::ValueTree& _vt, const juce::Identifier& _ID)
+{
+    if (SettingsBatch::isApplying())
+        return;
+    
+    if (_ID == IDs::heatmapZoom || _ID == IDs::settingsChanged)
+    {
+        zoomLevel = juce::jlimit(0, LevelHeatmap::numLevels - 1, static_cast<int>(_vt.getProperty(IDs::heatmapZoom)));
+        zoomMenu.setSelectedId(zoomLevel.load() + 1, juce::dontSendNotification);
+    }
+}
+
+void Heatmap::buildColourLut()
+{
+    juce::ColourGradient gradient(juce::Colours::black, 0.f, 0.f, juce::Colours::lightyellow, 1.f, 0.f, false);
+    gradient.addColour(0.25, juce::Colour(0xff3b0f70));
+    gradient.addColour(0.5,  juce::Colour(0xffb5367a));
+    gradient.addColour(0.75, juce::Colour(0xfffb8861));
+    
+    for (int i = 0; i < lutSize; ++i)
+        colourLut[static_cast<size_t>(i)] = gradient.getColourAtPosition(i / double(lutSize - 1)).getPixelARGB();
+}
+
+void Heatmap::resized()
+{
+    auto bounds = getLocalBounds();
+    
+    zoomMenu.setBounds(bounds.removeFromRight(menuWidth).withHeight(24));
+    
+    // update() reads the area under ringMutex too
+    std::lock_guard<std::mutex> lock(ringMutex);
+    heatmapArea = bounds.withTrimmedLeft(labelsWidth).withTrimmedRight(4);
+    
+    labelsImage = juce::Image(juce::Image::ARGB, labelsWidth, getHeight(), true);
+    juce::Graphics g(labelsImage);
+    buildLabelsImage(g);
+    
+    ring = juce::Image(juce::Image::ARGB, juce::jmax(1, heatmapArea.getWidth()), LevelHeatmap::numBins, true);
+    renderedLevel = -1;
+}
+
+void Heatmap::buildLabelsImage(juce::Graphics& g)
+{
+    g.setColour(juce::Colours::lightgrey);
+    g.setFont(10.f);
+    
+    int labelHeight = 12;
+    for (int db = static_cast<int>(MAX_DECIBELS); db > static_cast<int>(NEGATIVE_INFINITY); db -= 12)
+    {
+        int y = juce::roundToInt(juce::jmap(float(db), MAX_DECIBELS, NEGATIVE_INFINITY,
+                                            float(heatmapArea.getY()), float(heatmapArea.getBottom())));
+        y = juce::jlimit(0, labelsImage.getHeight() - labelHeight, y - labelHeight / 2);
+        g.drawFittedText(juce::String(db), 0, y, labelsWidth - 4, labelHeight, juce::Justification::centredRight, 1);
+    }
+}
+
+void Heatmap::paint(juce::Graphics& g)
+{
+    TRACE_COMPONENT();
+    
+    g.setColour(juce::Colours::black);
+    g.fillRect(heatmapArea);
+    g.drawImageAt(labelsImage, 0, 0);
+    
+    std::lock_guard<std::mutex> lock(ringMutex);
+    if (! ring.isValid())
+        return;
+    
+    // Ring columns up to the newest one go on the right, the older ones after it on the left
+    int width = ring.getWidth();
+    auto newestX = static_cast<int>(((renderedNewest % width) + width) % width);
+    int numNewer = newestX + 1;
+    int numOlder = width - numNewer;
+    
+    g.setImageResamplingQuality(juce::Graphics::lowResamplingQuality);
+    
+    if (numOlder > 0)
+        g.drawImage(ring,
+                    heatmapArea.getX(), heatmapArea.getY(), numOlder, heatmapArea.getHeight(),
+                    numNewer, 0, numOlder, LevelHeatmap::numBins);
+    
+    g.drawImage(ring,
+                heatmapArea.getX() + numOlder, heatmapArea.getY(), numNewer, heatmapArea.getHeight(),
+                0, 0, numNewer, LevelHeatmap::numBins);
+}
+
+void Heatmap::setSource(LevelHeatmap* levels)
+{
+    source = levels != nullptr ? levels : &processorLevels;
+    
+    // Redraw the whole width from the new source
+    std::lock_guard<std::mutex> lock(ringMutex);
+    renderedLevel = -1;
+}
+
+void Heatmap::update()
+{
+    auto& levels = *source.load();
+    int level = zoomLevel.load();
+    juce::int64 newest = levels.getNumColumns(level) - 1;
+    juce::Rectangle<int> area;
+    
+    {
+        std::lock_guard<std::mutex> lock(ringMutex);
+        if (! ring.isValid())
+            return;
+        
+        TRACE_EVENT_BEGIN("component", "heatmap update");
+        
+        area = heatmapArea;
+        int width = ring.getWidth();
+        
+        // Normally only the open column, plus the one before it if that closed since the last frame
+        juce::int64 firstColumn = renderedNewest;
+        if (level != renderedLevel || newest < renderedNewest || newest - renderedNewest >= width)
+            firstColumn = newest - width + 1;
+        
+        levels.getColumns(level, firstColumn, static_cast<int>(newest - firstColumn + 1), columns);
+        renderColumns(firstColumn);
+        
+        renderedLevel = level;
+        renderedNewest = newest;
+        
+        TRACE_EVENT_END("component");
+    }
+    
+    TRACE_EVENT_BEGIN("component", "HeatmapRepaint");
+    juce::MessageManager::getInstance()->callAsync( [this, area] { repaint(area); } );
+    TRACE_EVENT_END("component");
+}
+
+void Heatmap::renderColumns(juce::int64 firstColumn)
+{
+    juce::Image::BitmapData pixels(ring, juce::Image::BitmapData::writeOnly);
+    
+    for (size_t i = 0; i < columns.size(); ++i)
+    {
+        const auto& counts = columns[i];
+        auto x = static_cast<int>(((firstColumn + static_cast<juce::int64>(i)) % pixels.width + pixels.width) % pixels.width);
+        
+        // Relative to the samples the column holds so far, so the open column isn't dimmer than the rest
+        juce::uint32 total = std::accumulate(counts.begin(), counts.end(), juce::uint32(0));
+        float scale = total > 0 ? 1.f / total : 0.f;
+        
+        for (int bin = 0; bin < LevelHeatmap::numBins; ++bin)
+        {
+            float share = counts[static_cast<size_t>(bin)] * scale;
+            auto index = juce::jlimit(0, lutSize - 1, juce::roundToInt(std::sqrt(share) * (lutSize - 1)));
+            
+            // Loudest bin at the top
+            *reinterpret_cast<juce::PixelARGB*>(pixels.getPixelPointer(x, LevelHeatmap::numBins - 1 - bin)) = colourLut[static_cast<size_t>(index)];
+        }
+    }
+}
+
+//==============================================================================
+//MARK: - ThirdOctaveMeter
+
+ThirdOctaveMeter::ThirdOctaveMeter(juce::ValueTree _vt, double _sampleRate, const MeterClock& _clock)
+    : vt(_vt),
+      clock(_clock)
+{
+    prepare(_sampleRate);
+    
+    for (auto& level : levelsDb)
+        level = NEGATIVE_INFINITY;
+    frameLevelsDb.fill(NEGATIVE_INFINITY);
+    
+    lastDecayMs = clock.now();
+    
+    addAndMakeVisible(dbScale);
+    dbScale.setInterceptsMouseClicks(false, false);
+    
+    vt.addListener(this);
+    loadHoldSettings(vt);
+}
+
+ThirdOctaveMeter::~ThirdOctaveMeter()
+{
+    vt.removeListener(this);
+}
+
+void ThirdOctaveMeter::valueTreePropertyChanged(juce::ValueTree& _vt, const juce::Identifier& _ID)
+{
+    if (SettingsBatch::isApplying())
+        return;
+    
+    // Same hold and decay as every DecayingValueHolder
+    if (_ID == IDs::decayRate || _ID == IDs::peakHoldDuration || _ID == IDs::peakHoldInf || _ID == IDs::settingsChanged)
+        loadHoldSettings(_vt);
+}
+
+void ThirdOctaveMeter::loadHoldSettings(juce::ValueTree& tree)
+{
+    bool holdForInf = tree.getProperty(IDs::peakHoldInf);
+    int holdTimeMs = tree.getProperty(IDs::peakHoldDuration);
+    int decayRate = tree.getProperty(IDs::decayRate);
+    
+    std::lock_guard<std::mutex> lock(holdsMutex);
+    for (auto& hold : holds)
+    {
+        // Leaving infinite hold lets go of the held peaks
+        if (hold.isHoldingForInf() && ! holdForInf)
+            hold.reset();
+        
+        hold.setHoldForInf(holdForInf);
+        hold.setHoldTime(holdTimeMs);
+        hold.setDecayRate(static_cast<float>(decayRate));
+    }
+}
+
+void ThirdOctaveMeter::prepare(double _sampleRate)
+{
+    if (_sampleRate == sampleRate)
+        return;
+    
+    sampleRate = _sampleRate;
+    
+    std::lock_guard<std::mutex> lock(analyserMutex);
+    analyser.prepare(sampleRate);
+}
+
+void ThirdOctaveMeter::resized()
+{
+    auto bounds = getLocalBounds();
+    bounds.removeFromBottom(labelHeight);
+    
+    auto dbScaleArea = bounds.removeFromLeft(dbScaleWidth);
+    auto meterArea = dbScaleArea.withTrimmedTop(barsAreaTopBottomTrim).withTrimmedBottom(barsAreaTopBottomTrim);
+    
+    dbScale.setBounds(dbScaleArea);
+    dbScale.buildBackgroundImage(dbScaleDivision, meterArea, NEGATIVE_INFINITY, MAX_DECIBELS);
+    
+    dbScaleTicksY.clear();
+    for (Tick tick : DbScale::getTicks(dbScaleDivision, meterArea, NEGATIVE_INFINITY, MAX_DECIBELS))
+        dbScaleTicksY.push_back(tick.y);
+    
+    barsArea = bounds.withTrimmedTop(barsAreaTopBottomTrim).withTrimmedBottom(barsAreaTopBottomTrim);
+    
+    labelsImage = juce::Image(juce::Image::ARGB, getWidth(), getHeight(), true);
+    juce::Graphics g(labelsImage);
+    buildLabelsImage(g);
+}
+
+void ThirdOctaveMeter::buildLabelsImage(juce::Graphics& g)
+{
+    g.setColour(juce::Colours::white);
+    g.setFont(14.f);
+    g.drawText("RTA", barsArea.getX() + 4, barsArea.getY(), 40, 16, juce::Justification::centredLeft);
+    
+    // Octave centres only, from 31.5 Hz up
+    g.setFont(10.f);
+    float bandWidth = barsArea.getWidth() / float(numBands);
+    
+    for (int band = 2; band < numBands; band += 3)
+    {
+        float centreX = barsArea.getX() + (band + 0.5f) * bandWidth;
+        g.drawText(ThirdOctaveAnalyser::getBandLabel(band),
+                   juce::Rectangle<float>(centreX - 16.f, float(getHeight() - labelHeight), 32.f, float(labelHeight)),
+                   juce::Justification::centred);
+    }
+}
+
+void ThirdOctaveMeter::paint(juce::Graphics& g)
+{
+    TRACE_COMPONENT();
+    
+    g.setColour(juce::Colours::black);
+    g.fillRect(barsArea);
+    
+    g.setColour(juce::Colours::darkgrey.darker().darker());
+    for (int tickY : dbScaleTicksY)
+        g.fillRect(barsArea.getX(), tickY, barsArea.getWidth(), 1);
+    
+    auto toY = [this](float db)
+    {
+        return juce::jmap(juce::jlimit(NEGATIVE_INFINITY, MAX_DECIBELS, db),
+                          NEGATIVE_INFINITY, MAX_DECIBELS,
+                          float(barsArea.getBottom()), float(barsArea.getY()));
+    };
+    
+    float bandWidth = barsArea.getWidth() / float(numBands);
+    
+    for (int band = 0; band < numBands; ++band)
+    {
+        if (! analyser.isBandActive(band))
+            continue;
+        
+        auto index = static_cast<size_t>(band);
+        float left = barsArea.getX() + band * bandWidth + 1.f;
+        float width = juce::jmax(1.f, bandWidth - 2.f);
+        
+        float levelY = toY(levelsDb[index].load());
+        g.setColour(barColour);
+        g.fillRect(juce::Rectangle<float>(left, levelY, width, barsArea.getBottom() - levelY));
+        
+        float heldDb = holds[index].getHeldValue();
+        if (heldDb > NEGATIVE_INFINITY)
+        {
+            g.setColour(juce::Colours::white);
+            g.fillRect(juce::Rectangle<float>(left, juce::jmax(float(barsArea.getY()), toY(heldDb) - 1.f), width, 2.f));
+        }
+    }
+    
+    g.drawImageAt(labelsImage, 0, 0);
+}
+
+void ThirdOctaveMeter::push(const juce::AudioBuffer<float>& block)
+{
+    std::lock_guard<std::mutex> lock(analyserMutex);
+    analyser.process(block, 0, block.getNumSamples());
+}
+
+void ThirdOctaveMeter::resetAnalysis()
+{
+    std::lock_guard<std::mutex> lock(analyserMutex);
+    analyser.reset();
+}
+
+void ThirdOctaveMeter::update()
+{
+    TRACE_EVENT_BEGIN("component", "third octave meter update");
+    
+    {
+        std::lock_guard<std::mutex> lock(analyserMutex);
+        analyser.takeLevels(frameLevelsDb);
+    }
+    
+    {
+        std::lock_guard<std::mutex> lock(holdsMutex);
+        auto now = clock.now();
+        
+        for (size_t band = 0; band < frameLevelsDb.size(); ++band)
+        {
+            levelsDb[band] = frameLevelsDb[band];
+            holds[band].update(frameLevelsDb[band], now);
+        }
+    }
+    
+    decayHolds();
+    
+    TRACE_EVENT_END("component");
+    
+    TRACE_EVENT_BEGIN("component", "ThirdOctaveMeterRepaint");
+    juce::MessageManager::getInstance()->callAsync( [this] { repaint(); } );
+    TRACE_EVENT_END("component");
+}
+
+void ThirdOctaveMeter::resetHold()
+{
+    std::lock_guard<std::mutex> lock(holdsMutex);
+    for (auto& hold : holds)
+        hold.reset();
+}
+
+void ThirdOctaveMeter::tickBallistics()
+{
+    decayHolds();
+}
+
+void ThirdOctaveMeter::decayHolds()
+{
+    std::lock_guard<std::mutex> lock(holdsMutex);
+    
+    // A replay's clock can start behind the wall clock
+    auto now = clock.now();
+    auto elapsedMs = static_cast<float>(juce::jmax(juce::int64(0), now - lastDecayMs));
+    lastDecayMs = now;
+    
+    for (auto& hold : holds)
+        hold.decay(now, elapsedMs);
+}
+
+bool ThirdOctaveMeter::isSettled() const
+{
+    for (int band = 0; band < numBands; ++band)
+    {
+        auto index = static_cast<size_t>(band);
+        bool holdIsSettled = holds[index].isHoldingForInf() || holds[index].getHeldValue() <= NEGATIVE_INFINITY;
+        
+        if (levelsDb[index].load() > NEGATIVE_INFINITY || ! holdIsSettled)
+            return false;
+    }
+    
+    return true;
+}
+
+//==============================================================================
+//MARK: - PanSpectrumView
+
+PanSpectrumView::PanSpectrumView(juce::ValueTree _vt, StereoSpectrum& _spectrum, double _sampleRate)
+    : vt(_vt),
+      spectrum(_spectrum)
+{
+    prepare(_sampleRate);
+    spectrum.addListener(&panSpectrum);
+    
+    resolutionMenu.addItem("Linear", StereoSpectrum::RESOLUTION_LINEAR + 1);
+    resolutionMenu.addItem("Multi-res", StereoSpectrum::RESOLUTION_MULTI + 1);
+    resolutionMenu.setTooltip("Spectrum resolution: one linear FFT, or octave-decimated FFTs for the low end");
+    resolutionMenu.onChange = [this] { vt.setProperty(IDs::spectrumResolution, resolutionMenu.getSelectedId() - 1, nullptr); };
+    addAndMakeVisible(resolutionMenu);
+    
+    vt.addListener(this);
+    resolutionMenu.setSelectedId(static_cast<int>(vt.getProperty(IDs::spectrumResolution)) + 1, juce::dontSendNotification);
+}
+
+void PanSpectrumView::prepare(double sampleRate)
+{
+    panSpectrum.prepare(sampleRate / StereoSpectrum::hopSize);
+}
+
+PanSpectrumView::~PanSpectrumView()
+{
+    vt.removeListener(this);
+    spectrum.removeListener(&panSpectrum);
+}
+
+void PanSpectrumView::valueTreePropertyChanged(juce::ValueTree& _vt, const juce::Identifier& _ID)
+{
+    if (SettingsBatch::isApplying())
+        return;
+    
+    if (_ID == IDs::spectrumResolution || _ID == IDs::settingsChanged)
+        resolutionMenu.setSelectedId(static_cast<int>(_vt.getProperty(IDs::spectrumResolution)) + 1, juce::dontSendNotification);
+}
+
+void PanSpectrumView::resized()
+{
+    auto bounds = getLocalBounds();
+    
+    resolutionMenu.setBounds(bounds.removeFromRight(menuWidth).withHeight(24));
+    plotArea = bounds.withTrimmedLeft(panLabelsWidth).withTrimmedBottom(frequencyLabelsHeight).withTrimmedRight(4);
+    
+    labelsImage = juce::Image(juce::Image::ARGB, getWidth(), getHeight(), true);
+    juce::Graphics g(labelsImage);
+    buildLabelsImage(g);
+    
+    std::lock_guard<std::mutex> lock(gridMutex);
+    if (! grid.isValid())
+        grid = juce::Image(juce::Image::ARGB, PanSpectrum::numColumns, PanSpectrum::numRows, true);
+}
+
+void PanSpectrumView::buildLabelsImage(juce::Graphics& g)
+{
+    g.setColour(juce::Colours::lightgrey);
+    g.setFont(10.f);
+    
+    g.drawText("L", 0, plotArea.getY(), panLabelsWidth, 12, juce::Justification::centred);
+    g.drawText("C", 0, plotArea.getCentreY() - 6, panLabelsWidth, 12, juce::Justification::centred);
+    g.drawText("R", 0, plotArea.getBottom() - 12, panLabelsWidth, 12, juce::Justification::centred);
+    
+    auto logRange = std::log(PanSpectrum::maxFrequency / PanSpectrum::minFrequency);
+    for (auto [frequency, text] : { std::make_pair(100.f, "100"), std::make_pair(1000.f, "1k"), std::make_pair(10000.f, "10k") })
+    {
+        float x = plotArea.getX() + std::log(frequency / PanSpectrum::minFrequency) / logRange * plotArea.getWidth();
+        g.drawText(text, juce::Rectangle<float>(x - 16.f, float(plotArea.getBottom()), 32.f, float(frequencyLabelsHeight)),
+                   juce::Justification::centred);
+    }
+    
+    g.setColour(juce::Colours::white);
+    g.setFont(14.f);
+    g.drawText("Pan", plotArea.getX() + 4, plotArea.getY(), 40, 16, juce::Justification::centredLeft);
+}
+
+void PanSpectrumView::paint(juce::Graphics& g)
+{
+    TRACE_COMPONENT();
+    
+    g.setColour(juce::Colours::black);
+    g.fillRect(plotArea);
+    
+    {
+        std::lock_guard<std::mutex> lock(gridMutex);
+        if (grid.isValid())
+        {
+            g.setImageResamplingQuality(juce::Graphics::lowResamplingQuality);
+            g.drawImage(grid, plotArea.toFloat());
+        }
+    }
+    
+    // Centre line
+    g.setColour(juce::Colours::darkgrey.withAlpha(0.6f));
+    g.fillRect(plotArea.getX(), plotArea.getCentreY(), plotArea.getWidth(), 1);
+    
+    g.drawImageAt(labelsImage, 0, 0);
+}
+
+void PanSpectrumView::update()
+{
+    TRACE_EVENT_BEGIN("component", "pan spectrum update");
+    
+    panSpectrum.getGrid(cells, columnLevelsDb);
+    renderGrid();
+    
+    TRACE_EVENT_END("component");
+    
+    TRACE_EVENT_BEGIN("component", "PanSpectrumRepaint");
+    juce::MessageManager::getInstance()->callAsync( [this] { repaint(); } );
+    TRACE_EVENT_END("component");
+}
+
+void PanSpectrumView::renderGrid()
+{
+    std::lock_guard<std::mutex> lock(gridMutex);
+    if (! grid.isValid())
+        return;
+    
+    juce::Image::BitmapData pixels(grid, juce::Image::BitmapData::writeOnly);
+    
+    for (int row = 0; row < PanSpectrum::numRows; ++row)
+    {
+        for (int column = 0; column < PanSpectrum::numColumns; ++column)
+        {
+            const auto& cell = cells[static_cast<size_t>(row * PanSpectrum::numColumns + column)];
+            
+            // Columns below the meters' floor stay dark, however their energy is spread
+            float brightness = columnLevelsDb[static_cast<size_t>(column)] > NEGATIVE_INFINITY ? std::sqrt(cell.share) : 0.f;
+            float hue = juce::jmap(juce::jlimit(-1.f, 1.f, cell.correlation), -1.f, 1.f, 0.f, 0.33f);
+            
+            pixels.setPixelColour(column, row, juce::Colour::fromHSV(hue, 0.9f, brightness, 1.f));
+        }
+    }
+}
+
+//==============================================================================
+//==============================================================================
+//MARK: - PFM10AudioProcessorEditor
+
+PFM10AudioProcessorEditor::PFM10AudioProcessorEditor (PFM10AudioProcessor& p)
+    : AudioProcessorEditor (&p),
+      audioProcessor (p),
+      valueTree(p.valueTree),
+      editorAudioBuffer(2, 512),
+      background(juce::ImageFileFormat::loadFrom(BinaryData::plugin_bg_half_png, BinaryData::plugin_bg_half_pngSize)),
+      peakStereoMeter(valueTree, juce::String("Peak"), meterClock),
+      peakHistogram(valueTree, juce::String("Peak")),
+      stereoImageMeter(valueTree, editorAudioBuffer, audioProcessor.getSampleRate(), meterClock),
+      oscilloscope(valueTree, audioProcessor.getSampleRate()),
+      dynamicsMeter(valueTree, audioProcessor.getSampleRate(), meterClock),
+      scrollingWaveform(valueTree, audioProcessor.getSampleRate()),
+      heatmap(valueTree, p.levelHeatmap),
+      thirdOctaveMeter(valueTree, audioProcessor.getSampleRate(), meterClock),
+      panSpectrumView(valueTree, stereoSpectrum, audioProcessor.getSampleRate())
+{
+    setSize (pluginWidth, pluginHeight);
+    
+    //setResizable(true, true);
+    //setResizeLimits(600, 600,    //min
+    //                900, 900);  //max
+    
+    addAndMakeVisible(peakStereoMeter);
+    addAndMakeVisible(lowEndMeter);
+    addAndMakeVisible(peakHistogram);
+    addAndMakeVisible(stereoImageMeter);
+    addAndMakeVisible(oscilloscope);
+    addAndMakeVisible(dynamicsMeter);
+    addAndMakeVisible(scrollingWaveform);
+    addAndMakeVisible(heatmap);
+    addAndMakeVisible(thirdOctaveMeter);
+    addAndMakeVisible(panSpectrumView);
+    
+    initMenus();
+    valueTree.addListener(this);
+    
+    // Pick up where the saved session left off
+    peakHistogram.restore(audioProcessor.analysisHistory.getLevels());
+    peakHistogram.onClear = [this]
+    {
+        audioProcessor.analysisHistory.clearLevels();
+        audioProcessor.levelHeatmap.clear();
+    };
+    
+    if (valueTree.getProperty(IDs::peakHoldInf))
+    {
+        auto peaks = audioProcessor.analysisHistory.getPeaks();
+        peakStereoMeter.update(peaks[0], peaks[1]);
+    }
+    
+    historySampleRate = audioProcessor.getSampleRate();
+    noiseFloor.prepare(historySampleRate);
+    setSpectrumResolution(valueTree.getProperty(IDs::spectrumResolution));
+    
+    lastBlockTimeMs = settledSinceMs = juce::Time::getMillisecondCounter();
+    // Peaks from before the editor opened aren't for this display
+    audioProcessor.peakTracker.takePeakLevels();
+    
+    // Nor is anything the ring held from a previous editor
+    audioProcessor.historyRing.discardAll();
+    audioProcessor.editorIsOpen = true;
+    
+    startTimerHz(refreshRateHz);
+    
+    updateThread.fn = std::function<void()>( [this] { update(); } );
+    updateThread.startThread();
+    
+#if EDITOR_INPUT_CAPTURE
+    auto replayPath = juce::SystemStats::getEnvironmentVariable("PFM10_REPLAY_CAPTURE", {});
+    
+    if (replayPath.isNotEmpty())
+        startReplay(juce::File(replayPath));
+    else
+        inputCapture.start(audioProcessor.createLogFile("PFM10", ".pfmcap"),
+                           audioProcessor.getSampleRate());
+#endif
+}
+
+PFM10AudioProcessorEditor::~PFM10AudioProcessorEditor()
+{
+    // update() reaches members declared after updateThread, which go first
+    updateThread.stopThread(2000);
+    
+    audioProcessor.editorIsOpen = false;
+    audioProcessor.activityMonitor.cancelWake();
+    audioProcessor.renderReportBroadcaster.removeChangeListener(this);
+    valueTree.removeListener(this);
+}
+
+void PFM10AudioProcessorEditor::initMenus()
+{
+    // Decay Rate Menu
+    
+    decayRateMenuLabel.setJustificationType(juce::Justification::centred);
+    decayRateMenuLabel.setBufferedToImage(true);
+    addAndMakeVisible(decayRateMenuLabel);
+    
+    decayRateMenu.addItem("-3dB/s",  DB_PER_SEC_3);
+    decayRateMenu.addItem("-6dB/s",  DB_PER_SEC_6);
+    decayRateMenu.addItem("-12dB/s", DB_PER_SEC_12);
+    decayRateMenu.addItem("-24dB/s", DB_PER_SEC_24);
+    decayRateMenu.addItem("-36dB/s", DB_PER_SEC_36);
+    decayRateMenu.setTooltip("Peak Marker Decay Rate");
+    decayRateMenu.onChange = [this] { onDecayRateMenuChanged(); };
+    decayRateMenu.setSelectedId( decayRateMenuSelectByValue(valueTree.getProperty(IDs::decayRate)) );
+    decayRateMenu.setBufferedToImage(true);
+    addAndMakeVisible(decayRateMenu);
+    
+    // Averager Duration Menu
+    
+    averagerDurationMenuLabel.setJustificationType(juce::Justification::centred);
+    averagerDurationMenuLabel.setBufferedToImage(true);
+    addAndMakeVisible(averagerDurationMenuLabel);
+
+    averagerDurationMenu.addItem("100ms",  AVERAGER_DURATION_MS_100);
+    averagerDurationMenu.addItem("250ms",  AVERAGER_DURATION_MS_250);
+    averagerDurationMenu.addItem("500ms",  AVERAGER_DURATION_MS_500);
+    averagerDurationMenu.addItem("1000ms", AVERAGER_DURATION_MS_1000);
+    averagerDurationMenu.addItem("2000ms", AVERAGER_DURATION_MS_2000);
+    averagerDurationMenu.setTooltip("Averaging duration for RMS meters");
+    averagerDurationMenu.onChange = [this] { onAveragerDurationMenuChanged(); };
+    averagerDurationMenu.setSelectedId( averagerDurationMenuSelectByValue(valueTree.getProperty(IDs::averagerIntervals)) );
+    averagerDurationMenu.setBufferedToImage(true);
+    addAndMakeVisible(averagerDurationMenu);
+    
+    // Peak Hold Duration Menu
+    
+    peakHoldDurationMenuLabel.setJustificationType(juce::Justification::centred);
+    peakHoldDurationMenuLabel.setBufferedToImage(true);
+    addAndMakeVisible(peakHoldDurationMenuLabel);
+
+    peakHoldDurationMenu.addItem("0s",   PEAK_HOLD_DURATION_MS_0);
+    peakHoldDurationMenu.addItem("0.5s", PEAK_HOLD_DURATION_MS_500);
+    peakHoldDurationMenu.addItem("2s",   PEAK_HOLD_DURATION_MS_2000);
+    peakHoldDurationMenu.addItem("4s",   PEAK_HOLD_DURATION_MS_4000);
+    peakHoldDurationMenu.addItem("6s",   PEAK_HOLD_DURATION_MS_6000);
     peakHoldDurationMenu.addItem("inf",  PEAK_HOLD_DURATION_MS_INF);
     peakHoldDurationMenu.setTooltip("Peak hold duration for meters");
     peakHoldDurationMenu.onChange = [this] { onPeakHoldDurationMenuChanged(); };
@@ -1648,6 +3360,39 @@ void PFM10AudioProcessorEditor::initMenus()
     peakHoldResetButton.setBufferedToImage(true);
     addAndMakeVisible(peakHoldResetButton);
     
+    // Meter Log Button
+    
+    meterLogButton.setButtonText("Record Log");
+    meterLogButton.setClickingTogglesState(true);
+    meterLogButton.setToggleState(audioProcessor.isMeterLogActive(), juce::dontSendNotification);
+    meterLogButton.setColour(juce::TextButton::buttonOnColourId, juce::Colours::red.darker());
+    meterLogButton.setTooltip("Record meter readings to a session log file");
+    meterLogButton.onClick = [this] { onMeterLogButtonClicked(); };
+    addAndMakeVisible(meterLogButton);
+    
+    // View Log Button
+    
+    viewLogButton.setButtonText("View Log...");
+    viewLogButton.setTooltip("Browse a recorded session log in the histogram");
+    viewLogButton.onClick = [this] { onViewLogButtonClicked(); };
+    addAndMakeVisible(viewLogButton);
+    
+    // Render Report Button
+    
+    renderReportButton.setButtonText("Render Reports");
+    renderReportButton.setClickingTogglesState(true);
+    renderReportButton.onClick = [this] { valueTree.setProperty(IDs::renderReports, renderReportButton.getToggleState(), nullptr); };
+    updateRenderReportButton();
+    addAndMakeVisible(renderReportButton);
+    audioProcessor.renderReportBroadcaster.addChangeListener(this);
+    
+    // Overview Button
+    
+    overviewButton.setButtonText("Overview");
+    overviewButton.setTooltip("Show the meters of every PFM10 instance in one window");
+    overviewButton.onClick = [this] { OverviewWindow::show(audioProcessor.getInstanceRegistry()); };
+    addAndMakeVisible(overviewButton);
+    
     // Goniometer Scale Rotary Slider
     
     goniometerScaleRotarySliderLabel.setJustificationType(juce::Justification::centred);
@@ -1779,9 +3524,139 @@ void PFM10AudioProcessorEditor::onPeakHoldDurationMenuChanged()
     }
 }
 
+void PFM10AudioProcessorEditor::valueTreePropertyChanged(__attribute__((unused)) juce::ValueTree& _vt, const juce::Identifier& _ID)
+{
+    if (SettingsBatch::isApplying())
+        return;
+    
+    if (_ID == IDs::decayRate       || _ID == IDs::averagerIntervals || _ID == IDs::peakHoldEnabled ||
+        _ID == IDs::peakHoldInf     || _ID == IDs::peakHoldDuration  || _ID == IDs::settingsChanged)
+    {
+        // The hold time arrives as up to three property changes, let them all land first
+        juce::MessageManager::callAsync( [safeThis = juce::Component::SafePointer<PFM10AudioProcessorEditor>(this)]
+        {
+            if (safeThis != nullptr)
+                safeThis->refreshMenus();
+        });
+    }
+    
+    if (_ID == IDs::spectrumResolution || _ID == IDs::settingsChanged)
+        setSpectrumResolution(valueTree.getProperty(IDs::spectrumResolution));
+    
+    if (_ID == IDs::renderReports || _ID == IDs::settingsChanged)
+        updateRenderReportButton();
+}
+
+void PFM10AudioProcessorEditor::setSpectrumResolution(int resolution)
+{
+    resolution = juce::jlimit(int(StereoSpectrum::RESOLUTION_LINEAR), int(StereoSpectrum::RESOLUTION_MULTI), resolution);
+    
+    // The plans are cached per sample rate, so switching back and forth costs no redesign
+    std::lock_guard<std::mutex> lock(bufferMutex);
+    stereoSpectrum.prepare(audioProcessor.getSampleRate(), resolution);
+}
+
+void PFM10AudioProcessorEditor::refreshMenus()
+{
+    decayRateMenu.setSelectedId( decayRateMenuSelectByValue(valueTree.getProperty(IDs::decayRate)), juce::dontSendNotification );
+    averagerDurationMenu.setSelectedId( averagerDurationMenuSelectByValue(valueTree.getProperty(IDs::averagerIntervals)), juce::dontSendNotification );
+    peakHoldDurationMenu.setSelectedId( peakHoldDurationMenuSelectByValueTree(valueTree), juce::dontSendNotification );
+    peakHoldResetButton.setVisible( valueTree.getProperty(IDs::peakHoldInf) );
+}
+
 void PFM10AudioProcessorEditor::onPeakHoldResetButtonClicked()
 {
+    // The meters only repaint while running
+    wake();
+    
     peakStereoMeter.resetHold();
+    stereoImageMeter.resetHold();
+    thirdOctaveMeter.resetHold();
+    dynamicsMeter.resetHold();
+    audioProcessor.analysisHistory.resetPeaks();
+}
+
+void PFM10AudioProcessorEditor::onMeterLogButtonClicked()
+{
+    if (meterLogButton.getToggleState())
+    {
+        if (! audioProcessor.startMeterLog(audioProcessor.createLogFile("PFM10", ".pfmlog")))
+            meterLogButton.setToggleState(false, juce::dontSendNotification);
+    }
+    else
+    {
+        audioProcessor.stopMeterLog();
+    }
+}
+
+void PFM10AudioProcessorEditor::onViewLogButtonClicked()
+{
+    if (logReader != nullptr)
+    {
+        showLog({});
+        return;
+    }
+    
+    auto initialLocation = audioProcessor.isMeterLogActive() ? audioProcessor.getMeterLogFile()
+                                                             : PFM10AudioProcessor::getLogsFolder();
+    
+    logFileChooser = std::make_unique<juce::FileChooser>("Open Meter Log", initialLocation, "*.pfmlog");
+    logFileChooser->launchAsync(juce::FileBrowserComponent::openMode | juce::FileBrowserComponent::canSelectFiles,
+                                [this] (const juce::FileChooser& chooser) { showLog(chooser.getResult()); });
+}
+
+void PFM10AudioProcessorEditor::showLog(const juce::File& file)
+{
+    peakHistogram.setLogReader(nullptr);
+    logReader.reset();
+    
+    if (file.existsAsFile())
+    {
+        logReader = std::make_unique<MeterLogReader>(file);
+        
+        if (logReader->openedOk())
+        {
+            peakHistogram.setLogReader(logReader.get());
+        }
+        else
+        {
+            logReader.reset();
+            juce::AlertWindow::showMessageBoxAsync(juce::MessageBoxIconType::WarningIcon,
+                                                   "Open Meter Log",
+                                                   file.getFileName() + " is not a PFM10 meter log.");
+        }
+    }
+    
+    viewLogButton.setButtonText(logReader != nullptr ? "Live View" : "View Log...");
+}
+
+void PFM10AudioProcessorEditor::updateRenderReportButton()
+{
+    renderReportButton.setToggleState(valueTree.getProperty(IDs::renderReports), juce::dontSendNotification);
+    
+    juce::String tooltip = "Write a full-resolution meter log and a JSON report for every offline bounce";
+    
+    auto lastReport = audioProcessor.getLastRenderReport();
+    if (lastReport != juce::File())
+        tooltip << "\nLast report: " << lastReport.getFullPathName();
+    
+    renderReportButton.setTooltip(tooltip);
+}
+
+void PFM10AudioProcessorEditor::changeListenerCallback(juce::ChangeBroadcaster*)
+{
+    updateRenderReportButton();
+    
+    auto reportFile = audioProcessor.getLastRenderReport();
+    
+    if (reportFile.existsAsFile())
+        juce::AlertWindow::showMessageBoxAsync(juce::MessageBoxIconType::InfoIcon,
+                                               "Render Report",
+                                               "The offline render report was written to\n" + reportFile.getFullPathName());
+    else
+        juce::AlertWindow::showMessageBoxAsync(juce::MessageBoxIconType::WarningIcon,
+                                               "Render Report",
+                                               "The offline render report couldn't be written to\n" + reportFile.getFullPathName());
 }
 
 void PFM10AudioProcessorEditor::paint (juce::Graphics& g)
@@ -1799,18 +3674,50 @@ void PFM10AudioProcessorEditor::paint (juce::Graphics& g)
 void PFM10AudioProcessorEditor::resized()
 {
     auto bounds = getLocalBounds().reduced(10);
+    
+    // Waveform overview, level heatmap and pan spectrum share the bottom strip
+    auto bottomStrip = bounds.removeFromBottom(scrollingWaveformHeight);
+    int paneWidth = (bottomStrip.getWidth() - 20) / 3;
+    scrollingWaveform.setBounds(bottomStrip.removeFromLeft(paneWidth));
+    bottomStrip.removeFromLeft(10);
+    heatmap.setBounds(bottomStrip.removeFromLeft(paneWidth));
+    bottomStrip.removeFromLeft(10);
+    panSpectrumView.setBounds(bottomStrip);
+    bounds.removeFromBottom(10);
+    
     auto width = bounds.getWidth();
     auto height = bounds.getHeight();
 
+    int topHeight = height * 2/3;
+    
     peakStereoMeter.setTopLeftPosition(bounds.getX(), bounds.getY());
-    peakStereoMeter.setSize(120, height * 2/3);
+    peakStereoMeter.setSize(120, topHeight - lowEndMeterHeight);
+    
+    lowEndMeter.setBounds(peakStereoMeter.getX(),
+                          peakStereoMeter.getBottom(),
+                          peakStereoMeter.getWidth(),
+                          lowEndMeterHeight);
     
     stereoImageMeter.setBounds(peakStereoMeter.getRight(),
                                bounds.getY(),
-                               width - peakStereoMeter.getRight(),
-                               peakStereoMeter.getHeight());
+                               width - peakStereoMeter.getRight() - oscilloscopeWidth,
+                               topHeight);
+    
+    oscilloscope.setBounds(stereoImageMeter.getRight(),
+                           bounds.getY(),
+                           bounds.getRight() - stereoImageMeter.getRight(),
+                           topHeight - dynamicsMeterHeight);
     
-    peakHistogram.setBounds(bounds.withTop(peakStereoMeter.getBottom()));
+    dynamicsMeter.setBounds(oscilloscope.getX() + 4,
+                            oscilloscope.getBottom(),
+                            oscilloscope.getWidth() - 4,
+                            dynamicsMeterHeight);
+    
+    // The RTA sits to the right of the histogram
+    auto histogramRow = bounds.withTop(lowEndMeter.getBottom());
+    thirdOctaveMeter.setBounds(histogramRow.removeFromRight(thirdOctaveMeterWidth));
+    histogramRow.removeFromRight(10);
+    peakHistogram.setBounds(histogramRow);
     
     // Menus
     int menuWidth = 100;
@@ -1851,6 +3758,21 @@ void PFM10AudioProcessorEditor::resized()
                                   menuWidth,
                                   menuHeight);
     
+    meterLogButton.setBounds(menuX,
+                             peakHoldResetButton.getBottom() + verticalSpaceBetweenMenus,
+                             menuWidth,
+                             menuHeight);
+    
+    viewLogButton.setBounds(menuX,
+                            meterLogButton.getBottom() + verticalSpaceBetweenMenus,
+                            menuWidth,
+                            menuHeight);
+    
+    renderReportButton.setBounds(menuX,
+                                 viewLogButton.getBottom() + verticalSpaceBetweenMenus,
+                                 menuWidth,
+                                 menuHeight);
+    
     goniometerScaleRotarySliderLabel.setBounds(stereoImageMeter.getRight() - goniometerScaleRotarySliderSize,
                                                stereoImageMeter.getY(),
                                                goniometerScaleRotarySliderSize,
@@ -1859,38 +3781,363 @@ void PFM10AudioProcessorEditor::resized()
                                           goniometerScaleRotarySliderLabel.getBottom(),
                                           goniometerScaleRotarySliderSize,
                                           goniometerScaleRotarySliderSize);
+    
+    overviewButton.setBounds(stereoImageMeter.getRight() - menuWidth,
+                             goniometerScaleRotarySlider.getBottom() + verticalSpaceBetweenMenus,
+                             menuWidth,
+                             menuHeight);
 }
 
 void PFM10AudioProcessorEditor::timerCallback()
 {
     TRACE_COMPONENT();
     
+    if (replayReader != nullptr)
+    {
+        replayStep();
+        return;
+    }
+    
     if(audioProcessor.audioBufferFifo.getNumAvailableForReading() > 0)
     {
         bufferMutex.lock();
         
-        // Pull every element out of the audio buffer FIFO into the editor audio buffer
+        // Pull every element out of the audio buffer FIFO into the editor audio buffer.
+        // Only the latest block matters to the goniometer and correlation meter.
         while( audioProcessor.audioBufferFifo.pull(editorAudioBuffer) )
         {
         }
         
         bufferMutex.unlock();
         
-        // Get the left channel's peak magnitude within the editor audio buffer
-        float magLeftChannel = editorAudioBuffer.getMagnitude(0, 0, editorAudioBuffer.getNumSamples());
-        dbLeftChannel = juce::Decibels::gainToDecibels(magLeftChannel, NEGATIVE_INFINITY);
-        
-        // Get the right channel's peak magnitude within the editor audio buffer
-        float magRightChannel = editorAudioBuffer.getMagnitude(1, 0, editorAudioBuffer.getNumSamples());
-        dbRightChannel = juce::Decibels::gainToDecibels(magRightChannel, NEGATIVE_INFINITY);
+        // The processor saw every sample, the editor buffer only holds the last block pulled
+        auto peakLevels = audioProcessor.peakTracker.takePeakLevels();
+        auto lowEndLevels = audioProcessor.peakTracker.getLowEndLevels();
+        setPeakLevels(peakLevels);
+        lowEndMeter.setLevels(lowEndLevels);
         
-        // Get the mono level (avg. of left and right channels)
-        float magPeakMono = (magLeftChannel + magRightChannel) / 2;
-        dbPeakMono = juce::Decibels::gainToDecibels(magPeakMono, NEGATIVE_INFINITY);
+        // Only this thread writes editorAudioBuffer, so it can be read without the lock
+        inputCapture.writeDrain(editorAudioBuffer, peakLevels, lowEndLevels);
         
-        // Update the components with the newly retrieved audio data on a separate thread
+        // Update the components with the newly retrieved audio data on a separate thread,
+        // which also feeds the histories from the ring
         updateThread.notify();
+        
+        lastBlockTimeMs = juce::Time::getMillisecondCounter();
+    }
+    else if (haveBlocksStopped())
+    {
+        feedSilence();
+    }
+    
+    updateParking();
+}
+
+void PFM10AudioProcessorEditor::prepareHistories(double sampleRate)
+{
+    historySampleRate = sampleRate;
+    
+    oscilloscope.prepare(sampleRate);
+    dynamicsMeter.prepare(sampleRate);
+    scrollingWaveform.prepare(sampleRate);
+    thirdOctaveMeter.prepare(sampleRate);
+    
+    {
+        const std::lock_guard<std::mutex> lock(bufferMutex);
+        stereoSpectrum.prepare(sampleRate, stereoSpectrum.getResolution());
+        noiseFloor.prepare(sampleRate);
+        stereoImageMeter.prepare(sampleRate);
+    }
+    
+    panSpectrumView.prepare(sampleRate);
+}
+
+void PFM10AudioProcessorEditor::drainHistoryRing()
+{
+    for (;;)
+    {
+        auto result = audioProcessor.historyRing.read(historyBuffer);
+        
+        // Refers to historyBuffer's channels, no copy
+        juce::AudioBuffer<float> chunk(historyBuffer.getArrayOfWritePointers(), AudioSampleRing::numChannels, result.numSamples);
+        
+        if (result.followsGap || result.numSamples > 0)
+            inputCapture.writeChunk(chunk, result.followsGap);
+        
+        // Blocks were dropped: start over rather than join the audio on either side of the hole
+        if (result.followsGap)
+            resetHistories();
+        
+        if (result.numSamples == 0)
+            break;
+        
+        pushToHistories(chunk);
+    }
+}
+
+void PFM10AudioProcessorEditor::pushToHistories(const juce::AudioBuffer<float>& block)
+{
+    oscilloscope.push(block);
+    dynamicsMeter.push(block);
+    scrollingWaveform.push(block);
+    thirdOctaveMeter.push(block);
+    
+    const std::lock_guard<std::mutex> lock(bufferMutex);
+    stereoSpectrum.push(block, 0, block.getNumSamples());
+    noiseFloor.process(block, 0, block.getNumSamples());
+}
+
+void PFM10AudioProcessorEditor::resetHistories()
+{
+    oscilloscope.reset();
+    dynamicsMeter.reset();
+    scrollingWaveform.reset();
+    thirdOctaveMeter.resetAnalysis();
+    
+    const std::lock_guard<std::mutex> lock(bufferMutex);
+    stereoSpectrum.reset();
+    noiseFloor.reset();
+}
+
+bool PFM10AudioProcessorEditor::haveBlocksStopped() const
+{
+    // Some hosts stop calling processBlock altogether when the transport stops
+    return juce::Time::getMillisecondCounter() - lastBlockTimeMs > static_cast<juce::uint32>(ActivityMonitor::idleDelayMs);
+}
+
+void PFM10AudioProcessorEditor::feedSilence()
+{
+    // With no blocks the levels would stay wherever the last one left them and
+    // never settle. Fall the way they would if the host sent silent blocks.
+    bufferMutex.lock();
+    editorAudioBuffer.clear();
+    bufferMutex.unlock();
+    
+    silencePending = true;
+    setPeakLevels( PeakLevels() );
+    updateThread.notify();
+}
+
+void PFM10AudioProcessorEditor::updateParking()
+{
+    auto nowMs = juce::Time::getMillisecondCounter();
+    
+    bool isIdle = audioProcessor.activityMonitor.isIdle() || haveBlocksStopped();
+    
+    // Let the peak holds and decays run out first, so the parked display is the final one
+    if (! isIdle || ! peakStereoMeter.isSettled() || ! stereoImageMeter.isSettled() || ! thirdOctaveMeter.isSettled()
+        || ! dynamicsMeter.isSettled())
+    {
+        settledSinceMs = nowMs;
+        return;
+    }
+    
+    if (nowMs - settledSinceMs >= parkDelayMs)
+        park();
+}
+
+void PFM10AudioProcessorEditor::park()
+{
+    TRACE_COMPONENT();
+    
+    parked = true;
+    
+    stopTimer();
+    peakStereoMeter.setBallisticsRunning(false);
+    stereoImageMeter.setBallisticsRunning(false);
+    dynamicsMeter.setBallisticsRunning(false);
+    
+    // From here the processor stops pushing, so whatever is queued would be stale on wake
+    audioProcessor.activityMonitor.wakeOnActivity( [this] { wake(); } );
+    
+    bufferMutex.lock();
+    while (audioProcessor.audioBufferFifo.pull(editorAudioBuffer))
+    {
+    }
+    bufferMutex.unlock();
+    
+    audioProcessor.historyRing.discardAll();
+}
+
+void PFM10AudioProcessorEditor::wake()
+{
+    TRACE_COMPONENT();
+    
+    if (! parked)
+        return;
+    
+    parked = false;
+    audioProcessor.activityMonitor.cancelWake();
+    
+    lastBlockTimeMs = settledSinceMs = juce::Time::getMillisecondCounter();
+    peakStereoMeter.setBallisticsRunning(true);
+    stereoImageMeter.setBallisticsRunning(true);
+    dynamicsMeter.setBallisticsRunning(true);
+    startTimerHz(refreshRateHz);
+    
+    // The block that woke us is already in the FIFO
+    timerCallback();
+}
+
+void PFM10AudioProcessorEditor::setPeakLevels(const PeakLevels& peakLevels)
+{
+    dbLeftChannel  = peakLevels.dbLeft;
+    dbRightChannel = peakLevels.dbRight;
+    dbPeakMono     = peakLevels.dbMono;
+}
+
+bool PFM10AudioProcessorEditor::startReplay(const juce::File& captureFile)
+{
+    auto reader = std::make_unique<InputCaptureReader>(captureFile);
+    
+    if (! reader->openedOk())
+        return false;
+    
+    // Don't record the replay over a capture
+    inputCapture.stop();
+    
+    // The replay feeds the histories and calls update() itself. Join the update thread
+    // first, so nothing it is still doing for a live notify overlaps the replay's clock.
+    updateThread.stopThread(2000);
+    wake();
+    
+    auto sampleRate = reader->getHeader().sampleRate;
+    
+    replayReader = std::move(reader);
+    replayFile = captureFile;
+    replayTimeMs = 0;
+    replayTickTimeMs = 0;
+    replayNumDrains = 0;
+    replayStartTimeMs = juce::Time::getMillisecondCounterHiRes();
+    
+    replayHeatmap.prepare(sampleRate);
+    replayHeatmap.clear();
+    heatmap.setSource(&replayHeatmap);
+    
+    // At the capture's rate, whatever the host runs at now
+    prepareHistories(sampleRate);
+    resetHistories();
+    
+    meterClock.setReplayTime(0);
+    peakStereoMeter.resetHold();
+    stereoImageMeter.resetHold();
+    thirdOctaveMeter.resetHold();
+    dynamicsMeter.resetHold();
+    
+    return true;
+}
+
+void PFM10AudioProcessorEditor::replayStep()
+{
+    TRACE_COMPONENT();
+    
+    auto stepStartMs = juce::Time::getMillisecondCounterHiRes();
+    
+    // The update thread is stopped for the whole replay, so everything runs here on the
+    // message thread, in the order the capture recorded it from the two threads
+    while (juce::Time::getMillisecondCounterHiRes() - stepStartMs < replayBudgetMs)
+    {
+        if (! replayReader->readNext(replayRecord))
+        {
+            finishReplay();
+            return;
+        }
+        
+        if (replayRecord.tag == InputCaptureWriter::drainTag)
+        {
+            advanceReplayClock(replayRecord.timeMs);
+            
+            // The capture holds what the editor read from the ring. Keep the real
+            // one empty so the host's audio isn't counted as dropped.
+            audioProcessor.historyRing.discardAll();
+            
+            bufferMutex.lock();
+            editorAudioBuffer = replayRecord.block;
+            bufferMutex.unlock();
+            
+            setPeakLevels(replayRecord.peakLevels);
+            lowEndMeter.setLevels(replayRecord.lowEndLevels);
+            
+            ++replayNumDrains;
+        }
+        else if (replayRecord.tag == InputCaptureWriter::chunkTag)
+        {
+            if (replayRecord.followsGap)
+                resetHistories();
+            
+            if (replayRecord.block.getNumSamples() > 0)
+            {
+                // The processor's heatmap takes its blocks, the replay's can only take the chunks
+                auto summary = BlockSummary::fromBuffer(replayRecord.block);
+                replayHeatmap.addBlock(juce::Decibels::gainToDecibels(summary.getMonoMagnitude(), NEGATIVE_INFINITY), summary.numSamples);
+                pushToHistories(replayRecord.block);
+            }
+        }
+        else if (replayRecord.tag == InputCaptureWriter::updateTag)
+        {
+            advanceReplayClock(replayRecord.timeMs);
+            
+            if (replayRecord.silenceFed)
+            {
+                historyBuffer.clear();
+                thirdOctaveMeter.push(historyBuffer);
+            }
+            
+            update();
+        }
+    }
+}
+
+void PFM10AudioProcessorEditor::advanceReplayClock(double timeMs)
+{
+    const double tickIntervalMs = 1000.0 / 60;    // the holders' timer rate
+    
+    while (replayTickTimeMs + tickIntervalMs <= timeMs)
+    {
+        replayTickTimeMs += tickIntervalMs;
+        meterClock.setReplayTime(static_cast<juce::int64>(replayTickTimeMs));
+        peakStereoMeter.tickBallistics();
+        stereoImageMeter.tickBallistics();
+        thirdOctaveMeter.tickBallistics();
+        dynamicsMeter.tickBallistics();
+    }
+    
+    replayTimeMs = juce::jmax(replayTimeMs, timeMs);
+    meterClock.setReplayTime(static_cast<juce::int64>(replayTimeMs));
+}
+
+void PFM10AudioProcessorEditor::finishReplay()
+{
+    auto elapsedSeconds = (juce::Time::getMillisecondCounterHiRes() - replayStartTimeMs) / 1000;
+    getReplayResultFile(replayFile).replaceWithText("Replayed " + juce::String(replayNumDrains) + " drains ("
+                                                    + juce::String(replayTimeMs / 1000, 3) + " s of capture) in "
+                                                    + juce::String(elapsedSeconds, 3) + " s\n");
+    
+    replayReader.reset();
+    meterClock.useWallClock();
+    
+    audioProcessor.peakTracker.takePeakLevels();
+    
+    // Whatever piled up in the FIFO and the ring during the replay is stale
+    bufferMutex.lock();
+    while (audioProcessor.audioBufferFifo.pull(editorAudioBuffer))
+    {
     }
+    bufferMutex.unlock();
+    
+    audioProcessor.historyRing.discardAll();
+    resetHistories();
+    
+    // Back to the live session. The update thread re-prepares the histories
+    // if the capture ran at another rate.
+    heatmap.setSource(nullptr);
+    peakHistogram.restore(audioProcessor.analysisHistory.getLevels());
+    updateThread.startThread();
+}
+
+juce::File PFM10AudioProcessorEditor::getReplayResultFile(const juce::File& captureFile)
+{
+    return captureFile.withFileExtension(".replay.txt");
 }
 
 int PFM10AudioProcessorEditor::getRefreshRateHz() const
@@ -1900,11 +4147,46 @@ int PFM10AudioProcessorEditor::getRefreshRateHz() const
 
 void PFM10AudioProcessorEditor::update()
 {
+    // A replay feeds the histories itself, with the chunks the capture read from the ring
+    if (! meterClock.isReplaying())
+    {
+        // The editor may have opened before prepareToPlay, or the rate moved under it
+        auto sampleRate = audioProcessor.getSampleRate();
+        if (sampleRate > 0 && sampleRate != historySampleRate)
+            prepareHistories(sampleRate);
+        
+        drainHistoryRing();
+        
+        bool silenceFed = silencePending.exchange(false);
+        if (silenceFed)
+        {
+            historyBuffer.clear();
+            thirdOctaveMeter.push(historyBuffer);
+        }
+        
+        inputCapture.writeUpdate(silenceFed);
+    }
+    
     peakStereoMeter.update( dbLeftChannel.load(), dbRightChannel.load() );
+    lowEndMeter.update();
     
     peakHistogram.update( dbPeakMono.load() );
     
+    // The processor's histories only ever hold the live session. Its heatmap
+    // keeps taking the live audio during a replay, which shows one of its own.
+    if (! meterClock.isReplaying())
+        audioProcessor.analysisHistory.addFrame(dbPeakMono.load(), dbLeftChannel.load(), dbRightChannel.load());
+    audioProcessor.levelHeatmap.drain();
+    
     bufferMutex.lock();
     stereoImageMeter.update();
+    peakHistogram.setNoiseFloor(noiseFloor.getNoiseFloorDb(), noiseFloor.getSnrDb());
     bufferMutex.unlock();
+    
+    oscilloscope.update();
+    dynamicsMeter.update();
+    scrollingWaveform.update();
+    heatmap.update();
+    thirdOctaveMeter.update();
+    panSpectrumView.update();
 }
@@ -8,23 +8,19 @@
 
 #pragma once
 
+// Records the editor input stream to Documents/PFM10 Logs, or replays the
+// capture named by the PFM10_REPLAY_CAPTURE environment variable instead
+#define EDITOR_INPUT_CAPTURE false
+
 #include <JuceHeader.h>
 #include "PluginProcessor.h"
-
-#ifdef  MAX_DECIBELS
-#undef  MAX_DECIBELS
-#endif
-#define MAX_DECIBELS 12.f
-
-#ifdef  NEGATIVE_INFINITY
-#undef  NEGATIVE_INFINITY
-#endif
-#define NEGATIVE_INFINITY -66.f
-
-#ifdef  INV_SQRT_OF_2
-#undef  INV_SQRT_OF_2
-#endif
-#define INV_SQRT_OF_2 0.7071f
+#include "MeterAnalysis.h"
+#include "InputCapture.h"
+#include "OverviewWindow.h"
+#include "WaveformHistory.h"
+#include "WaveformOverview.h"
+#include "ThirdOctaveAnalyser.h"
+#include "StereoSpectrum.h"
 
 //==============================================================================
 // Look And Feel classes
@@ -52,65 +48,62 @@ private:
 //==============================================================================
 // JUCE Components and custom classes
 //==============================================================================
-//MARK: - Averager
+//MARK: - MeterClock
 
-template<typename T>
-struct Averager
+/*
+   Time source for the hold and decay ballistics. While a capture is being
+   replayed the replay steps this clock, and the holders' own timers stand
+   down so the replay calls tick() in capture time instead.
+   One per editor, handed to each of its holders, so a replay in one editor
+   leaves every other editor in the process on the wall clock.
+ */
+struct MeterClock
 {
-    Averager(size_t _numElements, T _initialValue);
-    
-    void resize(size_t numElements, T initialValue);
-    
-    void clear(T initialValue);
-    
-    size_t getSize() const { return elements.size(); }
-    
-    void add(T t);
-    
-    float getAvg() const { return avg; }
+    juce::int64 now() const;
+    bool isReplaying() const { return replaying.load(); }
+    void setReplayTime(juce::int64 ms);
+    void useWallClock() { replaying = false; }
 private:
-    std::vector<T> elements;
-    std::atomic<float> avg { NEGATIVE_INFINITY };
-    std::atomic<size_t> writeIndex = 0;
-    std::atomic<T> sum { NEGATIVE_INFINITY };
+    std::atomic<bool> replaying { false };
+    std::atomic<juce::int64> replayTimeMs { 0 };
 };
 
 //MARK: - DecayingValueHolder
 
 struct DecayingValueHolder : juce::Timer, juce::ValueTree::Listener
 {
-    DecayingValueHolder(juce::ValueTree _vt);
+    DecayingValueHolder(juce::ValueTree _vt, const MeterClock& _clock);
     ~DecayingValueHolder() override;
     void updateHeldValue(float input);
     void resetHeldValue();
-    float getHeldValue() const { return heldValue; }
+    float getHeldValue() const { return decayingValue.getHeldValue(); }
     bool isOverThreshold() const;
     void setHoldTime(int ms);
     void setDecayRate(int dbPerSec);
     void setHoldForInf(bool b);
     void timerCallback() override;
+    void tick();
+    void setTicking(bool shouldTick);
+    bool isSettled() const;
 private:
     // Value Tree
     juce::ValueTree vt;
     void valueTreePropertyChanged(juce::ValueTree&, const juce::Identifier&) override;
+    void loadSettings(juce::ValueTree& tree);
     
-    bool holdForInf;
-    float heldValue { NEGATIVE_INFINITY };
-    juce::int64 holdTimeMs;
-    juce::int64 peakTime = getNow();
+    const MeterClock& clock;
+    DecayingValue decayingValue;
     float threshold { NEGATIVE_INFINITY };
-    float decayRatePerFrame;
-    static juce::int64 getNow();
+    juce::int64 getNow() const { return clock.now(); }
     
     std::mutex heldValueMutex;
-    std::mutex peakTimeMutex;
 };
 
 //MARK: - ValueHolder
 
 struct ValueHolder : juce::Timer, juce::ValueTree::Listener
 {
-    ValueHolder(juce::ValueTree _vt);
+    ValueHolder(juce::ValueTree _vt, const MeterClock& _clock);
     ~ValueHolder() override;
     void setThreshold(float th);
     bool updateHeldValue(float v);
@@ -122,11 +115,16 @@ struct ValueHolder : juce::Timer, juce::ValueTree::Listener
     float getHeldValue() const { return heldValue.load(); }
     bool getIsOverThreshold() const { return isOverThreshold.load(); }
     void timerCallback() override;
+    void tick();
+    void setTicking(bool shouldTick);
+    bool isSettled() const;
 private:
     // Value Tree
     juce::ValueTree vt;
     void valueTreePropertyChanged(juce::ValueTree&, const juce::Identifier&) override;
+    void loadSettings(juce::ValueTree& tree);
     
+    const MeterClock& clock;
     bool holdEnabled;
     bool holdForInf;
     int durationToHoldForMs;
@@ -143,11 +141,14 @@ private:
 
 struct TextMeter : juce::Component
 {
-    TextMeter(juce::ValueTree _vt);
+    TextMeter(juce::ValueTree _vt, const MeterClock& clock);
     void paint(juce::Graphics& g) override;
     void update(float valueDb);
     void setThreshold(float dbLevel);
     void resetHold();
+    void tickBallistics() { valueHolder.tick(); }
+    void setBallisticsRunning(bool shouldRun) { valueHolder.setTicking(shouldRun); }
+    bool isSettled() const { return valueHolder.isSettled(); }
 private:
     ValueHolder valueHolder;
     float dbThreshold { 0 };
@@ -162,16 +163,23 @@ private:
 
 struct Meter : juce::Component
 {
-    Meter(juce::ValueTree _vt);
+    Meter(juce::ValueTree _vt, const MeterClock& clock);
     void paint (juce::Graphics&) override;
     void update(float dbLevel);
     void setThreshold(float dbLevel) { dbThreshold = dbLevel; }
     void setPeakHoldEnabled(bool isEnabled) { peakHoldEnabled = isEnabled; }
+    void setRange(float _minDb, float _maxDb) { minDb = _minDb; maxDb = _maxDb; }
     void resetHold();
+    void tickBallistics() { decayingValueHolder.tick(); }
+    void setBallisticsRunning(bool shouldRun) { decayingValueHolder.setTicking(shouldRun); }
+    bool isSettled();
+    bool isHoldSettled() const { return decayingValueHolder.isSettled(); }
 private:
     bool peakHoldEnabled { true };
     float dbPeak { NEGATIVE_INFINITY };
     float dbThreshold { 0 };
+    float minDb { NEGATIVE_INFINITY };
+    float maxDb { MAX_DECIBELS };
     DecayingValueHolder decayingValueHolder;
     
     juce::ColourGradient meterColourGradient;
@@ -186,13 +194,23 @@ private:
 
 struct MacroMeter : juce::Component
 {
-    MacroMeter(juce::ValueTree _vt);
+    MacroMeter(juce::ValueTree _vt, const MeterClock& clock);
     void resized() override;
     void updateLevel(float level);
     void updateThreshold(float dbLevel);
     void setAveragerIntervals(int numElements);
     void setPeakHoldEnabled(bool isEnabled);
+    
+    // The bars' scale, the level meters' by default
+    void setRange(float minDb, float maxDb);
     void resetHold();
+    void tickBallistics();
+    void setBallisticsRunning(bool shouldRun);
+    bool isSettled();
+    
+    // Settled on the level it was last given rather than on the floor:
+    // the holds have run out and the average has caught up with the level
+    bool isSettledOnLevel();
     //==============================================================================
     int getTextHeight() const { return textHeight; }
     int getTextMeterHeight() const { return peakTextMeter.getHeight(); }
@@ -203,6 +221,7 @@ private:
     Meter peakMeter;
     Meter averageMeter;
     Averager<float> averager;
+    std::atomic<float> lastLevel { NEGATIVE_INFINITY };
 };
 
 //MARK: - Tick
@@ -230,9 +249,17 @@ private:
 
 struct StereoMeter : juce::Component, juce::ValueTree::Listener
 {
-    StereoMeter(juce::ValueTree _vt, juce::String _meterName);
+    StereoMeter(juce::ValueTree _vt, juce::String _meterName, const MeterClock& clock);
     ~StereoMeter() override;
     void resetHold();
+    void tickBallistics();
+    
+    // Stops the hold and decay timers while the editor is parked
+    void setBallisticsRunning(bool shouldRun);
+    
+    // True once nothing on the meter would move without new input
+    bool isSettled();
+    
     void resized() override;
     void update(float leftChannelDb, float rightChannelDb);
 private:
@@ -242,6 +269,7 @@ private:
     juce::Identifier ID_averagerIntervals = juce::Identifier("averagerIntervals");
     juce::Identifier ID_peakHoldEnabled   = juce::Identifier("peakHoldEnabled");
     void valueTreePropertyChanged(juce::ValueTree&, const juce::Identifier&) override;
+    void loadSettings(juce::ValueTree& tree);
 
     // Look and Feel
     LAF_ThresholdSlider thresholdSliderLAF;
@@ -253,6 +281,38 @@ private:
     juce::Slider thresholdSlider;
 };
 
+//MARK: - LowEndMeter
+
+/*
+   DC offset and level below 20 Hz per channel, as the processor's
+   PeakTracker last published them. Sits under the level meters. The DC
+   readout turns red from -60 dBFS (0.1%), where it starts to cost headroom.
+ */
+struct LowEndMeter : juce::Component
+{
+    static constexpr float dcWarningLevel = 0.001f;
+    static constexpr float minSubsonicDb = -60.f;
+    
+    LowEndMeter();
+    void paint(juce::Graphics& g) override;
+    void resized() override;
+    
+    // Message thread, after each drain
+    void setLevels(const LowEndLevels& levels);
+    
+    // Update thread
+    void update();
+private:
+    std::array<std::atomic<float>, PeakTracker::numChannels> dcOffset {};
+    std::array<std::atomic<float>, PeakTracker::numChannels> subsonicDb {};
+    
+    std::array<juce::Rectangle<int>, PeakTracker::numChannels> dcTextAreas, subsonicBarAreas;
+    juce::Image labelsImage;
+    int labelWidth { 14 };
+    
+    void buildLabelsImage(juce::Graphics& g);
+};
+
 //MARK: - ReadAllAfterWriteCircularBuffer
 
 template<typename T>
@@ -276,7 +336,7 @@ private:
 
 //MARK: - Histogram
 
-struct Histogram : juce::Component, juce::ValueTree::Listener
+struct Histogram : juce::Component, juce::ValueTree::Listener, juce::Timer
 {
     Histogram(juce::ValueTree _vt, const juce::String& _title);
     
@@ -285,7 +345,20 @@ struct Histogram : juce::Component, juce::ValueTree::Listener
     void mouseDown(const juce::MouseEvent& e) override;
     void mouseMove(const juce::MouseEvent& e) override;
     void mouseExit(const juce::MouseEvent& e) override;
+    void mouseDrag(const juce::MouseEvent& e) override;
+    void mouseWheelMove(const juce::MouseEvent& e, const juce::MouseWheelDetails& wheel) override;
     void update(float value);
+    
+    // Refills the live view, oldest value first
+    void restore(const std::vector<float>& values);
+    std::function<void()> onClear;
+    
+    // Shows the whole of a recorded meter log instead of the live level, and
+    // keeps up with it while it's still being written. nullptr goes back to live.
+    void setLogReader(MeterLogReader* reader);
+    
+    // Drawn over the live view as a line, with an SNR readout
+    void setNoiseFloor(float floorDb, float _snrDb);
 private:
     // Value Tree
     juce::ValueTree vt;
@@ -319,6 +392,28 @@ private:
     int dbValueTextAreaHeight { 18 };
     juce::Rectangle<int> dbValueTextArea { 0, 0, dbValueTextAreaWidth, dbValueTextAreaHeight };
     
+    // History view
+    static constexpr int logRefreshHz = 4;
+    MeterLogReader* logReader { nullptr };
+    std::vector<MeterLogReader::Span> logSpans;
+    double viewStartFrame { 0 };
+    double framesPerPixel { 1 };
+    double minFramesPerPixel { 0.125 };
+    double dragStartFrame { 0 };
+    
+    double getMaxFramesPerPixel() const;
+    void limitView();
+    void displayLogSpans(juce::Graphics& g, juce::Rectangle<float> bounds);
+    void timerCallback() override;
+    
+    // Noise floor
+    std::atomic<float> noiseFloorDb { NEGATIVE_INFINITY };
+    std::atomic<float> snrDb { NEGATIVE_INFINITY };
+    juce::Colour noiseFloorColour { juce::Colours::skyblue.withAlpha(0.8f) };
+    int noiseFloorTextAreaWidth { 160 };
+    void displayNoiseFloor(juce::Graphics& g, juce::Rectangle<float> bounds);
+    
+    void setGradientColours();
     void displayPath(juce::Graphics& g, juce::Rectangle<float> bounds);
     static juce::Path buildPath(juce::Path& p,
                                 ReadAllAfterWriteCircularBuffer<float>& buffer,
@@ -336,9 +431,13 @@ struct Goniometer : juce::Component
     void setScale(float newScale) { scale = newScale; }
     void update();
     float getDiameter() const { return diameter; }
+    
+    // Sums over the samples of the last update(), before the display scale is applied
+    const MidSideSums& getMidSideSums() const { return midSideSums; }
 private:
     juce::AudioBuffer<float>& buffer;
     juce::AudioBuffer<float> internalBuffer;
+    MidSideSums midSideSums;
     juce::Image backgroundImage;
     juce::Rectangle<int> areaToRepaint;
     juce::Image pointCloud;
@@ -359,13 +458,14 @@ struct CorrelationMeter : juce::Component
     CorrelationMeter(juce::AudioBuffer<float>& buffer, double sampleRate);
     void paint(juce::Graphics& g) override;
     void resized() override;
+    void prepare(double sampleRate) { correlationAnalyser.prepare(sampleRate); }
     void update();
     
     int getMeterAreaTrimBottom() const { return meterAreaTrimBottom; }
     int getMeterAreaTrimSide() const { return meterAreaTrimSide; }
 private:
     juce::AudioBuffer<float>& buffer;
-    std::array<juce::dsp::FIR::Filter<float>, 3> filters;
+    CorrelationAnalyser correlationAnalyser;
     Averager<float> slowAverager{1024*4, 0},
                     peakAverager{512, 0};
     
@@ -391,13 +491,64 @@ private:
     void buildLabelsImage(juce::Graphics& g);
 };
 
+//MARK: - StereoFieldMeter
+
+/*
+   Width (side over mid energy), left/right balance and mono fold-down loss,
+   read from the goniometer's M/S sums. Like the level meters, each bar shows
+   the average over the RMS length, and width and mono loss carry a peak
+   hold that follows the hold and decay settings.
+ */
+struct StereoFieldMeter : juce::Component, juce::ValueTree::Listener
+{
+    static constexpr float minWidthDb = -24.f;
+    static constexpr float maxWidthDb = 12.f;
+    static constexpr float maxBalanceDb = 12.f;
+    static constexpr float maxMonoLossDb = 12.f;
+    
+    StereoFieldMeter(juce::ValueTree _vt, const MeterClock& clock);
+    ~StereoFieldMeter() override;
+    void paint(juce::Graphics& g) override;
+    void resized() override;
+    void update(const MidSideSums& sums);
+    void resetHold();
+    void tickBallistics();
+    void setBallisticsRunning(bool shouldRun);
+    bool isSettled() const;
+private:
+    // Value Tree
+    juce::ValueTree vt;
+    void valueTreePropertyChanged(juce::ValueTree&, const juce::Identifier&) override;
+    void setAveragerIntervals(int numElements);
+    
+    Averager<float> widthAverager    { 30, NEGATIVE_INFINITY },
+                    balanceAverager  { 30, 0.f },
+                    monoLossAverager { 30, NEGATIVE_INFINITY };
+    DecayingValueHolder widthHold, monoLossHold;
+    
+    juce::Rectangle<int> widthBarArea, balanceBarArea, monoLossBarArea;
+    juce::Image labelsImage;
+    int labelHeight { 14 };
+    
+    void drawBar(juce::Graphics& g, juce::Rectangle<int> bounds, float value, float originValue, float minValue, float maxValue, juce::Colour colour);
+    void drawHold(juce::Graphics& g, juce::Rectangle<int> bounds, float value, float minValue, float maxValue);
+    void buildLabelsImage(juce::Graphics& g);
+};
+
 //MARK: - StereoImageMeter
 
 struct StereoImageMeter : juce::Component, juce::ValueTree::Listener
 {
-    StereoImageMeter(juce::ValueTree _vt, juce::AudioBuffer<float>& _buffer, double _sampleRate);
+    StereoImageMeter(juce::ValueTree _vt, juce::AudioBuffer<float>& _buffer, double _sampleRate, const MeterClock& clock);
     void resized() override;
+    
+    // Update thread, under the same lock as update()
+    void prepare(double sampleRate) { correlationMeter.prepare(sampleRate); }
     void update();
+    void resetHold() { stereoFieldMeter.resetHold(); }
+    void tickBallistics() { stereoFieldMeter.tickBallistics(); }
+    void setBallisticsRunning(bool shouldRun) { stereoFieldMeter.setBallisticsRunning(shouldRun); }
+    bool isSettled() const { return stereoFieldMeter.isSettled(); }
 private:
     // Value Tree
     juce::ValueTree vt;
@@ -405,6 +556,343 @@ private:
     
     Goniometer goniometer;
     CorrelationMeter correlationMeter;
+    StereoFieldMeter stereoFieldMeter;
+};
+
+//MARK: - Oscilloscope
+
+/*
+   Waveform of the mono signal over the last window. With a trigger, the
+   window starts at the latest rising crossing of zero or of the threshold
+   level that still leaves a full window after it, so periodic signals stand
+   still. Each pixel column is drawn as one vertical min/max span from the
+   history's summary pyramid, however many samples it covers.
+ */
+struct Oscilloscope : juce::Component, juce::ValueTree::Listener
+{
+    enum TriggerModes
+    {
+        TRIGGER_FREE = 0,
+        TRIGGER_ZERO,
+        TRIGGER_LEVEL
+    };
+    static constexpr int maxWindowMs = 2000;
+    
+    Oscilloscope(juce::ValueTree _vt, double _sampleRate);
+    ~Oscilloscope() override;
+    void paint(juce::Graphics& g) override;
+    void resized() override;
+    
+    // Update thread: starts the history over at the processor's new rate
+    void prepare(double sampleRate);
+    
+    // Update thread, with every sample from the processor's history ring
+    void push(const juce::AudioBuffer<float>& block);
+    void reset();
+    
+    // Update thread: renders the trace image
+    void update();
+private:
+    // Value Tree
+    juce::ValueTree vt;
+    void valueTreePropertyChanged(juce::ValueTree&, const juce::Identifier&) override;
+    void loadSettings(juce::ValueTree& tree);
+    
+    std::atomic<int> triggerMode { TRIGGER_ZERO };
+    std::atomic<int> windowMs { 20 };
+    std::atomic<float> triggerLevel { 1.f };
+    
+    WaveformHistory history;
+    std::mutex historyMutex;
+    std::vector<WaveformHistory::Span> spans;
+    
+    juce::Rectangle<int> traceArea;
+    juce::Image backgroundImage;
+    juce::Image trace;
+    juce::PixelARGB traceColour { juce::Colours::limegreen.getPixelARGB() };
+    std::mutex traceMutex;
+    
+    juce::ComboBox triggerMenu;
+    juce::ComboBox windowMenu;
+    int menuHeight { 24 };
+    
+    void buildBackground(juce::Graphics& g);
+    void renderTrace();
+};
+
+//MARK: - DynamicsMeter
+
+/*
+   Crest factor and PSR over the selected window, and PLR since the window
+   was last picked, each shown by a MacroMeter on a 0 to maxDb scale, so they
+   hold, decay and average like the level meters. Fed every sample, so the
+   window's peak is exact.
+ */
+struct DynamicsMeter : juce::Component, juce::ValueTree::Listener
+{
+    static constexpr float maxDb = 30.f;
+    
+    DynamicsMeter(juce::ValueTree _vt, double _sampleRate, const MeterClock& clock);
+    ~DynamicsMeter() override;
+    void paint(juce::Graphics& g) override;
+    void resized() override;
+    void resetHold();
+    void tickBallistics();
+    void setBallisticsRunning(bool shouldRun);
+    
+    // PLR keeps its reading through silence, so this doesn't wait for the floor
+    bool isSettled();
+    
+    // Update thread: starts the window and PLR over at the processor's new rate
+    void prepare(double _sampleRate);
+    
+    // Update thread, with every sample from the processor's history ring
+    void push(const juce::AudioBuffer<float>& block);
+    void reset();
+    
+    // Update thread: takes the readings
+    void update();
+private:
+    // Value Tree
+    juce::ValueTree vt;
+    void valueTreePropertyChanged(juce::ValueTree&, const juce::Identifier&) override;
+    void setWindowSeconds(int seconds);
+    void loadMeterSettings(juce::ValueTree& tree);
+    
+    double sampleRate;              // under analyserMutex, with windowSeconds
+    int windowSeconds { 3 };
+    DynamicRangeAnalyser analyser;
+    std::mutex analyserMutex;
+    
+    MacroMeter crestFactorMeter;
+    MacroMeter psrMeter;
+    MacroMeter plrMeter;
+    
+    juce::Image labelsImage;
+    int labelWidth { 40 };
+    int meterWidth { 30 };
+    
+    juce::ComboBox windowMenu;
+    int menuWidth { 70 };
+    int menuHeight { 24 };
+    
+    void buildLabelsImage(juce::Graphics& g);
+};
+
+//MARK: - ScrollingWaveform
+
+/*
+   The last 30 to 300 seconds of the left and right waveforms, newest at the
+   right edge. Columns are pinned to absolute sample positions, so the
+   picture scrolls without the summaries shimmering from frame to frame.
+ */
+struct ScrollingWaveform : juce::Component, juce::ValueTree::Listener
+{
+    static constexpr int maxSeconds = 300;
+    
+    ScrollingWaveform(juce::ValueTree _vt, double _sampleRate);
+    ~ScrollingWaveform() override;
+    void paint(juce::Graphics& g) override;
+    void resized() override;
+    
+    // Update thread: starts the overview over at the processor's new rate
+    void prepare(double sampleRate);
+    
+    // Update thread, with every sample from the processor's history ring
+    void push(const juce::AudioBuffer<float>& block);
+    void reset();
+    
+    // Update thread: renders the waveform image
+    void update();
+private:
+    // Value Tree
+    juce::ValueTree vt;
+    void valueTreePropertyChanged(juce::ValueTree&, const juce::Identifier&) override;
+    
+    std::atomic<int> seconds { 60 };
+    
+    WaveformOverview overview;
+    std::mutex overviewMutex;
+    std::array<std::vector<WaveformOverview::Span>, WaveformOverview::numChannels> spans;
+    
+    juce::Rectangle<int> waveformArea;
+    juce::Image waveform;
+    juce::PixelARGB waveformColour { juce::Colours::skyblue.getPixelARGB() };
+    std::mutex waveformMutex;
+    
+    juce::ComboBox secondsMenu;
+    int menuWidth { 70 };
+    
+    void renderWaveform();
+};
+
+//MARK: - Heatmap
+
+/*
+   How the mono peak level was distributed over time: one column per stretch
+   of audio, one row per dB bin, brighter where the level spent more of
+   that stretch. Columns are drawn into a ring image as they change, and
+   paint() blits the ring in two pieces so the newest column sits at the
+   right edge. Zooming out reads coarser levels of the LevelHeatmap tree,
+   the processor's unless a replay has lent it one of its own.
+ */
+struct Heatmap : juce::Component, juce::ValueTree::Listener
+{
+    Heatmap(juce::ValueTree _vt, LevelHeatmap& _levels);
+    ~Heatmap() override;
+    void paint(juce::Graphics& g) override;
+    void resized() override;
+    
+    // Update thread: redraws the columns that changed since the last call
+    void update();
+    
+    // Shows another heatmap in place of the processor's. nullptr goes back to it.
+    void setSource(LevelHeatmap* levels);
+private:
+    // Value Tree
+    juce::ValueTree vt;
+    void valueTreePropertyChanged(juce::ValueTree&, const juce::Identifier&) override;
+    
+    LevelHeatmap& processorLevels;
+    std::atomic<LevelHeatmap*> source;
+    std::atomic<int> zoomLevel { 0 };
+    std::vector<LevelHeatmap::Column> columns;
+    
+    // Share of a column's frames in a bin, square-root scaled, to colour
+    static constexpr int lutSize = 256;
+    std::array<juce::PixelARGB, lutSize> colourLut;
+    
+    juce::Rectangle<int> heatmapArea;
+    juce::Image labelsImage;
+    int labelsWidth { 30 };
+    
+    // One pixel per column and per bin; column c lives at x = c % width
+    juce::Image ring;
+    int renderedLevel { -1 };
+    juce::int64 renderedNewest { -1 };
+    std::mutex ringMutex;
+    
+    juce::ComboBox zoomMenu;
+    int menuWidth { 70 };
+    
+    void buildColourLut();
+    void buildLabelsImage(juce::Graphics& g);
+    void renderColumns(juce::int64 firstColumn);
+};
+
+//MARK: - ThirdOctaveMeter
+
+/*
+   1/3-octave RTA of the mono sum, one bar per band on the level meters' dB
+   scale. Each band has its own peak hold, which follows the same hold and
+   decay settings as the DecayingValueHolders but is decayed by update()
+   rather than by 31 timers of its own. Fed every sample from the
+   processor's history ring; the bands integrate over the frame.
+ */
+struct ThirdOctaveMeter : juce::Component, juce::ValueTree::Listener
+{
+    static constexpr int numBands = ThirdOctaveAnalyser::numBands;
+    
+    ThirdOctaveMeter(juce::ValueTree _vt, double _sampleRate, const MeterClock& _clock);
+    ~ThirdOctaveMeter() override;
+    void paint(juce::Graphics& g) override;
+    void resized() override;
+    
+    // Update thread: re-prepares the analyser if the processor's rate has changed
+    void prepare(double _sampleRate);
+    
+    // Update thread, with every sample from the processor's history ring
+    void push(const juce::AudioBuffer<float>& block);
+    void resetAnalysis();
+    
+    // Update thread: takes the frame's band levels
+    void update();
+    
+    void resetHold();
+    void tickBallistics();
+    bool isSettled() const;
+private:
+    // Value Tree
+    juce::ValueTree vt;
+    void valueTreePropertyChanged(juce::ValueTree&, const juce::Identifier&) override;
+    void loadHoldSettings(juce::ValueTree& tree);
+    
+    const MeterClock& clock;
+    double sampleRate { 0 };
+    ThirdOctaveAnalyser analyser;
+    std::mutex analyserMutex;
+    std::array<float, numBands> frameLevelsDb;
+    
+    std::array<std::atomic<float>, numBands> levelsDb;
+    
+    // Read by paint() without the lock, the held values are atomic
+    std::array<DecayingValue, numBands> holds;
+    std::mutex holdsMutex;
+    juce::int64 lastDecayMs { 0 };
+    void decayHolds();
+    
+    juce::Rectangle<int> barsArea;
+    int barsAreaTopBottomTrim { 10 };
+    juce::Colour barColour { juce::Colours::limegreen.withAlpha(0.9f) };
+    
+    DbScale dbScale;
+    int dbScaleWidth { 30 };
+    int dbScaleDivision { 12 };
+    std::vector<int> dbScaleTicksY;
+    
+    juce::Image labelsImage;
+    int labelHeight { 14 };
+    
+    void buildLabelsImage(juce::Graphics& g);
+};
+
+//MARK: - PanSpectrumView
+
+/*
+   Where each frequency sits between the speakers: log frequency across,
+   hard left at the top to hard right at the bottom. Brightness is the share
+   of a column's energy at that pan position, colour is how well the two
+   sides agree in phase there, green in phase through yellow to red out of
+   phase. Listens to the editor's StereoSpectrum, so it runs no transform of
+   its own; its menu picks that spectrum's resolution, which the editor
+   applies.
+ */
+struct PanSpectrumView : juce::Component, juce::ValueTree::Listener
+{
+    PanSpectrumView(juce::ValueTree _vt, StereoSpectrum& _spectrum, double _sampleRate);
+    ~PanSpectrumView() override;
+    void paint(juce::Graphics& g) override;
+    void resized() override;
+    
+    // Update thread, after the spectrum has been prepared at the new rate
+    void prepare(double sampleRate);
+    
+    // Update thread: renders the grid
+    void update();
+private:
+    // Value Tree
+    juce::ValueTree vt;
+    void valueTreePropertyChanged(juce::ValueTree&, const juce::Identifier&) override;
+    
+    StereoSpectrum& spectrum;
+    PanSpectrum panSpectrum;
+    std::vector<PanSpectrum::Cell> cells;
+    std::vector<float> columnLevelsDb;
+    
+    juce::Rectangle<int> plotArea;
+    juce::Image labelsImage;
+    int panLabelsWidth { 14 };
+    int frequencyLabelsHeight { 14 };
+    
+    // One pixel per cell, scaled up in paint()
+    juce::Image grid;
+    std::mutex gridMutex;
+    
+    juce::ComboBox resolutionMenu;
+    int menuWidth { 90 };
+    
+    void buildLabelsImage(juce::Graphics& g);
+    void renderGrid();
 };
 
 //MARK: - UpdateThread
@@ -431,7 +919,7 @@ public:
 //==============================================================================
 //MARK: - PFM10AudioProcessorEditor
 
-class PFM10AudioProcessorEditor  : public juce::AudioProcessorEditor, juce::Timer
+class PFM10AudioProcessorEditor  : public juce::AudioProcessorEditor, juce::Timer, juce::ValueTree::Listener, juce::ChangeListener
 {
 public:
     PFM10AudioProcessorEditor (PFM10AudioProcessor&);
@@ -446,6 +934,15 @@ public:
     //==============================================================================
     void update();
     
+    /* Feeds a capture through the editor pipeline in place of the live FIFO
+       and history ring, as fast as the message thread allows. The update thread is stopped for the
+       length of the replay and live metering resumes afterwards.
+       The replay only reaches the editor's own views, never the processor's
+       histories. When it's done the timing goes to getReplayResultFile().
+     */
+    bool startReplay(const juce::File& captureFile);
+    static juce::File getReplayResultFile(const juce::File& captureFile);
+    
 private:
     // This reference is provided as a quick way for your editor to
     // access the processor object that created it.
@@ -455,11 +952,30 @@ private:
     
     juce::AudioBuffer<float> editorAudioBuffer;
     
+    // Chunks read from the processor's history ring
+    juce::AudioBuffer<float> historyBuffer { AudioSampleRing::numChannels, 1024 };
+    
     juce::Image background;
     
+    // Every holder in this editor runs on it, so it goes before the components
+    MeterClock meterClock;
+    
+    // Outlives peakHistogram, which holds on to it while a log is shown
+    std::unique_ptr<MeterLogReader> logReader;
+    
+    // Shared by every spectrum view, so each block is transformed once. Fed under bufferMutex.
+    StereoSpectrum stereoSpectrum;
+    
     StereoMeter peakStereoMeter;
+    LowEndMeter lowEndMeter;
     Histogram peakHistogram;
     StereoImageMeter stereoImageMeter;
+    Oscilloscope oscilloscope;
+    DynamicsMeter dynamicsMeter;
+    ScrollingWaveform scrollingWaveform;
+    Heatmap heatmap;
+    ThirdOctaveMeter thirdOctaveMeter;
+    PanSpectrumView panSpectrumView;
     
     UpdateThread updateThread;
     
@@ -469,6 +985,57 @@ private:
     
     std::mutex bufferMutex;
     
+    NoiseFloorEstimator noiseFloor;     // fed from the history ring on the update thread, under bufferMutex
+    
+    void setPeakLevels(const PeakLevels& peakLevels);
+    
+    //==============================================================================
+    // Parking: with the transport stopped and the input silent, the timers stop
+    // and the update thread waits until the processor reports audio again
+    
+    static constexpr juce::uint32 parkDelayMs = 250;   // settled for this long before parking
+    bool parked { false };
+    juce::uint32 lastBlockTimeMs { 0 };
+    juce::uint32 settledSinceMs { 0 };
+    
+    void setSpectrumResolution(int resolution);
+    
+    // Histories: the scope, dynamics, waveform, third-octave, spectrum and noise floor.
+    // Fed on the update thread, or on the message thread during a replay, which stops it.
+    // Prepared at historySampleRate, which the update thread moves to the processor's
+    // rate when an editor opened before prepareToPlay or the rate changed under it.
+    double historySampleRate { 0 };
+    void prepareHistories(double sampleRate);
+    void drainHistoryRing();
+    void pushToHistories(const juce::AudioBuffer<float>& block);
+    void resetHistories();
+    
+    bool haveBlocksStopped() const;
+    void feedSilence();
+    std::atomic<bool> silencePending { false };     // for the update thread to feed to the third-octave meter
+    void updateParking();
+    void park();
+    void wake();
+    
+    //==============================================================================
+    // Input capture and replay
+    
+    InputCaptureWriter inputCapture;
+    
+    std::unique_ptr<InputCaptureReader> replayReader;
+    InputCaptureRecord replayRecord;
+    LevelHeatmap replayHeatmap;         // shown in place of the processor's, which keeps the live audio
+    juce::File replayFile;
+    double replayTimeMs { 0 };          // capture time of the last drain or update replayed
+    double replayTickTimeMs { 0 };
+    int replayNumDrains { 0 };
+    double replayStartTimeMs { 0 };
+    double replayBudgetMs { 10 };
+    
+    void replayStep();
+    void advanceReplayClock(double timeMs);
+    void finishReplay();
+    
     //==============================================================================
     // Menus
     
@@ -517,15 +1084,38 @@ private:
     juce::TextButton peakHoldResetButton;
     void onPeakHoldResetButtonClicked();
     
+    juce::TextButton meterLogButton;
+    void onMeterLogButtonClicked();
+    
+    juce::TextButton viewLogButton;
+    std::unique_ptr<juce::FileChooser> logFileChooser;
+    void onViewLogButtonClicked();
+    void showLog(const juce::File& file);
+    
+    juce::TextButton renderReportButton;
+    void updateRenderReportButton();
+    void changeListenerCallback(juce::ChangeBroadcaster* source) override;     // a render report was written
+    
+    juce::TextButton overviewButton;
+    
     juce::Label goniometerScaleRotarySliderLabel { {}, "Gonio Scale" };
     juce::Slider goniometerScaleRotarySlider;
     
     void initMenus();
     
+    // Keeps the menus in step with the tree when a host automates the settings
+    void valueTreePropertyChanged(juce::ValueTree&, const juce::Identifier&) override;
+    void refreshMenus();
+    
     //==============================================================================
     
-    int pluginWidth { 720 };
-    int pluginHeight { 620 };
+    int pluginWidth { 1000 };
+    int oscilloscopeWidth { 270 };
+    int dynamicsMeterHeight { 80 };
+    int lowEndMeterHeight { 70 };
+    int pluginHeight { 780 };
+    int scrollingWaveformHeight { 150 };
+    int thirdOctaveMeterWidth { 320 };
 
     int refreshRateHz { 60 };
     
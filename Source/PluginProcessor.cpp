@@ -28,10 +28,21 @@ PFM10AudioProcessor::PFM10AudioProcessor()
 #endif
     
     initDefaultValueTree(valueTree);
+    meterParameters = std::make_unique<MeterParameters>(*this, valueTree);
+    instanceSlot = instanceRegistry->acquireSlot();
+    
+    if (MeterPublisher::isEnabledByEnvironment())
+        meterPublisher = std::make_unique<MeterPublisher>();
+    analysisHistory.setCapacity(valueTree.getProperty(IDs::historyLength));
 }
 
 PFM10AudioProcessor::~PFM10AudioProcessor()
 {
+    stopMeterLog();
+    finishOfflineRender();
+    
+    instanceRegistry->releaseSlot(instanceSlot);
+    
 #if PERFETTO
     MelatoninPerfetto::get().endSession();
 #endif
@@ -100,11 +111,28 @@ void PFM10AudioProcessor::changeProgramName (__attribute__((unused)) int index,
 }
 
 //==============================================================================
-void PFM10AudioProcessor::prepareToPlay (__attribute__((unused)) double sampleRate, int samplesPerBlock)
+void PFM10AudioProcessor::prepareToPlay (double sampleRate, int samplesPerBlock)
 {
     TRACE_DSP();
     
     audioBufferFifo.prepare(samplesPerBlock, getTotalNumOutputChannels());
+    historyRing.prepare(sampleRate, samplesPerBlock);
+    levelHeatmap.prepare(sampleRate);
+    
+    // A render that is still open ended with the previous settings
+    finishOfflineRender();
+    
+    currentSampleRate = sampleRate;
+    currentBlockSize = samplesPerBlock;
+    meterLogAccumulator.prepare(sampleRate, meterLogFrameIntervalMs);
+    activityMonitor.prepare(sampleRate);
+    peakTracker.prepare(sampleRate);
+    
+    if (meterPublisher != nullptr)
+    {
+        meterPublisher->prepare(sampleRate);
+        meterPublisherAccumulator.prepare(sampleRate, MeterPublisher::frameIntervalMs);
+    }
     
 #if USE_TEST_OSCILLATOR
     juce::dsp::ProcessSpec processSpec;
@@ -121,6 +149,7 @@ void PFM10AudioProcessor::releaseResources()
 {
     // When playback stops, you can use this as an opportunity to free up any
     // spare memory, etc.
+    finishOfflineRender();
 }
 
 #ifndef JucePlugin_PreferredChannelConfigurations
@@ -185,13 +214,117 @@ void PFM10AudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, __attr
     gain.process( juce::dsp::ProcessContextReplacing<float>(audioBlock) );
 #endif
     
-    audioBufferFifo.push(buffer);
+    juce::int64 hostTimeInSamples = -1;
+    bool hostIsPlaying = false;
+    
+    if (auto* playHead = getPlayHead())
+    {
+        if (auto position = playHead->getPosition())
+        {
+            if (auto timeInSamples = position->getTimeInSamples())
+                hostTimeInSamples = *timeInSamples;
+            
+            hostIsPlaying = position->getIsPlaying();
+        }
+    }
+    
+    // A log started since the last block begins with a fresh frame. Reset here, on
+    // the audio thread, so the message thread never touches the accumulator.
+    if (meterLogWriter.beginBlock())
+        meterLogAccumulator.reset();
+    
+    // Block levels, worked out once for everything below that only needs those
+    auto summary = BlockSummary::fromBuffer(buffer);
+    
+    activityMonitor.process(summary, hostIsPlaying);
+    
+    if (isNonRealtime())
+        processOfflineRender(buffer, hostTimeInSamples, hostIsPlaying);
+    
+    // The low-end readings are only shown by the editor
+    peakTracker.process(buffer, summary, editorIsOpen.load());
+    
+    // Always, so the heatmap's time base doesn't stop while the editor is closed or parked
+    levelHeatmap.pushBlock(juce::Decibels::gainToDecibels(summary.getMonoMagnitude(), NEGATIVE_INFINITY), summary.numSamples);
+    
+    // A parked editor doesn't pull, so don't leave it a FIFO of stale silence
+    if (! activityMonitor.isWaitingForActivity())
+    {
+        audioBufferFifo.push(buffer);
+        
+        if (editorIsOpen.load())
+            historyRing.write(buffer);
+    }
+    
+    if (instanceSlot != nullptr)
+        instanceSlot->publishBlock(summary);
+    
+    if (meterLogWriter.isActive() || meterPublisher != nullptr)
+    {
+        float thresholdDb = meterParameters->getThresholdDb();
+        
+        if (meterLogWriter.isActive())
+            meterLogAccumulator.process(buffer, hostTimeInSamples, hostIsPlaying, thresholdDb, meterLogWriter);
+        
+        if (meterPublisher != nullptr)
+            meterPublisherAccumulator.process(buffer, hostTimeInSamples, hostIsPlaying, thresholdDb, *meterPublisher);
+    }
     
 #if USE_TEST_OSCILLATOR && MUTE_TEST_OSCILLATOR
     buffer.clear();
 #endif
 }
 
+void PFM10AudioProcessor::setNonRealtime (bool isNonRealtime) noexcept
+{
+    AudioProcessor::setNonRealtime(isNonRealtime);
+    
+    if (! isNonRealtime)
+        finishOfflineRender();
+}
+
+void PFM10AudioProcessor::processOfflineRender (const juce::AudioBuffer<float>& buffer,
+                                                juce::int64 hostTimeInSamples,
+                                                bool hostIsPlaying)
+{
+    const juce::ScopedLock lock(offlineRenderLock);
+    
+    // Started here rather than in setNonRealtime(), the host may prepare again in between
+    if (offlineRender == nullptr)
+    {
+        // Off unless asked for: every instance would otherwise leave files behind on every bounce and freeze
+        if (! meterParameters->areRenderReportsEnabled())
+            return;
+        
+        offlineRender = std::make_unique<OfflineRender>(createLogFile("PFM10_Render", ".pfmlog"),
+                                                        getTrackName(),
+                                                        currentSampleRate,
+                                                        currentBlockSize);
+    }
+    
+    offlineRender->process(buffer, hostTimeInSamples, hostIsPlaying, meterParameters->getThresholdDb());
+}
+
+void PFM10AudioProcessor::finishOfflineRender()
+{
+    const juce::ScopedLock lock(offlineRenderLock);
+    
+    if (offlineRender == nullptr)
+        return;
+    
+    lastRenderReport = offlineRender->finish();
+    offlineRender.reset();
+    
+    // Asynchronous, an open editor shows the path on the message thread
+    renderReportBroadcaster.sendChangeMessage();
+}
+
+juce::File PFM10AudioProcessor::getLastRenderReport() const
+{
+    const juce::ScopedLock lock(offlineRenderLock);
+    return lastRenderReport;
+}
+
 //==============================================================================
 bool PFM10AudioProcessor::hasEditor() const
 {
@@ -213,6 +346,10 @@ void PFM10AudioProcessor::getStateInformation (juce::MemoryBlock& destData)
     juce::MemoryOutputStream outputStream = juce::MemoryOutputStream(destData, false);
     
     valueTree.writeToStream(outputStream);
+    
+    // Older versions stop reading at the end of the tree, so the history chunk can follow it
+    if (analysisHistory.getCapacity() > 0)
+        analysisHistory.writeToStream(outputStream);
 }
 
 void PFM10AudioProcessor::setStateInformation (const void* data, int sizeInBytes)
@@ -220,16 +357,104 @@ void PFM10AudioProcessor::setStateInformation (const void* data, int sizeInBytes
     // You should use this method to restore your parameters from this memory block,
     // whose contents will have been created by the getStateInformation() call.
     
-    juce::ValueTree loadedTree = juce::ValueTree::readFromData(data, static_cast<size_t>(sizeInBytes));
+    juce::MemoryInputStream inputStream(data, static_cast<size_t>(sizeInBytes), false);
+    juce::ValueTree loadedTree = juce::ValueTree::readFromStream(inputStream);
     
     if (loadedTree.isValid() && hasNeededProperties(loadedTree))
     {
-        valueTree.copyPropertiesAndChildrenFrom(loadedTree, nullptr);
+        // State saved by an older version lacks the settings added since, those start at their defaults
+        juce::ValueTree defaults(loadedTree.getType());
+        initDefaultValueTree(defaults);
+        
+        for (int i = 0; i < defaults.getNumProperties(); ++i)
+        {
+            auto name = defaults.getPropertyName(i);
+            
+            if (! loadedTree.hasProperty(name))
+                loadedTree.setProperty(name, defaults.getProperty(name), nullptr);
+        }
+        
+        // One notification for the whole state rather than one per property
+        SettingsBatch::apply(valueTree, loadedTree);
     }
     else
     {
         // Do nothing. Do not overwrite the value tree's default values.
+        return;
     }
+    
+    analysisHistory.setCapacity(valueTree.getProperty(IDs::historyLength));
+    
+    if (analysisHistory.getCapacity() > 0 && ! inputStream.isExhausted())
+        analysisHistory.readFromStream(inputStream);
+}
+
+void PFM10AudioProcessor::updateTrackProperties (const TrackProperties& properties)
+{
+    if (properties.name.isEmpty())
+        return;
+    
+    if (instanceSlot != nullptr)
+        instanceSlot->setName(properties.name);
+    
+    if (meterPublisher != nullptr)
+        meterPublisher->setName(properties.name);
+}
+
+//==============================================================================
+
+bool PFM10AudioProcessor::startMeterLog (const juce::File& file)
+{
+    // The audio thread resets the accumulator itself on its next block, see MeterLogWriter::beginBlock()
+    return meterLogWriter.start(file, currentSampleRate, meterLogFrameIntervalMs);
+}
+
+void PFM10AudioProcessor::stopMeterLog()
+{
+    meterLogWriter.stop();
+}
+
+juce::File PFM10AudioProcessor::getLogsFolder()
+{
+    return juce::File::getSpecialLocation(juce::File::userDocumentsDirectory).getChildFile("PFM10 Logs");
+}
+
+juce::File PFM10AudioProcessor::createLogFile(const juce::String& prefix, const juce::String& extension) const
+{
+    auto baseName = prefix;
+    
+    auto trackName = juce::File::createLegalFileName(getTrackName());
+    if (trackName.isNotEmpty())
+        baseName << "_" << trackName;
+    
+    baseName << "_" << juce::Time::getCurrentTime().formatted("%Y-%m-%d_%H-%M-%S");
+    
+    auto logsFolder = getLogsFolder();
+    if (! logsFolder.createDirectory())
+        return {};
+    
+    // getNonexistentChildFile() only looks, so the look and the create happen under one lock:
+    // the mutex for the instances in this process, the InterProcessLock for the ones in others
+    static std::mutex mutex;
+    const std::lock_guard<std::mutex> lock(mutex);
+    
+    juce::InterProcessLock interProcessLock("PFM10_Logs");
+    const juce::InterProcessLock::ScopedLockType interProcessScopedLock(interProcessLock);
+    
+    if (! interProcessScopedLock.isLocked())
+        return {};
+    
+    auto file = logsFolder.getNonexistentChildFile(baseName, extension, false);
+    
+    if (! file.create().wasOk())
+        return {};
+    
+    return file;
+}
+
+juce::String PFM10AudioProcessor::getTrackName() const
+{
+    return instanceSlot != nullptr ? instanceSlot->getName() : juce::String();
 }
 
 //==============================================================================
@@ -244,6 +469,14 @@ void PFM10AudioProcessor::initDefaultValueTree (juce::ValueTree& tree)
     tree.setProperty(IDs::peakHoldInf,       DefaultPropertyValues::peakHoldInf,       nullptr);
     tree.setProperty(IDs::peakHoldDuration,  DefaultPropertyValues::peakHoldDuration,  nullptr);
     tree.setProperty(IDs::goniometerScale,   DefaultPropertyValues::goniometerScale,   nullptr);
+    tree.setProperty(IDs::historyLength,     DefaultPropertyValues::historyLength,     nullptr);
+    tree.setProperty(IDs::scopeTrigger,      DefaultPropertyValues::scopeTrigger,      nullptr);
+    tree.setProperty(IDs::scopeWindowMs,     DefaultPropertyValues::scopeWindowMs,     nullptr);
+    tree.setProperty(IDs::waveformSeconds,   DefaultPropertyValues::waveformSeconds,   nullptr);
+    tree.setProperty(IDs::heatmapZoom,       DefaultPropertyValues::heatmapZoom,       nullptr);
+    tree.setProperty(IDs::dynamicsWindowSeconds, DefaultPropertyValues::dynamicsWindowSeconds, nullptr);
+    tree.setProperty(IDs::spectrumResolution, DefaultPropertyValues::spectrumResolution, nullptr);
+    tree.setProperty(IDs::renderReports,     DefaultPropertyValues::renderReports,     nullptr);
 }
 
 bool PFM10AudioProcessor::hasNeededProperties (juce::ValueTree& tree)
@@ -15,6 +15,16 @@
 #include <array>
 #include "Identifiers.h"
 #include "DefaultPropertyValues.h"
+#include "MeterLog.h"
+#include "AnalysisHistory.h"
+#include "LevelHeatmap.h"
+#include "SettingsBatch.h"
+#include "MeterParameters.h"
+#include "InstanceRegistry.h"
+#include "MeterPublisher.h"
+#include "ActivityMonitor.h"
+#include "OfflineRender.h"
+#include "AudioSampleRing.h"
 
 template<typename T, size_t Size>           // T will be juce::AudioBuffer<float>
 struct Fifo
@@ -90,6 +100,7 @@ public:
    #endif
 
     void processBlock (juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
+    void setNonRealtime (bool isNonRealtime) noexcept override;
 
     //==============================================================================
     juce::AudioProcessorEditor* createEditor() override;
@@ -114,10 +125,63 @@ public:
     void getStateInformation (juce::MemoryBlock& destData) override;
     void setStateInformation (const void* data, int sizeInBytes) override;
     
+    void updateTrackProperties (const TrackProperties& properties) override;
+    
     //==============================================================================
     juce::ValueTree valueTree;
     Fifo<juce::AudioBuffer<float>, 6> audioBufferFifo;
     
+    // Every sample, in order, for the editor's histories (scope, waveform, analysers).
+    // The block FIFO above may skip blocks, which only the instantaneous meters can live with.
+    AudioSampleRing historyRing;
+    
+    // Set by the editor while it exists, so nothing is queued for displays that aren't there
+    std::atomic<bool> editorIsOpen { false };
+    
+    // Fed by the editor, saved with the state
+    AnalysisHistory analysisHistory;
+    
+    // Fed with every block's level, one column per second of audio, and drained
+    // by the editor. Kept here so it outlives the editor, but not saved with the state.
+    LevelHeatmap levelHeatmap;
+    
+    // Automatable mirror of the settings tree, readable from the audio thread
+    std::unique_ptr<MeterParameters> meterParameters;
+    
+    // Transport stopped and input silent: the editor parks while this is idle
+    ActivityMonitor activityMonitor;
+    
+    // Per-channel maximum over every sample since the editor last took it,
+    // plus the DC offset and sub-sonic level while the editor is open
+    PeakTracker peakTracker;
+    
+    //==============================================================================
+    // Session meter log (message thread)
+    static constexpr int meterLogFrameIntervalMs = 100;
+    bool startMeterLog(const juce::File& file);
+    void stopMeterLog();
+    bool isMeterLogActive() const { return meterLogWriter.isActive(); }
+    juce::File getMeterLogFile() const { return meterLogWriter.getFile(); }
+    static juce::File getLogsFolder();
+    
+    /* Claims a new, empty file in the logs folder, named after the prefix, this
+       instance's track once the host has named it, and the time. The name is
+       found and the file created under a lock every instance in every process
+       shares, so instances starting together never get the same file.
+       Returns File() if it couldn't be created.
+     */
+    juce::File createLogFile(const juce::String& prefix, const juce::String& extension) const;
+    juce::String getTrackName() const;
+    
+    //==============================================================================
+    // Offline render reports, written when IDs::renderReports is on. The
+    // broadcaster fires after each report is written.
+    juce::File getLastRenderReport() const;
+    juce::ChangeBroadcaster renderReportBroadcaster;
+    
+    //==============================================================================
+    InstanceRegistry& getInstanceRegistry() { return *instanceRegistry; }
+    
     //==============================================================================
 #if PERFETTO
     std::unique_ptr<perfetto::TracingSession> tracingSession;
@@ -128,6 +192,27 @@ private:
     void initDefaultValueTree (juce::ValueTree& tree);
     bool hasNeededProperties (juce::ValueTree& tree);
     
+    //==============================================================================
+    double currentSampleRate { 44100.0 };
+    MeterLogWriter meterLogWriter;
+    MeterLogAccumulator meterLogAccumulator;
+    
+    juce::SharedResourcePointer<InstanceRegistry> instanceRegistry;
+    InstanceSlot* instanceSlot { nullptr };     // nullptr if the registry was full
+    
+    // Only when PFM10_PUBLISH_METERS=1
+    std::unique_ptr<MeterPublisher> meterPublisher;
+    MeterLogAccumulator meterPublisherAccumulator;
+    
+    // Exists from the first non-realtime block until the render ends. Only locked
+    // while the host renders offline, never on the real-time path.
+    int currentBlockSize { 512 };
+    std::unique_ptr<OfflineRender> offlineRender;
+    juce::File lastRenderReport;
+    juce::CriticalSection offlineRenderLock;
+    void processOfflineRender(const juce::AudioBuffer<float>& buffer, juce::int64 hostTimeInSamples, bool hostIsPlaying);
+    void finishOfflineRender();
+    
     //==============================================================================
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PFM10AudioProcessor)
     
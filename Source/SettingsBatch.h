@@ -0,0 +1,37 @@
+//
+//  SettingsBatch.h
+//  PFM10 - Shared Code
+//
+//  Applies a whole set of settings to the tree with a single notification.
+//
+//  copyPropertiesAndChildrenFrom() notifies every listener once per changed
+//  property, and some listeners resize buffers or repaint each time. While a
+//  batch is being applied, listeners ignore individual property changes
+//  (isApplying()), and afterwards every listener receives one
+//  IDs::settingsChanged, on which it reloads everything it cares about.
+//
+//  Listeners are called synchronously on the thread applying the batch,
+//  so the flag only needs to be visible to that thread.
+//
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "Identifiers.h"
+
+struct SettingsBatch
+{
+    static void apply(juce::ValueTree& tree, const juce::ValueTree& source)
+    {
+        ++depth;
+        tree.copyPropertiesAndChildrenFrom(source, nullptr);
+        --depth;
+
+        if (depth == 0)
+            tree.sendPropertyChangeMessage(IDs::settingsChanged);
+    }
+
+    static bool isApplying() { return depth > 0; }
+private:
+    static inline thread_local int depth { 0 };
+};
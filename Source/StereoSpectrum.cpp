@@ -0,0 +1,311 @@
+//
+//  StereoSpectrum.cpp
+//  PFM10 - Shared Code
+//
+
+#include "StereoSpectrum.h"
+#include "MeterAnalysis.h"
+
+//==============================================================================
+//MARK: - StereoSpectrum
+
+std::shared_ptr<const StereoSpectrum::Plan> StereoSpectrum::getPlan(double sampleRate, int resolution)
+{
+    std::lock_guard<std::mutex> lock(planCache->mutex);
+
+    auto& cached = planCache->plans[{ sampleRate, resolution }];
+    if (cached == nullptr)
+        cached = buildPlan(sampleRate, resolution);
+
+    return cached;
+}
+
+std::shared_ptr<const StereoSpectrum::Plan> StereoSpectrum::buildPlan(double sampleRate, int resolution)
+{
+    auto plan = std::make_shared<Plan>();
+    bool multi = resolution == RESOLUTION_MULTI;
+
+    int fftOrder = multi ? 10 : 12;
+    int fftSize = 1 << fftOrder;
+
+    plan->fftSize = fftSize;
+    plan->fft = std::make_unique<juce::dsp::FFT>(fftOrder);
+
+    plan->window.resize(static_cast<size_t>(fftSize));
+    juce::dsp::WindowingFunction<float>::fillWindowingTables(plan->window.data(), static_cast<size_t>(fftSize),
+                                                             juce::dsp::WindowingFunction<float>::hann, false);
+
+    // A sine of amplitude a lands on its bin as a * sum(window) / 2
+    plan->binScale = 2.f / std::accumulate(plan->window.begin(), plan->window.end(), 0.f);
+
+    int numLevels = 1;
+    if (multi)
+    {
+        while (numLevels < maxLevels && sampleRate / (1 << (numLevels - 1)) / fftSize > targetLowBinWidthHz)
+            ++numLevels;
+    }
+
+    // DC and Nyquist carry no pan or phase worth showing
+    int octaveStart = (fftSize + 4) / 5;           // 0.2 of the rate, rounded up
+    int octaveEnd = 2 * octaveStart;
+
+    for (int n = 0; n < numLevels; ++n)
+    {
+        int first = n + 1 == numLevels ? 1 : octaveStart;
+        int end = n == 0 ? fftSize / 2 : octaveEnd;
+        plan->binRanges.emplace_back(first, end);
+    }
+
+    if (numLevels > 1)
+        plan->decimator = juce::dsp::FilterDesign<float>::designFIRLowpassHalfBandEquirippleMethod(0.1f, -90.f);
+
+    return plan;
+}
+
+void StereoSpectrum::prepare(double _sampleRate, int _resolution)
+{
+    sampleRate = _sampleRate;
+    resolution = _resolution;
+    plan = getPlan(sampleRate, resolution);
+
+    auto fftSize = static_cast<size_t>(plan->fftSize);
+    auto numLevels = plan->binRanges.size();
+
+    levels.clear();
+    levels.resize(numLevels);
+    bins.clear();
+
+    // Slowest level first, so the stitched bins run from low to high
+    for (size_t i = 0; i < numLevels; ++i)
+    {
+        size_t n = numLevels - 1 - i;
+        auto& level = levels[n];
+        auto [first, end] = plan->binRanges[n];
+        double levelRate = sampleRate / (1 << n);
+
+        for (auto& channel : level.history)
+            channel.assign(fftSize, 0.f);
+
+        if (plan->decimator != nullptr)
+            for (auto& decimator : level.decimators)
+                decimator = juce::dsp::FIR::Filter<float>(plan->decimator);
+
+        level.firstOutputBin = bins.size();
+        for (int k = first; k < end; ++k)
+        {
+            Bin bin;
+            bin.frequency = static_cast<float>(k * levelRate / plan->fftSize);
+            bins.push_back(bin);
+        }
+    }
+
+    fftData.assign(2 * fftSize, 0.f);
+
+    reset();
+}
+
+void StereoSpectrum::reset()
+{
+    for (auto& level : levels)
+    {
+        for (auto& channel : level.history)
+            std::fill(channel.begin(), channel.end(), 0.f);
+
+        level.writeIndex = 0;
+        for (auto& decimator : level.decimators)
+            decimator.reset();
+        level.keepNext = true;
+    }
+
+    samplesSinceFrame = 0;
+}
+
+void StereoSpectrum::push(const juce::AudioBuffer<float>& buffer, int startSample, int numSamples)
+{
+    int numChannels = buffer.getNumChannels();
+    if (numChannels == 0 || levels.empty())
+        return;
+
+    const float* left  = buffer.getReadPointer(0, startSample);
+    const float* right = buffer.getReadPointer(numChannels > 1 ? 1 : 0, startSample);
+    int fftMask = plan->fftSize - 1;
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        float l = left[i];
+        float r = right[i];
+
+        for (size_t n = 0; n < levels.size(); ++n)
+        {
+            auto& level = levels[n];
+            level.history[0][static_cast<size_t>(level.writeIndex)] = l;
+            level.history[1][static_cast<size_t>(level.writeIndex)] = r;
+            level.writeIndex = (level.writeIndex + 1) & fftMask;
+
+            if (n + 1 == levels.size())
+                break;
+
+            l = level.decimators[0].processSample(l);
+            r = level.decimators[1].processSample(r);
+
+            // Every second output goes on to the next level
+            bool keep = level.keepNext;
+            level.keepNext = ! keep;
+            if (! keep)
+                break;
+        }
+
+        if (++samplesSinceFrame == hopSize)
+        {
+            samplesSinceFrame = 0;
+            transform();
+        }
+    }
+}
+
+void StereoSpectrum::transform()
+{
+    int fftSize = plan->fftSize;
+
+    for (size_t n = 0; n < levels.size(); ++n)
+    {
+        const auto& level = levels[n];
+        auto [first, end] = plan->binRanges[n];
+
+        for (size_t ch = 0; ch < level.history.size(); ++ch)
+        {
+            // Unwrap the ring, oldest first
+            const auto& samples = level.history[ch];
+            for (int i = 0; i < fftSize; ++i)
+                fftData[static_cast<size_t>(i)] = samples[static_cast<size_t>((level.writeIndex + i) & (fftSize - 1))]
+                                                * plan->window[static_cast<size_t>(i)];
+
+            plan->fft->performRealOnlyForwardTransform(fftData.data(), true);
+
+            // Interleaved re/im from bin 0
+            for (int k = first; k < end; ++k)
+            {
+                auto index = static_cast<size_t>(k);
+                std::complex<float> value (fftData[2 * index] * plan->binScale, fftData[2 * index + 1] * plan->binScale);
+                auto& bin = bins[level.firstOutputBin + static_cast<size_t>(k - first)];
+
+                if (ch == 0)
+                    bin.left = value;
+                else
+                    bin.right = value;
+            }
+        }
+    }
+
+    listeners.call([this](Listener& l) { l.spectrumFrameReady(bins); });
+}
+
+//==============================================================================
+//MARK: - PanSpectrum
+
+void PanSpectrum::prepare(double frameRate)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    decay = static_cast<float>(std::exp(-1.0 / (decaySeconds * frameRate)));
+
+    energy.assign(numColumns * numRows, 0.f);
+    crossSum.assign(numColumns * numRows, 0.f);
+    crossMagnitudeSum.assign(numColumns * numRows, 0.f);
+    columnEnergy.assign(numColumns, 0.f);
+}
+
+void PanSpectrum::reset()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    std::fill(energy.begin(), energy.end(), 0.f);
+    std::fill(crossSum.begin(), crossSum.end(), 0.f);
+    std::fill(crossMagnitudeSum.begin(), crossMagnitudeSum.end(), 0.f);
+    std::fill(columnEnergy.begin(), columnEnergy.end(), 0.f);
+}
+
+float PanSpectrum::columnToFrequency(float column)
+{
+    return minFrequency * std::pow(maxFrequency / minFrequency, column / numColumns);
+}
+
+void PanSpectrum::spectrumFrameReady(const std::vector<StereoSpectrum::Bin>& bins)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    if (energy.empty())
+        return;
+
+    // Silence decays every cell into denormals
+    juce::ScopedNoDenormals noDenormals;
+
+    juce::FloatVectorOperations::multiply(energy.data(), decay, static_cast<int>(energy.size()));
+    juce::FloatVectorOperations::multiply(crossSum.data(), decay, static_cast<int>(crossSum.size()));
+    juce::FloatVectorOperations::multiply(crossMagnitudeSum.data(), decay, static_cast<int>(crossMagnitudeSum.size()));
+    juce::FloatVectorOperations::multiply(columnEnergy.data(), decay, static_cast<int>(columnEnergy.size()));
+
+    const float columnsPerLogHz = numColumns / std::log(maxFrequency / minFrequency);
+
+    for (const auto& bin : bins)
+    {
+        if (bin.frequency < minFrequency || bin.frequency >= maxFrequency)
+            continue;
+
+        float leftMagnitude = std::abs(bin.left);
+        float rightMagnitude = std::abs(bin.right);
+        float binEnergy = leftMagnitude * leftMagnitude + rightMagnitude * rightMagnitude;
+
+        if (binEnergy <= 0.f)
+            continue;
+
+        // Constant-power pan position: 0 for centre, -1 hard left, 1 hard right
+        float pan = std::atan2(rightMagnitude, leftMagnitude) / juce::MathConstants<float>::halfPi * 2.f - 1.f;
+
+        auto column = juce::jlimit(0, numColumns - 1, static_cast<int>(std::log(bin.frequency / minFrequency) * columnsPerLogHz));
+        auto row = juce::jlimit(0, numRows - 1, juce::roundToInt((pan + 1.f) / 2.f * (numRows - 1)));
+        auto cell = static_cast<size_t>(row * numColumns + column);
+
+        energy[cell] += binEnergy;
+        crossSum[cell] += std::real(bin.left * std::conj(bin.right));
+        crossMagnitudeSum[cell] += leftMagnitude * rightMagnitude;
+        columnEnergy[static_cast<size_t>(column)] += binEnergy;
+    }
+}
+
+void PanSpectrum::getGrid(std::vector<Cell>& cells, std::vector<float>& columnLevelsDb) const
+{
+    cells.assign(numColumns * numRows, Cell());
+    columnLevelsDb.assign(numColumns, NEGATIVE_INFINITY);
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    if (energy.empty())
+        return;
+
+    for (size_t column = 0; column < columnLevelsDb.size(); ++column)
+    {
+        float total = columnEnergy[column];
+        if (total <= 0.f)
+            continue;
+
+        // The decayed sum holds about 1 / (1 - decay) frames; one sine on both sides reads 0 dB
+        float perFrame = total * (1.f - decay) / 2.f;
+        columnLevelsDb[column] = juce::Decibels::gainToDecibels(std::sqrt(perFrame), NEGATIVE_INFINITY);
+
+        for (size_t row = 0; row < static_cast<size_t>(numRows); ++row)
+        {
+            size_t index = row * numColumns + column;
+            float cellEnergy = energy[index];
+
+            if (cellEnergy <= 0.f)
+                continue;
+
+            // Bins with one side all but silent have no phase to compare
+            float crossMagnitude = crossMagnitudeSum[index];
+            float correlation = crossMagnitude > minCrossShare * cellEnergy ? crossSum[index] / crossMagnitude : 0.f;
+
+            cells[index] = { cellEnergy / total, correlation };
+        }
+    }
+}
@@ -0,0 +1,174 @@
+//
+//  StereoSpectrum.h
+//  PFM10 - Shared Code
+//
+//  Complex left and right spectra of the input, one frame per hop, either
+//  from one linear FFT or stitched from FFTs of octave-decimated copies for
+//  an even resolution per octave. Every spectrum view listens to the same
+//  StereoSpectrum, so each block is transformed once however many views use
+//  it.
+//
+//  PanSpectrum turns those frames into a frequency-by-pan picture: for each
+//  bin, where it sits between the speakers and how well the two sides agree
+//  in phase, gathered into a grid of log-frequency columns and pan rows.
+//
+//  Not thread-safe apart from PanSpectrum's reads; the owner serialises
+//  push() and reset().
+//
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <complex>
+#include <map>
+#include <memory>
+#include <vector>
+
+//==============================================================================
+//MARK: - StereoSpectrum
+
+class StereoSpectrum
+{
+public:
+    enum Resolutions
+    {
+        RESOLUTION_LINEAR = 0,      // one 4096-point FFT
+        RESOLUTION_MULTI            // 1024-point FFTs on octave-decimated copies, stitched
+    };
+
+    static constexpr int hopSize = 1024;
+
+    // Scaled so a full-scale sine on a bin's centre has a magnitude of 1
+    struct Bin
+    {
+        float frequency { 0.f };
+        std::complex<float> left, right;
+    };
+
+    struct Listener
+    {
+        virtual ~Listener() = default;
+
+        // On the thread that called push(), once per hop
+        virtual void spectrumFrameReady(const std::vector<Bin>& bins) = 0;
+    };
+
+    void addListener(Listener* listener) { listeners.add(listener); }
+    void removeListener(Listener* listener) { listeners.remove(listener); }
+
+    void prepare(double sampleRate, int resolution = RESOLUTION_LINEAR);
+    void reset();
+
+    // Any number of samples; a mono buffer is both sides
+    void push(const juce::AudioBuffer<float>& buffer, int startSample, int numSamples);
+
+    double getSampleRate() const { return sampleRate; }
+    int getResolution() const { return resolution; }
+    double getFrameRate() const { return sampleRate / hopSize; }
+private:
+    /* Everything about a layout that only depends on the sample rate and
+       resolution: the FFT, the window, how many levels and which bins each
+       one contributes, and the half-band filter between levels. Built on
+       first use and shared by every instance after that, through a
+       PlanCache that goes away with the last StereoSpectrum.
+
+       Level n runs at sampleRate / 2^n. In the multi-resolution layout each
+       level gives the octave from 0.2 to 0.4 of its rate, which is clean of
+       the decimation's transition band and meets the level above exactly;
+       level 0 also gives the rest up to Nyquist and the slowest level
+       everything below. Levels are added until the slowest one's bins are
+       narrower than targetLowBinWidthHz.
+     */
+    struct Plan
+    {
+        int fftSize { 0 };
+        std::unique_ptr<juce::dsp::FFT> fft;
+        std::vector<float> window;
+        float binScale { 1.f };
+        std::vector<std::pair<int, int>> binRanges;    // per level, [first, end)
+        juce::dsp::FIR::Coefficients<float>::Ptr decimator;
+    };
+
+    static constexpr int maxLevels = 8;
+    static constexpr double targetLowBinWidthHz = 3.0;
+
+    struct PlanCache
+    {
+        std::mutex mutex;
+        std::map<std::pair<double, int>, std::shared_ptr<const Plan>> plans;
+    };
+
+    juce::SharedResourcePointer<PlanCache> planCache;
+
+    std::shared_ptr<const Plan> getPlan(double sampleRate, int resolution);
+    static std::shared_ptr<const Plan> buildPlan(double sampleRate, int resolution);
+
+    struct Level
+    {
+        // Last fftSize samples per channel at this level's rate, oldest at writeIndex
+        std::array<std::vector<float>, 2> history;
+        int writeIndex { 0 };
+
+        // Ahead of the next level, and which of their outputs it gets
+        std::array<juce::dsp::FIR::Filter<float>, 2> decimators;
+        bool keepNext { true };
+
+        size_t firstOutputBin { 0 };
+    };
+
+    double sampleRate { 44100.0 };
+    int resolution { RESOLUTION_LINEAR };
+    std::shared_ptr<const Plan> plan;
+    std::vector<Level> levels;
+    int samplesSinceFrame { 0 };
+
+    std::vector<float> fftData;
+    std::vector<Bin> bins;          // stitched, lowest frequency first
+
+    juce::ListenerList<Listener> listeners;
+
+    void transform();
+};
+
+//==============================================================================
+//MARK: - PanSpectrum
+
+class PanSpectrum : public StereoSpectrum::Listener
+{
+public:
+    static constexpr int numColumns = 120;      // log frequency
+    static constexpr int numRows = 41;          // hard left to hard right
+    static constexpr float minFrequency = 20.f;
+    static constexpr float maxFrequency = 20000.f;
+    static constexpr double decaySeconds = 1.0;
+
+    struct Cell
+    {
+        float share { 0.f };                    // of its column's energy
+        float correlation { 0.f };              // cos of the phase difference, weighted by |L||R|, -1..1
+    };
+
+    void prepare(double frameRate);
+    void reset();
+
+    void spectrumFrameReady(const std::vector<StereoSpectrum::Bin>& bins) override;
+
+    /* Copies the grid, row-major from hard left, and each column's level in
+       dB. A column no bin has fallen into reads NEGATIVE_INFINITY. Safe to
+       call from any thread.
+     */
+    void getGrid(std::vector<Cell>& cells, std::vector<float>& columnLevelsDb) const;
+
+    static float columnToFrequency(float column);
+private:
+    mutable std::mutex mutex;
+
+    static constexpr float minCrossShare = 1.0e-3f;
+
+    float decay { 0.f };
+
+    // numColumns * numRows: |L|^2 + |R|^2, Re(L R*) and |L||R|, each decayed per frame
+    std::vector<float> energy, crossSum, crossMagnitudeSum;
+    std::vector<float> columnEnergy;
+};
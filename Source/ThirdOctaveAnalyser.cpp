@@ -0,0 +1,295 @@
+//
+//  ThirdOctaveAnalyser.cpp
+//  PFM10 - Shared Code
+//
+
+#include "ThirdOctaveAnalyser.h"
+#include "MeterAnalysis.h"
+#include <complex>
+
+namespace
+{
+    const char* const nominalBandLabels[ThirdOctaveAnalyser::numBands]
+    {
+        "20", "25", "31.5", "40", "50", "63", "80", "100", "125", "160",
+        "200", "250", "315", "400", "500", "630", "800", "1k", "1.25k", "1.6k",
+        "2k", "2.5k", "3.15k", "4k", "5k", "6.3k", "8k", "10k", "12.5k", "16k",
+        "20k"
+    };
+
+    // Band 17 is 1 kHz
+    constexpr int referenceBand = 17;
+
+    // A band runs on the slowest stage that keeps its centre below rate / this
+    constexpr double minRateOverCentre = 10.0;
+
+    // Bands whose upper edge reaches this share of the rate are left out
+    constexpr double maxUpperEdgeOverRate = 0.49;
+
+    // RBJ low-pass as { b0, b1, b2, a1, a2 }
+    std::array<float, 5> makeLowPass(double cutoffOverRate, double q)
+    {
+        double w0 = juce::MathConstants<double>::twoPi * cutoffOverRate;
+        double cosW0 = std::cos(w0);
+        double alpha = std::sin(w0) / (2.0 * q);
+        double a0 = 1.0 + alpha;
+
+        return { static_cast<float>((1.0 - cosW0) / 2.0 / a0),
+                 static_cast<float>((1.0 - cosW0) / a0),
+                 static_cast<float>((1.0 - cosW0) / 2.0 / a0),
+                 static_cast<float>(-2.0 * cosW0 / a0),
+                 static_cast<float>((1.0 - alpha) / a0) };
+    }
+}
+
+double ThirdOctaveAnalyser::getCentreFrequency(int band)
+{
+    return 1000.0 * std::pow(10.0, (band - referenceBand) / 10.0);
+}
+
+juce::String ThirdOctaveAnalyser::getBandLabel(int band)
+{
+    return nominalBandLabels[band];
+}
+
+void ThirdOctaveAnalyser::prepare(double sampleRate)
+{
+    int numStages = 1;
+
+    for (int band = 0; band < numBands; ++band)
+    {
+        double centre = getCentreFrequency(band);
+        auto index = static_cast<size_t>(band);
+
+        if (centre * std::pow(10.0, 0.05) >= maxUpperEdgeOverRate * sampleRate)
+        {
+            bandStage[index] = -1;
+            continue;
+        }
+
+        int stage = 0;
+        while (stage + 1 < maxStages && centre * minRateOverCentre <= sampleRate / (1 << (stage + 1)))
+            ++stage;
+
+        bandStage[index] = stage;
+        numStages = juce::jmax(numStages, stage + 1);
+    }
+
+    stages.assign(static_cast<size_t>(numStages), Stage());
+
+    for (size_t n = 0; n < stages.size(); ++n)
+    {
+        auto& stage = stages[n];
+        stage.sampleRate = sampleRate / (1 << n);
+
+        // 4th-order Butterworth at a tenth of the rate: flat over the next stage's
+        // bands, and well down where the decimation folds back onto them
+        stage.lowPass[0] = makeLowPass(0.1, 0.5411961);
+        stage.lowPass[1] = makeLowPass(0.1, 1.3065630);
+
+        for (int band = 0; band < numBands; ++band)
+        {
+            if (bandStage[static_cast<size_t>(band)] != static_cast<int>(n))
+                continue;
+
+            // Fill the last pack's lanes before starting a new one
+            if (stage.packs.empty() || stage.packs.back().bands[Lanes::SIMDNumElements - 1] >= 0)
+            {
+                stage.packs.emplace_back();
+                auto& pack = stage.packs.back();
+                pack.bands.fill(-1);
+
+                for (auto* coefficients : { &pack.b0, &pack.a1, &pack.a2 })
+                    coefficients->fill(Lanes::expand(0.f));
+            }
+
+            auto& pack = stage.packs.back();
+            size_t lane = 0;
+            while (pack.bands[lane] >= 0)
+                ++lane;
+
+            pack.bands[lane] = band;
+            designBandpass(pack, lane, getCentreFrequency(band), stage.sampleRate);
+        }
+    }
+
+    reset();
+}
+
+void ThirdOctaveAnalyser::designBandpass(Pack& pack, size_t lane, double centreHz, double sampleRate)
+{
+    using Complex = std::complex<double>;
+
+    // Prewarped base-10 band edges, then the analog bandpass they define
+    double c = 2.0 * sampleRate;
+    double lower = c * std::tan(juce::MathConstants<double>::pi * centreHz * std::pow(10.0, -0.05) / sampleRate);
+    double upper = c * std::tan(juce::MathConstants<double>::pi * centreHz * std::pow(10.0, 0.05) / sampleRate);
+    double w0 = std::sqrt(lower * upper);
+    double bandwidth = upper - lower;
+
+    // 3rd-order Butterworth prototype: -1 and -1/2 +- j sqrt(3)/2. s -> (s^2 + w0^2) / (B s)
+    // turns each prototype pole p into the roots of s^2 - p B s + w0^2; the upper-half-plane
+    // root of -1 and both roots of -1/2 + j sqrt(3)/2 each pair with their conjugate.
+    auto roots = [w0, bandwidth](Complex p)
+    {
+        Complex root = std::sqrt(p * p * bandwidth * bandwidth - 4.0 * w0 * w0);
+        return std::array<Complex, 2> { (p * bandwidth + root) / 2.0, (p * bandwidth - root) / 2.0 };
+    };
+
+    auto realRoots = roots(Complex(-1.0, 0.0));
+    auto complexRoots = roots(Complex(-0.5, std::sqrt(3.0) / 2.0));
+    std::array<Complex, numSections> poles { realRoots[0].imag() > 0 ? realRoots[0] : realRoots[1],
+                                             complexRoots[0],
+                                             complexRoots[1] };
+
+    // Unity gain at the centre, section by section
+    Complex zCentre = std::polar(1.0, 2.0 * std::atan(w0 / c));
+
+    for (size_t s = 0; s < numSections; ++s)
+    {
+        // H(s) = s / (s^2 - 2 Re(pole) s + |pole|^2) through the bilinear transform
+        double a1Analog = -2.0 * poles[s].real();
+        double a0Analog = std::norm(poles[s]);
+
+        double den0 = c * c + a1Analog * c + a0Analog;
+        double a1 = (2.0 * a0Analog - 2.0 * c * c) / den0;
+        double a2 = (c * c - a1Analog * c + a0Analog) / den0;
+        double b0 = c / den0;
+
+        Complex zInv = 1.0 / zCentre;
+        double gain = std::abs(b0 * (1.0 - zInv * zInv) / (1.0 + a1 * zInv + a2 * zInv * zInv));
+        b0 /= gain;
+
+        pack.b0[s].set(lane, static_cast<float>(b0));
+        pack.a1[s].set(lane, static_cast<float>(a1));
+        pack.a2[s].set(lane, static_cast<float>(a2));
+    }
+}
+
+void ThirdOctaveAnalyser::reset()
+{
+    for (auto& stage : stages)
+    {
+        for (auto& pack : stage.packs)
+        {
+            pack.s1.fill(Lanes::expand(0.f));
+            pack.s2.fill(Lanes::expand(0.f));
+            pack.energy = Lanes::expand(0.f);
+        }
+
+        stage.numSamples = 0;
+        for (auto& state : stage.lowPassState)
+            state.fill(0.f);
+        stage.keepNext = true;
+    }
+
+    // < 0 until the band's first frame
+    weightedMeanSquare.fill(-1.0);
+}
+
+void ThirdOctaveAnalyser::process(const juce::AudioBuffer<float>& buffer, int startSample, int numSamples)
+{
+    int numChannels = buffer.getNumChannels();
+    if (numChannels == 0 || stages.empty())
+        return;
+
+    // The low stages ring down to denormals on silence. This runs on the editor's
+    // update thread, which unlike the host's audio thread doesn't flush them already.
+    juce::ScopedNoDenormals noDenormals;
+
+    const float* left  = buffer.getReadPointer(0, startSample);
+    const float* right = buffer.getReadPointer(numChannels > 1 ? 1 : 0, startSample);
+
+    for (int i = 0; i < numSamples; ++i)
+        processSample(0.5f * (left[i] + right[i]));
+}
+
+void ThirdOctaveAnalyser::processSample(float x)
+{
+    for (size_t n = 0; n < stages.size(); ++n)
+    {
+        auto& stage = stages[n];
+        auto input = Lanes::expand(x);
+
+        for (auto& pack : stage.packs)
+        {
+            auto y = input;
+
+            for (size_t s = 0; s < numSections; ++s)
+            {
+                auto in = y;
+                y = pack.b0[s] * in + pack.s1[s];
+                pack.s1[s] = pack.s2[s] - pack.a1[s] * y;
+                pack.s2[s] = Lanes::expand(0.f) - pack.b0[s] * in - pack.a2[s] * y;
+            }
+
+            pack.energy += y * y;
+        }
+
+        ++stage.numSamples;
+
+        if (n + 1 == stages.size())
+            return;
+
+        for (size_t s = 0; s < stage.lowPass.size(); ++s)
+        {
+            auto& k = stage.lowPass[s];
+            auto& z = stage.lowPassState[s];
+
+            float y = k[0] * x + z[0];
+            z[0] = k[1] * x - k[3] * y + z[1];
+            z[1] = k[2] * x - k[4] * y;
+            x = y;
+        }
+
+        // Every second output goes on to the next stage
+        bool keep = stage.keepNext;
+        stage.keepNext = ! keep;
+        if (! keep)
+            return;
+    }
+}
+
+void ThirdOctaveAnalyser::takeLevels(std::array<float, numBands>& levelsDb)
+{
+    for (auto& stage : stages)
+    {
+        if (stage.numSamples == 0)
+            continue;
+
+        double frameSeconds = static_cast<double>(stage.numSamples) / stage.sampleRate;
+        double coefficient = 1.0 - std::exp(-frameSeconds / integrationSeconds);
+
+        for (auto& pack : stage.packs)
+        {
+            for (size_t lane = 0; lane < Lanes::SIMDNumElements; ++lane)
+            {
+                int band = pack.bands[lane];
+                if (band < 0)
+                    continue;
+
+                double meanSquare = pack.energy.get(lane) / static_cast<double>(stage.numSamples);
+                double& weighted = weightedMeanSquare[static_cast<size_t>(band)];
+
+                if (weighted < 0.0)
+                    weighted = meanSquare;
+                else
+                    weighted += coefficient * (meanSquare - weighted);
+            }
+
+            pack.energy = Lanes::expand(0.f);
+        }
+
+        stage.numSamples = 0;
+    }
+
+    for (size_t band = 0; band < levelsDb.size(); ++band)
+    {
+        double weighted = weightedMeanSquare[band];
+
+        // A sine's mean square is half its peak squared
+        levelsDb[band] = weighted < 0.0 ? NEGATIVE_INFINITY
+                                        : juce::Decibels::gainToDecibels(static_cast<float>(std::sqrt(2.0 * weighted)),
+                                                                         NEGATIVE_INFINITY);
+    }
+}
@@ -0,0 +1,85 @@
+//
+//  ThirdOctaveAnalyser.h
+//  PFM10 - Shared Code
+//
+//  31-band 1/3-octave analyser, 20 Hz to 20 kHz, on the mono sum. Each band
+//  is a 6th-order Butterworth bandpass between the IEC 61260 base-10 band
+//  edges, built from three biquad sections. Bands are packed into SIMD
+//  lanes (4 or 8, whatever juce::dsp::SIMDRegister<float> holds on this
+//  build), so one pass of the sections filters a whole pack.
+//
+//  The low bands run on decimated copies of the input: stage n runs at
+//  sampleRate / 2^n behind a 4th-order low-pass, and each band lives on the
+//  slowest stage that keeps it below a tenth of the stage's rate. Every
+//  octave further down costs half as much, so the 20 Hz band costs next to
+//  nothing.
+//
+//  Band energy is summed per sample and integrated per frame: takeLevels()
+//  folds the frame's mean square into an exponential "Fast" (125 ms) time
+//  weighting. Not thread-safe; the owner serialises process() against
+//  takeLevels().
+//
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <vector>
+
+class ThirdOctaveAnalyser
+{
+public:
+    static constexpr int numBands = 31;
+    static constexpr int numSections = 3;
+    static constexpr int maxStages = 12;
+    static constexpr double integrationSeconds = 0.125;
+
+    using Lanes = juce::dsp::SIMDRegister<float>;
+    static constexpr int numLanes = static_cast<int>(Lanes::SIMDNumElements);
+
+    // Exact base-10 centre, and the nominal one for labels ("31.5", "1k")
+    static double getCentreFrequency(int band);
+    static juce::String getBandLabel(int band);
+
+    void prepare(double sampleRate);
+    void reset();
+
+    // Any number of samples; a stereo buffer is analysed as (L + R) / 2
+    void process(const juce::AudioBuffer<float>& buffer, int startSample, int numSamples);
+
+    /* Time-weighted band levels, with a full-scale sine at the band centre
+       reading 0 dB like the level meters. Bands at or above Nyquist, and
+       bands that have seen nothing yet, read NEGATIVE_INFINITY.
+     */
+    void takeLevels(std::array<float, numBands>& levelsDb);
+
+    bool isBandActive(int band) const { return bandStage[static_cast<size_t>(band)] >= 0; }
+private:
+    struct Pack
+    {
+        // Transposed direct form II, one band per lane. A bandpass section's
+        // numerator is b0 * (1 - z^-2), so b0 is the only one kept.
+        std::array<Lanes, numSections> b0, a1, a2, s1, s2;
+        Lanes energy;
+        std::array<int, Lanes::SIMDNumElements> bands;     // -1 for an unused lane
+    };
+
+    struct Stage
+    {
+        double sampleRate { 44100.0 };
+        std::vector<Pack> packs;
+        juce::int64 numSamples { 0 };           // since the last takeLevels()
+
+        // Anti-alias low-pass ahead of the next stage, and which of its outputs to keep
+        std::array<std::array<float, 5>, 2> lowPass {};
+        std::array<std::array<float, 2>, 2> lowPassState {};
+        bool keepNext { true };
+    };
+
+    std::vector<Stage> stages;
+    std::array<int, numBands> bandStage;
+    std::array<double, numBands> weightedMeanSquare;
+
+    void processSample(float x);
+    static void designBandpass(Pack& pack, size_t lane, double centreHz, double sampleRate);
+};
@@ -0,0 +1,218 @@
+//
+//  WaveformHistory.cpp
+//  PFM10 - Shared Code
+//
+
+#include "WaveformHistory.h"
+
+void WaveformHistory::prepare(double _sampleRate, double historySeconds)
+{
+    sampleRate = _sampleRate;
+
+    capacity = juce::nextPowerOfTwo(juce::jmax(1, static_cast<int>(std::ceil(sampleRate * historySeconds))));
+    mask = capacity - 1;
+    samples.assign(static_cast<size_t>(capacity), 0.f);
+
+    levels.clear();
+    juce::int64 entrySize = summaryFanout;
+    while (levels.size() < maxLevels && entrySize <= capacity)
+    {
+        levels.emplace_back(static_cast<size_t>(capacity / entrySize));
+        entrySize *= summaryFanout;
+    }
+
+    clear();
+}
+
+void WaveformHistory::clear()
+{
+    numWritten = 0;
+    std::fill(samples.begin(), samples.end(), 0.f);
+}
+
+void WaveformHistory::push(const juce::AudioBuffer<float>& buffer)
+{
+    int numChannels = buffer.getNumChannels();
+    int numSamples = buffer.getNumSamples();
+    if (numChannels == 0 || capacity == 0)
+        return;
+
+    const float* left  = buffer.getReadPointer(0);
+    const float* right = buffer.getReadPointer(numChannels > 1 ? 1 : 0);
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        samples[static_cast<size_t>(numWritten & mask)] = (left[i] + right[i]) * 0.5f;
+        ++numWritten;
+
+        if (numWritten % summaryFanout == 0)
+            summarise(numWritten);
+    }
+}
+
+void WaveformHistory::summarise(juce::int64 endPosition)
+{
+    // Every level whose entry ends at endPosition is now complete, finest first
+    juce::int64 entrySize = summaryFanout;
+
+    for (size_t n = 0; n < levels.size() && endPosition % entrySize == 0; ++n)
+    {
+        juce::int64 index = endPosition / entrySize - 1;
+        Span span;
+
+        if (n == 0)
+        {
+            for (juce::int64 p = endPosition - summaryFanout; p < endPosition; ++p)
+                span.add(getSample(p));
+        }
+        else
+        {
+            auto& finer = levels[n - 1];
+            auto finerMask = static_cast<juce::int64>(finer.size()) - 1;
+
+            for (juce::int64 k = index * summaryFanout; k < (index + 1) * summaryFanout; ++k)
+                span.add(finer[static_cast<size_t>(k & finerMask)]);
+        }
+
+        auto& level = levels[n];
+        level[static_cast<size_t>(index & (static_cast<juce::int64>(level.size()) - 1))] = span;
+
+        entrySize *= summaryFanout;
+    }
+}
+
+WaveformHistory::Span WaveformHistory::getEntry(int level, juce::int64 index) const
+{
+    if (level == 0)
+    {
+        Span span;
+        span.add(getSample(index));
+        return span;
+    }
+
+    auto& entries = levels[static_cast<size_t>(level - 1)];
+    return entries[static_cast<size_t>(index & (static_cast<juce::int64>(entries.size()) - 1))];
+}
+
+void WaveformHistory::getSpans(double startSample, double samplesPerColumn, int numColumns, std::vector<Span>& spans) const
+{
+    spans.assign(static_cast<size_t>(juce::jmax(0, numColumns)), Span());
+
+    if (capacity == 0 || samplesPerColumn <= 0)
+        return;
+
+    auto oldest = getOldestAvailable();
+
+    for (int column = 0; column < numColumns; ++column)
+    {
+        auto start = static_cast<juce::int64>(std::floor(startSample + column * samplesPerColumn));
+        auto end   = static_cast<juce::int64>(std::floor(startSample + (column + 1) * samplesPerColumn));
+        end = juce::jmax(end, start + 1);
+
+        start = juce::jmax(start, oldest);
+        end   = juce::jmin(end, numWritten);
+
+        if (start >= end)
+            continue;
+
+        // Coarsest level whose entries are no wider than the column
+        int level = 0;
+        juce::int64 entrySize = 1;
+        while (level < static_cast<int>(levels.size()) && entrySize * summaryFanout <= end - start)
+        {
+            entrySize *= summaryFanout;
+            ++level;
+        }
+
+        addRange(spans[static_cast<size_t>(column)], start, end, level);
+    }
+}
+
+void WaveformHistory::addRange(Span& span, juce::int64 start, juce::int64 end, int level) const
+{
+    if (start >= end)
+        return;
+
+    if (level == 0)
+    {
+        for (auto p = start; p < end; ++p)
+            span.add(getSample(p));
+        return;
+    }
+
+    juce::int64 entrySize = 1;
+    for (int n = 0; n < level; ++n)
+        entrySize *= summaryFanout;
+
+    // Whole entries only, the ragged ends come from the level below. end never
+    // passes numWritten, so every whole entry in range is already summarised.
+    juce::int64 first = (start + entrySize - 1) / entrySize;
+    juce::int64 last  = end / entrySize;
+
+    if (first >= last)
+    {
+        addRange(span, start, end, level - 1);
+        return;
+    }
+
+    addRange(span, start, first * entrySize, level - 1);
+
+    for (auto i = first; i < last; ++i)
+        span.add(getEntry(level, i));
+
+    addRange(span, last * entrySize, end, level - 1);
+}
+
+juce::int64 WaveformHistory::findRisingCrossing(float level, juce::int64 earliest, juce::int64 latest) const
+{
+    earliest = juce::jmax(earliest, getOldestAvailable() + 1);
+    latest   = juce::jmin(latest, numWritten - 1);
+
+    if (latest < earliest)
+        return -1;
+
+    // Blocks of the first summary level cover 4 samples, step by a coarser
+    // one so long searches skip most of the signal
+    const int searchLevel = juce::jmin(3, static_cast<int>(levels.size()));
+    juce::int64 blockSize = 1;
+    for (int n = 0; n < searchLevel; ++n)
+        blockSize *= summaryFanout;
+
+    juce::int64 summarisedEnd = (numWritten / blockSize) * blockSize;
+
+    auto scan = [&](juce::int64 from, juce::int64 to) -> juce::int64
+    {
+        for (juce::int64 p = to; p >= from; --p)
+            if (getSample(p - 1) < level && level <= getSample(p))
+                return p;
+        return -1;
+    };
+
+    // The tail that isn't summarised yet
+    if (latest >= summarisedEnd)
+    {
+        auto found = scan(juce::jmax(earliest, summarisedEnd), latest);
+        if (found >= 0 || earliest >= summarisedEnd)
+            return found;
+
+        latest = summarisedEnd - 1;
+    }
+
+    for (juce::int64 block = latest / blockSize; block >= earliest / blockSize; --block)
+    {
+        juce::int64 blockStart = block * blockSize;
+
+        // The sample before the block takes part in a crossing at its first sample
+        Span span = getEntry(searchLevel, block);
+        span.add(getSample(blockStart - 1));
+
+        if (span.min >= level || span.max < level)
+            continue;
+
+        auto found = scan(juce::jmax(earliest, blockStart), juce::jmin(latest, blockStart + blockSize - 1));
+        if (found >= 0)
+            return found;
+    }
+
+    return -1;
+}
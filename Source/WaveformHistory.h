@@ -0,0 +1,74 @@
+//
+//  WaveformHistory.h
+//  PFM10 - Shared Code
+//
+//  The last few seconds of the mono signal, (L + R) / 2, for waveform
+//  displays. Samples are numbered from 0 since prepare(). Alongside the raw
+//  ring, a min/max pyramid is kept up to date as samples arrive: level n
+//  holds one Span per summaryFanout^n samples, so any stretch of history can
+//  be summarised from a handful of entries.
+//
+//  Not thread-safe. The owner serialises push() against the readers.
+//
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <vector>
+
+class WaveformHistory
+{
+public:
+    struct Span
+    {
+        float min { std::numeric_limits<float>::max() };
+        float max { std::numeric_limits<float>::lowest() };
+
+        bool isEmpty() const { return min > max; }
+        void add(float x)         { min = juce::jmin(min, x);       max = juce::jmax(max, x); }
+        void add(const Span& s)   { min = juce::jmin(min, s.min);   max = juce::jmax(max, s.max); }
+    };
+
+    static constexpr int summaryFanout = 4;
+    static constexpr int maxLevels = 10;
+
+    // Keeps at least historySeconds, rounded up to a power of two samples
+    void prepare(double sampleRate, double historySeconds);
+    void clear();
+
+    void push(const juce::AudioBuffer<float>& buffer);
+
+    double getSampleRate() const { return sampleRate; }
+    juce::int64 getNumWritten() const { return numWritten; }
+    juce::int64 getOldestAvailable() const { return juce::jmax(juce::int64(0), numWritten - capacity); }
+
+    float getSample(juce::int64 position) const { return samples[static_cast<size_t>(position & mask)]; }
+
+    /* Fills one Span per column, column n covering the samples from
+       startSample + n * samplesPerColumn up to the next column. Wide columns
+       read the coarsest level that fits and finer levels for their ragged
+       ends, so no column reaches past its own samples and the cost depends
+       on the number of columns rather than on the samples they span.
+       Positions outside the available history come back empty.
+     */
+    void getSpans(double startSample, double samplesPerColumn, int numColumns, std::vector<Span>& spans) const;
+
+    /* Latest position p in [earliest, latest] where the signal rises through
+       level: getSample(p - 1) < level <= getSample(p). Blocks whose span
+       doesn't contain the level are skipped whole. Returns -1 if none.
+     */
+    juce::int64 findRisingCrossing(float level, juce::int64 earliest, juce::int64 latest) const;
+private:
+    double sampleRate { 44100.0 };
+    juce::int64 capacity { 0 };
+    juce::int64 mask { 0 };
+    juce::int64 numWritten { 0 };
+    std::vector<float> samples;
+
+    // levels[n - 1] is level n, one Span per summaryFanout^n samples, same time span as the samples ring
+    std::vector<std::vector<Span>> levels;
+
+    Span getEntry(int level, juce::int64 index) const;
+    void addRange(Span& span, juce::int64 start, juce::int64 end, int level) const;
+    void summarise(juce::int64 endPosition);
+};
@@ -0,0 +1,209 @@
+//
+//  WaveformOverview.cpp
+//  PFM10 - Shared Code
+//
+
+#include "WaveformOverview.h"
+
+void WaveformOverview::prepare(double _sampleRate, double historySeconds)
+{
+    sampleRate = _sampleRate;
+
+    // ~2.5 ms per level-0 entry, a power of two so positions divide cleanly
+    baseBlockSize = juce::nextPowerOfTwo(juce::jmax(1, static_cast<int>(sampleRate / 400.0)));
+
+    juce::int64 historyEntries = static_cast<juce::int64>(std::ceil(sampleRate * historySeconds / baseBlockSize));
+    int capacity = juce::nextPowerOfTwo(static_cast<int>(juce::jmax(juce::int64(1), historyEntries)));
+
+    levels.clear();
+    while (levels.size() < maxLevels && capacity >= 2)
+    {
+        levels.emplace_back();
+        for (auto& ring : levels.back())
+            ring.assign(static_cast<size_t>(capacity), Entry());
+
+        capacity /= 2;
+    }
+
+    clear();
+}
+
+void WaveformOverview::clear()
+{
+    numWritten = 0;
+    numEntries = 0;
+    samplesIntoBlock = 0;
+    blockMin.fill(1.f);
+    blockMax.fill(-1.f);
+}
+
+size_t WaveformOverview::getMemoryBytes() const
+{
+    size_t bytes = 0;
+    for (auto& level : levels)
+        for (auto& ring : level)
+            bytes += ring.size() * sizeof(Entry);
+    return bytes;
+}
+
+juce::int16 WaveformOverview::toInt16(float x)
+{
+    return static_cast<juce::int16>(juce::roundToInt(juce::jlimit(-1.f, 1.f, x) * 32767.f));
+}
+
+void WaveformOverview::push(const juce::AudioBuffer<float>& buffer)
+{
+    int numBufferChannels = buffer.getNumChannels();
+    int numSamples = buffer.getNumSamples();
+    if (numBufferChannels == 0 || levels.empty())
+        return;
+
+    int position = 0;
+    while (position < numSamples)
+    {
+        int numThisTime = juce::jmin(baseBlockSize - samplesIntoBlock, numSamples - position);
+
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            // A mono buffer shows the same waveform on both sides
+            auto range = juce::FloatVectorOperations::findMinAndMax(buffer.getReadPointer(juce::jmin(ch, numBufferChannels - 1), position),
+                                                                     numThisTime);
+            auto index = static_cast<size_t>(ch);
+            blockMin[index] = juce::jmin(blockMin[index], range.getStart());
+            blockMax[index] = juce::jmax(blockMax[index], range.getEnd());
+        }
+
+        position += numThisTime;
+        samplesIntoBlock += numThisTime;
+        numWritten += numThisTime;
+
+        if (samplesIntoBlock == baseBlockSize)
+            endBlock();
+    }
+}
+
+void WaveformOverview::endBlock()
+{
+    juce::int64 index = numEntries++;
+
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        auto c = static_cast<size_t>(ch);
+        auto& ring = levels[0][c];
+        ring[static_cast<size_t>(index) & (ring.size() - 1)] = { toInt16(blockMin[c]), toInt16(blockMax[c]) };
+    }
+
+    // Each completed pair of entries makes one entry on the level above
+    for (size_t n = 1; n < levels.size() && (index & 1) == 1; ++n)
+    {
+        juce::int64 finerIndex = index;
+        index >>= 1;
+
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            auto& first  = getEntry(n - 1, ch, finerIndex - 1);
+            auto& second = getEntry(n - 1, ch, finerIndex);
+            auto& ring = levels[n][static_cast<size_t>(ch)];
+
+            ring[static_cast<size_t>(index) & (ring.size() - 1)] = { juce::jmin(first.min, second.min),
+                                                                     juce::jmax(first.max, second.max) };
+        }
+    }
+
+    samplesIntoBlock = 0;
+    blockMin.fill(1.f);
+    blockMax.fill(-1.f);
+}
+
+const WaveformOverview::Entry& WaveformOverview::getEntry(size_t level, int channel, juce::int64 index) const
+{
+    auto& ring = levels[level][static_cast<size_t>(channel)];
+    return ring[static_cast<size_t>(index) & (ring.size() - 1)];
+}
+
+void WaveformOverview::getSpans(int channel, double startSample, double samplesPerColumn, int numColumns, std::vector<Span>& spans) const
+{
+    spans.assign(static_cast<size_t>(juce::jmax(0, numColumns)), Span());
+
+    if (levels.empty() || samplesPerColumn <= 0)
+        return;
+
+    // Coarsest level whose entries fit in a column
+    size_t level = 0;
+    while (level + 1 < levels.size() && static_cast<double>(baseBlockSize << (level + 1)) <= samplesPerColumn)
+        ++level;
+
+    for (int column = 0; column < numColumns; ++column)
+    {
+        auto start = juce::jmax(juce::int64(0), static_cast<juce::int64>(std::floor(startSample + column * samplesPerColumn)));
+        auto end   = static_cast<juce::int64>(std::floor(startSample + (column + 1) * samplesPerColumn));
+
+        juce::int16 lo = std::numeric_limits<juce::int16>::max();
+        juce::int16 hi = std::numeric_limits<juce::int16>::min();
+
+        addRange(lo, hi, channel, start, end, level);
+
+        // A column narrower than a level-0 entry has no entry starting in it; it shows the one it falls in
+        if (lo > hi && start < end)
+        {
+            juce::int64 index = start / baseBlockSize;
+
+            if (index >= getOldestKept(0) && index < numEntries)
+            {
+                auto& entry = getEntry(0, channel, index);
+                lo = entry.min;
+                hi = entry.max;
+            }
+        }
+
+        if (lo > hi)
+            continue;
+
+        auto& span = spans[static_cast<size_t>(column)];
+        span.min = lo / 32767.f;
+        span.max = hi / 32767.f;
+    }
+}
+
+juce::int64 WaveformOverview::getOldestKept(size_t level) const
+{
+    return juce::jmax(juce::int64(0), (numEntries >> level) - static_cast<juce::int64>(levels[level][0].size()));
+}
+
+void WaveformOverview::addRange(juce::int16& lo, juce::int16& hi, int channel, juce::int64 start, juce::int64 end, size_t level) const
+{
+    if (start >= end)
+        return;
+
+    juce::int64 entrySize = static_cast<juce::int64>(baseBlockSize) << level;
+
+    // Whole entries only, the ragged ends come from the level below. Entries that
+    // aren't complete yet, or no longer kept, are left to the finer levels too.
+    // Level 0 has nothing finer: its entries go to the range they start in, so
+    // neighbouring columns never share one.
+    juce::int64 first = (start + entrySize - 1) / entrySize;
+    juce::int64 last  = level == 0 ? (end + entrySize - 1) / entrySize : end / entrySize;
+
+    first = juce::jmax(first, getOldestKept(level));
+    last  = juce::jmin(last, numEntries >> level);
+
+    if (first >= last)
+    {
+        if (level > 0)
+            addRange(lo, hi, channel, start, end, level - 1);
+        return;
+    }
+
+    if (level > 0)
+        addRange(lo, hi, channel, start, first * entrySize, level - 1);
+
+    for (juce::int64 i = first; i < last; ++i)
+    {
+        auto& entry = getEntry(level, channel, i);
+        lo = juce::jmin(lo, entry.min);
+        hi = juce::jmax(hi, entry.max);
+    }
+
+    if (level > 0)
+        addRange(lo, hi, channel, last * entrySize, end, level - 1);
+}
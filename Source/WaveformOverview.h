@@ -0,0 +1,80 @@
+//
+//  WaveformOverview.h
+//  PFM10 - Shared Code
+//
+//  Minutes of stereo waveform for a scrolling overview, kept as min/max
+//  summaries only. Level 0 holds one entry per baseBlockSize samples (about
+//  2.5 ms), each level above halves the resolution. Entries are int16 pairs,
+//  so 5 minutes at 96 kHz stereo is about 2 MB across all levels. Every
+//  level is updated as audio arrives, nothing is rebuilt for a redraw.
+//
+//  Positions are sample counts since prepare(). Not thread-safe; the owner
+//  serialises push() against the readers.
+//
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <vector>
+
+class WaveformOverview
+{
+public:
+    static constexpr int numChannels = 2;
+    static constexpr int maxLevels = 16;
+
+    struct Entry
+    {
+        juce::int16 min { 0 };
+        juce::int16 max { 0 };
+    };
+
+    // min and max as -1..1, empty when min > max
+    struct Span
+    {
+        float min { 1.f };
+        float max { -1.f };
+
+        bool isEmpty() const { return min > max; }
+    };
+
+    void prepare(double sampleRate, double historySeconds);
+    void clear();
+
+    void push(const juce::AudioBuffer<float>& buffer);
+
+    double getSampleRate() const { return sampleRate; }
+    juce::int64 getNumWritten() const { return numWritten; }
+    int getBaseBlockSize() const { return baseBlockSize; }
+    size_t getMemoryBytes() const;
+
+    /* Fills one Span per column for one channel, column n covering the
+       samples from startSample + n * samplesPerColumn up to the next one.
+       Reads whole entries of the coarsest level that fits in a column, and
+       finer levels for its ragged ends and for the newest stretch the
+       coarse one hasn't completed yet, so a column doesn't reach into its
+       neighbours' audio by more than the level-0 entry it ends in. Columns
+       outside the kept history, or after the last completed level-0 entry,
+       come back empty.
+     */
+    void getSpans(int channel, double startSample, double samplesPerColumn, int numColumns, std::vector<Span>& spans) const;
+private:
+    double sampleRate { 44100.0 };
+    int baseBlockSize { 128 };
+    juce::int64 numWritten { 0 };
+
+    // levels[n][channel]: ring of entries, each covering baseBlockSize << n samples
+    std::vector<std::array<std::vector<Entry>, numChannels>> levels;
+    juce::int64 numEntries { 0 };       // level-0 entries completed
+
+    std::array<float, numChannels> blockMin {};
+    std::array<float, numChannels> blockMax {};
+    int samplesIntoBlock { 0 };
+
+    static juce::int16 toInt16(float x);
+    const Entry& getEntry(size_t level, int channel, juce::int64 index) const;
+    juce::int64 getOldestKept(size_t level) const;
+    void addRange(juce::int16& lo, juce::int16& hi, int channel, juce::int64 start, juce::int64 end, size_t level) const;
+    void endBlock();
+};
@@ -0,0 +1,131 @@
+//
+//  ChunkedAudioStream.cpp
+//  pfm10-analyze
+//
+
+#include "ChunkedAudioStream.h"
+
+ChunkedAudioStream::ChunkedAudioStream(const juce::File& file,
+                                       juce::AudioFormatManager& formatManager,
+                                       juce::Range<juce::int64> rangeToRead,
+                                       int _chunkSize)
+    : juce::Thread("PFM10 Read-Ahead Thread"),
+      range(rangeToRead),
+      chunkSize(_chunkSize)
+{
+    if (auto* format = formatManager.findFormatForFileExtension(file.getFileExtension()))
+    {
+        if (auto* memoryMappedReader = format->createMemoryMappedReader(file))
+        {
+            mappedReader = memoryMappedReader;
+            reader.reset(memoryMappedReader);
+        }
+    }
+
+    if (reader == nullptr)
+        reader.reset(formatManager.createReaderFor(file));
+
+    if (reader == nullptr)
+        return;
+
+    numChannels = static_cast<int>(juce::jmin(reader->numChannels, juce::uint32(2)));
+
+    juce::Range<juce::int64> wholeFile (0, reader->lengthInSamples);
+    range = range.isEmpty() ? wholeFile : wholeFile.getIntersectionWith(range);
+
+    for (auto& chunk : chunks)
+        chunk.buffer.setSize(numChannels, chunkSize);
+
+    startThread();
+}
+
+ChunkedAudioStream::~ChunkedAudioStream()
+{
+    signalThreadShouldExit();
+    chunkReleased.signal();
+    stopThread(2000);
+}
+
+void ChunkedAudioStream::run()
+{
+    juce::int64 endSample = range.getEnd();
+    juce::int64 position = range.getStart();
+
+    while (position < endSample && ! threadShouldExit())
+    {
+        int start1, size1, start2, size2;
+        fifo.prepareToWrite(1, start1, size1, start2, size2);
+
+        if (size1 == 0)
+        {
+            // All chunk buffers are in flight, wait for the analyser to hand one back
+            chunkReleased.wait(50);
+            continue;
+        }
+
+        Chunk& chunk = chunks[static_cast<size_t>(start1)];
+        int numToRead = static_cast<int>(juce::jmin(juce::int64(chunkSize), endSample - position));
+
+        bool ok = mapWindowContaining({ position, position + numToRead })
+               && reader->read(&chunk.buffer, 0, numToRead, position, true, numChannels > 1);
+
+        if (! ok)
+        {
+            readError = true;
+            break;
+        }
+
+        chunk.startSample = position;
+        chunk.numSamples = numToRead;
+
+        fifo.finishedWrite(1);
+        chunkReady.signal();
+
+        position += numToRead;
+    }
+
+    finished = true;
+    chunkReady.signal();
+}
+
+bool ChunkedAudioStream::mapWindowContaining(juce::Range<juce::int64> samplesToRead)
+{
+    if (mappedReader == nullptr)
+        return true;
+
+    if (mappedReader->getMappedSection().contains(samplesToRead))
+        return true;
+
+    // Map the next few chunks in one go, from where this read starts.
+    juce::int64 windowStart = samplesToRead.getStart();
+    juce::int64 windowEnd = juce::jmin(range.getEnd(),
+                                       windowStart + juce::int64(chunkSize) * chunksPerMappedWindow);
+
+    return mappedReader->mapSectionOfFile({ windowStart, juce::jmax(windowEnd, samplesToRead.getEnd()) });
+}
+
+const ChunkedAudioStream::Chunk* ChunkedAudioStream::waitForNextChunk()
+{
+    for (;;)
+    {
+        // Read the flag before looking at the FIFO: once it is set, every chunk has already been published.
+        bool producerFinished = finished.load();
+
+        int start1, size1, start2, size2;
+        fifo.prepareToRead(1, start1, size1, start2, size2);
+
+        if (size1 > 0)
+            return &chunks[static_cast<size_t>(start1)];
+
+        if (producerFinished)
+            return nullptr;
+
+        chunkReady.wait(50);
+    }
+}
+
+void ChunkedAudioStream::releaseChunk()
+{
+    fifo.finishedRead(1);
+    chunkReleased.signal();
+}
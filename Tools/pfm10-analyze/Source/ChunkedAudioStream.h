@@ -0,0 +1,72 @@
+//
+//  ChunkedAudioStream.h
+//  pfm10-analyze
+//
+//  Streams an audio file to the analyser in large, fixed-size chunks.
+//  A read-ahead thread fills a small ring of preallocated chunk buffers
+//  while the caller analyses the previous one, so memory use depends only
+//  on the chunk size and never on the length of the file.
+//
+//  WAV and AIFF are read through a MemoryMappedAudioFormatReader, which maps
+//  a sliding window of the file instead of the whole thing; other formats
+//  fall back to the format's regular streaming reader.
+//
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+
+class ChunkedAudioStream : private juce::Thread
+{
+public:
+    static constexpr int defaultChunkSize = 1 << 18;    // samples per channel
+    static constexpr int numChunksInFlight = 4;
+    static constexpr int chunksPerMappedWindow = 8;
+
+    struct Chunk
+    {
+        juce::AudioBuffer<float> buffer;
+        juce::int64 startSample { 0 };
+        int numSamples { 0 };
+    };
+
+    // An empty range streams the whole file.
+    ChunkedAudioStream(const juce::File& file,
+                       juce::AudioFormatManager& formatManager,
+                       juce::Range<juce::int64> rangeToRead = {},
+                       int chunkSize = defaultChunkSize);
+    ~ChunkedAudioStream() override;
+
+    bool openedOk() const { return reader != nullptr; }
+    bool isMemoryMapped() const { return mappedReader != nullptr; }
+    bool hadReadError() const { return readError.load(); }
+    juce::AudioFormatReader* getReader() const { return reader.get(); }
+    int getNumChannels() const { return numChannels; }
+
+    // Blocks until the next chunk is ready. Returns nullptr once the whole
+    // file has been delivered. The chunk stays valid until releaseChunk().
+    const Chunk* waitForNextChunk();
+    void releaseChunk();
+
+private:
+    std::unique_ptr<juce::AudioFormatReader> reader;
+    juce::MemoryMappedAudioFormatReader* mappedReader { nullptr };
+    int numChannels { 0 };
+    juce::Range<juce::int64> range;
+    int chunkSize;
+
+    // An AbstractFifo keeps one slot free, so it needs one more than it holds
+    juce::AbstractFifo fifo { numChunksInFlight + 1 };
+    std::array<Chunk, numChunksInFlight + 1> chunks;
+
+    juce::WaitableEvent chunkReady;
+    juce::WaitableEvent chunkReleased;
+    std::atomic<bool> finished { false };
+    std::atomic<bool> readError { false };
+
+    void run() override;
+    bool mapWindowContaining(juce::Range<juce::int64> samplesToRead);
+
+    JUCE_DECLARE_NON_COPYABLE (ChunkedAudioStream)
+};
@@ -0,0 +1,165 @@
+//
+//  FileAnalyser.cpp
+//  pfm10-analyze
+//
+
+#include "FileAnalyser.h"
+
+FileAnalyser::FileAnalyser(const juce::File& _file, juce::AudioFormatManager& _formatManager)
+    : file(_file),
+      formatManager(_formatManager)
+{
+    // Only the header is needed here, the samples are streamed per segment
+    std::unique_ptr<juce::AudioFormatReader> reader (formatManager.createReaderFor(file));
+
+    if (reader != nullptr)
+    {
+        sampleRate = reader->sampleRate;
+        numChannels = static_cast<int>(reader->numChannels);
+        lengthInSamples = reader->lengthInSamples;
+    }
+}
+
+int FileAnalyser::prepareSegments(int maxSegments)
+{
+    segments.clear();
+
+    if (! openedOk())
+        return 0;
+
+    juce::int64 alignment = MeterAnalysisEngine::getSegmentAlignment(sampleRate, frameRateHz);
+    juce::int64 minSegmentLength = static_cast<juce::int64>(sampleRate * minSegmentSeconds);
+
+    int numSegments = static_cast<int>(juce::jlimit(juce::int64(1),
+                                                    juce::int64(juce::jmax(1, maxSegments)),
+                                                    lengthInSamples / juce::jmax(juce::int64(1), minSegmentLength)));
+
+    // Round each boundary down to the alignment so every segment starts where a single pass would start a frame
+    juce::int64 start = 0;
+    for (int i = 1; i <= numSegments; ++i)
+    {
+        juce::int64 end = (i == numSegments) ? lengthInSamples
+                                             : (lengthInSamples * i / numSegments) / alignment * alignment;
+
+        if (end > start)
+        {
+            segments.add({ start, end });
+            start = end;
+        }
+    }
+
+    segmentStatistics.assign(static_cast<size_t>(segments.size()), MeterStatistics());
+    segmentFailed.reset(new std::atomic<bool>[static_cast<size_t>(segments.size())]);
+    for (int i = 0; i < segments.size(); ++i)
+        segmentFailed[static_cast<size_t>(i)] = false;
+
+    return segments.size();
+}
+
+void FileAnalyser::analyseSegment(int segmentIndex)
+{
+    auto segment = segments[segmentIndex];
+    auto preRollStart = juce::jmax(juce::int64(0), segment.getStart() - MeterAnalysisEngine::getPreRollLength(sampleRate));
+
+    ChunkedAudioStream stream (file, formatManager, { preRollStart, segment.getEnd() });
+
+    if (! stream.openedOk())
+    {
+        segmentFailed[static_cast<size_t>(segmentIndex)] = true;
+        return;
+    }
+
+    memoryMapped = stream.isMemoryMapped();
+
+    MeterAnalysisEngine engine;
+    engine.prepare(sampleRate, frameRateHz);
+
+    // The read-ahead thread converts the next chunk while this one is analysed
+    while (auto* chunk = stream.waitForNextChunk())
+    {
+        int numPreRollSamples = static_cast<int>(juce::jlimit(juce::int64(0),
+                                                              juce::int64(chunk->numSamples),
+                                                              segment.getStart() - chunk->startSample));
+
+        if (numPreRollSamples > 0)
+            engine.preRoll(chunk->buffer, 0, numPreRollSamples);
+
+        if (numPreRollSamples < chunk->numSamples)
+            engine.process(chunk->buffer, numPreRollSamples, chunk->numSamples - numPreRollSamples);
+
+        stream.releaseChunk();
+    }
+
+    if (stream.hadReadError())
+        segmentFailed[static_cast<size_t>(segmentIndex)] = true;
+
+    segmentStatistics[static_cast<size_t>(segmentIndex)] = engine.getStatistics();
+}
+
+juce::var FileAnalyser::getResult() const
+{
+    juce::DynamicObject::Ptr result = new juce::DynamicObject();
+    result->setProperty("file", file.getFullPathName());
+
+    if (! openedOk())
+    {
+        result->setProperty("error", "unreadable or unsupported audio file");
+        return juce::var(result.get());
+    }
+
+    MeterStatistics statistics;
+    bool failed = false;
+
+    for (size_t i = 0; i < segmentStatistics.size(); ++i)
+    {
+        statistics.merge(segmentStatistics[i]);
+        failed = failed || segmentFailed[i].load();
+    }
+
+    if (failed)
+        result->setProperty("error", "read error");
+
+    result->setProperty("sampleRate", sampleRate);
+    result->setProperty("numChannels", numChannels);
+    result->setProperty("lengthInSamples", lengthInSamples);
+    result->setProperty("memoryMapped", memoryMapped.load());
+    result->setProperty("numSegments", segments.size());
+    result->setProperty("statistics", statisticsToVar(statistics));
+
+    return juce::var(result.get());
+}
+
+juce::var FileAnalyser::statisticsToVar(const MeterStatistics& statistics)
+{
+    auto perChannel = [](auto getter)
+    {
+        juce::Array<juce::var> values;
+        for (int channel = 0; channel < MeterStatistics::numChannels; ++channel)
+            values.add(getter(channel));
+        return juce::var(values);
+    };
+
+    juce::DynamicObject::Ptr correlation = new juce::DynamicObject();
+    correlation->setProperty("mean", statistics.getCorrelationMean());
+    correlation->setProperty("min",  statistics.numFrames > 0 ? statistics.correlationMin : 0.f);
+    correlation->setProperty("max",  statistics.numFrames > 0 ? statistics.correlationMax : 0.f);
+
+    juce::Array<juce::var> counts;
+    for (auto count : statistics.levelHistogram)
+        counts.add(count);
+
+    juce::DynamicObject::Ptr levelDistribution = new juce::DynamicObject();
+    levelDistribution->setProperty("minDb", NEGATIVE_INFINITY);
+    levelDistribution->setProperty("binWidthDb", MeterStatistics::levelBinWidthDb);
+    levelDistribution->setProperty("numFrames", statistics.numFrames);
+    levelDistribution->setProperty("counts", counts);
+
+    juce::DynamicObject::Ptr stats = new juce::DynamicObject();
+    stats->setProperty("peakDb", perChannel([&](int ch) { return statistics.getPeakDb(ch); }));
+    stats->setProperty("rmsDb",  perChannel([&](int ch) { return statistics.getRmsDb(ch); }));
+    stats->setProperty("correlation", juce::var(correlation.get()));
+    stats->setProperty("levelDistribution", juce::var(levelDistribution.get()));
+    stats->setProperty("integratedLoudnessLufs", statistics.loudness.getIntegratedLufs());
+
+    return juce::var(stats.get());
+}
@@ -0,0 +1,55 @@
+//
+//  FileAnalyser.h
+//  pfm10-analyze
+//
+//  Runs the shared PFM10 metering kernels over a whole audio file and turns
+//  the resulting statistics into a juce::var ready for JSON output.
+//
+//  Long files are split into time segments that can be analysed on separate
+//  threads. Each segment starts on a frame and loudness sub-block boundary
+//  and pre-rolls the audio just before it, so merging the segment statistics
+//  in order gives the same result as a single pass.
+//
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "../../../Source/MeterAnalysis.h"
+#include "ChunkedAudioStream.h"
+
+class FileAnalyser
+{
+public:
+    // Same frame rate the editor refreshes at, so the level distribution
+    // is built from the same per-frame peaks the plugin's histogram shows.
+    static constexpr int frameRateHz = 60;
+    static constexpr double minSegmentSeconds = 30.0;
+
+    FileAnalyser(const juce::File& file, juce::AudioFormatManager& formatManager);
+
+    bool openedOk() const { return lengthInSamples >= 0; }
+
+    // Splits the file into at most maxSegments pieces and returns how many there are.
+    int prepareSegments(int maxSegments);
+    int getNumSegments() const { return segments.size(); }
+
+    // Safe to call concurrently for different segment indices.
+    void analyseSegment(int segmentIndex);
+
+    juce::var getResult() const;
+
+    static juce::var statisticsToVar(const MeterStatistics& statistics);
+
+private:
+    juce::File file;
+    juce::AudioFormatManager& formatManager;
+
+    double sampleRate { 0.0 };
+    int numChannels { 0 };
+    juce::int64 lengthInSamples { -1 };
+
+    juce::Array<juce::Range<juce::int64>> segments;
+    std::vector<MeterStatistics> segmentStatistics;
+    std::unique_ptr<std::atomic<bool>[]> segmentFailed;
+    std::atomic<bool> memoryMapped { false };
+};
@@ -0,0 +1,135 @@
+//
+//  Main.cpp
+//  pfm10-analyze
+//
+//  Offline command-line analyser built on the same metering kernels as the
+//  PFM10 plugin. Analyses every file given on the command line in parallel,
+//  splitting long files into segments, and prints one JSON document to stdout.
+//
+//  usage: pfm10-analyze [--threads N] file [file ...]
+//         pfm10-analyze --pipe --rate HZ --channels 1|2 --format f32|s16|s24
+//                       [--interval-ms MS] [--binary]
+//
+
+#include <JuceHeader.h>
+#include "FileAnalyser.h"
+#include "PipeAnalyser.h"
+
+static void printUsage()
+{
+    std::cerr << "usage: pfm10-analyze [--threads N] file [file ...]" << std::endl
+              << "       pfm10-analyze --pipe --rate HZ --channels 1|2 --format f32|s16|s24 [--interval-ms MS] [--binary]" << std::endl;
+}
+
+static int runPipeMode(juce::ArgumentList& args)
+{
+    PipeAnalyser::Options options;
+
+    if (args.containsOption("--rate"))
+        options.sampleRate = args.getValueForOption("--rate").getDoubleValue();
+    if (args.containsOption("--channels"))
+        options.numChannels = args.getValueForOption("--channels").getIntValue();
+    if (args.containsOption("--interval-ms"))
+        options.intervalMs = args.getValueForOption("--interval-ms").getIntValue();
+    options.binaryOutput = args.containsOption("--binary");
+
+    if (args.containsOption("--format")
+        && ! PipeAnalyser::parseSampleFormat(args.getValueForOption("--format"), options.sampleFormat))
+    {
+        printUsage();
+        return 1;
+    }
+
+    if (options.sampleRate <= 0 || options.numChannels <= 0 || options.intervalMs <= 0)
+    {
+        printUsage();
+        return 1;
+    }
+
+    if (options.numChannels > PipeAnalyser::maxNumChannels)
+    {
+        std::cerr << "pfm10-analyze: --channels " << options.numChannels << " is not supported, the pipe takes mono or stereo."
+                  << " Downmix first, e.g. with ffmpeg -ac 2." << std::endl;
+        return 1;
+    }
+
+    PipeAnalyser pipeAnalyser (options);
+    return pipeAnalyser.run();
+}
+
+int main (int argc, char* argv[])
+{
+    juce::ArgumentList args (argc, argv);
+
+    if (args.containsOption("--pipe"))
+        return runPipeMode(args);
+
+    int numThreads = juce::SystemStats::getNumCpus();
+    if (args.containsOption("--threads"))
+        numThreads = juce::jmax(1, args.getValueForOption("--threads").getIntValue());
+    args.removeValueForOption("--threads");
+
+    juce::Array<juce::File> files;
+    for (auto& arg : args.arguments)
+        files.add(arg.resolveAsFile());
+
+    if (files.isEmpty())
+    {
+        printUsage();
+        return 1;
+    }
+
+    juce::AudioFormatManager formatManager;
+    formatManager.registerBasicFormats();
+
+    juce::OwnedArray<FileAnalyser> analysers;
+    for (auto& file : files)
+        analysers.add(new FileAnalyser(file, formatManager));
+
+    {
+        juce::ThreadPool pool (numThreads);
+
+        std::vector<std::pair<FileAnalyser*, int>> jobs;
+        for (auto* analyser : analysers)
+        {
+            int numSegments = analyser->prepareSegments(numThreads);
+
+            for (int segment = 0; segment < numSegments; ++segment)
+                jobs.emplace_back(analyser, segment);
+        }
+
+        // The pool's destructor would drop the jobs that haven't started, so the last one to finish signals
+        std::atomic<size_t> numJobsLeft { jobs.size() };
+        juce::WaitableEvent allJobsDone;
+
+        // Every segment of every file is its own job, so one long file can use all the cores
+        for (auto [analyser, segment] : jobs)
+        {
+            pool.addJob([analyser = analyser, segment = segment, &numJobsLeft, &allJobsDone]
+            {
+                analyser->analyseSegment(segment);
+
+                if (--numJobsLeft == 0)
+                    allJobsDone.signal();
+            });
+        }
+
+        if (! jobs.empty())
+            allJobsDone.wait();
+    }
+
+    // Segments are merged per file, results keep the command-line order
+    juce::Array<juce::var> fileResults;
+    for (auto* analyser : analysers)
+        fileResults.add(analyser->getResult());
+
+    juce::DynamicObject::Ptr root = new juce::DynamicObject();
+    root->setProperty("files", fileResults);
+
+    std::cout << juce::JSON::toString(juce::var(root.get())) << std::endl;
+
+    bool anyFailed = std::any_of(fileResults.begin(), fileResults.end(),
+                                 [](const juce::var& r) { return r.hasProperty("error"); });
+
+    return anyFailed ? 2 : 0;
+}
@@ -0,0 +1,151 @@
+//
+//  PipeAnalyser.cpp
+//  pfm10-analyze
+//
+
+#include "PipeAnalyser.h"
+#include "FileAnalyser.h"
+#include <cstdio>
+
+PipeAnalyser::PipeAnalyser(const Options& _options)
+    : options(_options)
+{
+    switch (options.sampleFormat)
+    {
+        case SampleFormat::float32: bytesPerSample = 4; break;
+        case SampleFormat::int16:   bytesPerSample = 2; break;
+        case SampleFormat::int24:   bytesPerSample = 3; break;
+        default:                    bytesPerSample = 4; break;
+    }
+
+    bytesPerFrame = bytesPerSample * options.numChannels;
+    samplesPerInterval = juce::jmax(juce::int64(1), static_cast<juce::int64>(options.sampleRate * options.intervalMs / 1000.0));
+
+    // float32 is analysed straight out of the read buffer, integer formats are converted once into a float scratch block
+    readBuffer.allocate(static_cast<size_t>(framesPerRead * bytesPerFrame), false);
+
+    if (options.sampleFormat != SampleFormat::float32)
+        conversionBuffer.allocate(static_cast<size_t>(framesPerRead * options.numChannels), false);
+
+    jassert(juce::isPositiveAndNotGreaterThan(options.numChannels, maxNumChannels));
+
+    // Frames cut at the same rate as file mode, so both see the same level distribution
+    engine.prepare(options.sampleRate, FileAnalyser::frameRateHz);
+}
+
+bool PipeAnalyser::parseSampleFormat(const juce::String& text, SampleFormat& format)
+{
+    if (text == "f32" || text == "f32le") { format = SampleFormat::float32; return true; }
+    if (text == "s16" || text == "s16le") { format = SampleFormat::int16;   return true; }
+    if (text == "s24" || text == "s24le") { format = SampleFormat::int24;   return true; }
+
+    return false;
+}
+
+int PipeAnalyser::run()
+{
+    size_t bytesInBuffer = 0;
+
+    for (;;)
+    {
+        size_t bytesRead = std::fread(readBuffer.getData() + bytesInBuffer,
+                                      1,
+                                      static_cast<size_t>(framesPerRead * bytesPerFrame) - bytesInBuffer,
+                                      stdin);
+        bytesInBuffer += bytesRead;
+
+        int numFrames = static_cast<int>(bytesInBuffer / static_cast<size_t>(bytesPerFrame));
+        int numSamples = numFrames * options.numChannels;
+
+        if (numFrames > 0)
+        {
+            switch (options.sampleFormat)
+            {
+                case SampleFormat::float32:
+                    analyse(reinterpret_cast<const float*>(readBuffer.getData()), numFrames);
+                    break;
+                case SampleFormat::int16:
+                    juce::AudioDataConverters::convertInt16LEToFloat(readBuffer.getData(), conversionBuffer.getData(), numSamples);
+                    analyse(conversionBuffer.getData(), numFrames);
+                    break;
+                case SampleFormat::int24:
+                    juce::AudioDataConverters::convertInt24LEToFloat(readBuffer.getData(), conversionBuffer.getData(), numSamples);
+                    analyse(conversionBuffer.getData(), numFrames);
+                    break;
+                default:
+                    break;
+            }
+        }
+
+        // Keep any trailing partial frame for the next read
+        size_t bytesConsumed = static_cast<size_t>(numFrames * bytesPerFrame);
+        bytesInBuffer -= bytesConsumed;
+        if (bytesInBuffer > 0)
+            std::memmove(readBuffer.getData(), readBuffer.getData() + bytesConsumed, bytesInBuffer);
+
+        if (bytesRead == 0)
+            break;
+    }
+
+    if (samplesIntoInterval > 0)
+        writeFrame(engine.takeReadout());
+
+    return std::ferror(stdin) ? 1 : 0;
+}
+
+void PipeAnalyser::analyse(const float* interleaved, int numFrames)
+{
+    int position = 0;
+
+    while (position < numFrames)
+    {
+        int numToIntervalEnd = static_cast<int>(juce::jmin(juce::int64(numFrames - position),
+                                                           samplesPerInterval - samplesIntoInterval));
+
+        engine.processInterleaved(interleaved + position * options.numChannels, options.numChannels, numToIntervalEnd);
+
+        position += numToIntervalEnd;
+        samplesIntoInterval += numToIntervalEnd;
+        totalSamples += numToIntervalEnd;
+
+        if (samplesIntoInterval == samplesPerInterval)
+        {
+            writeFrame(engine.takeReadout());
+            samplesIntoInterval = 0;
+        }
+    }
+}
+
+void PipeAnalyser::writeFrame(const MeterReadout& readout)
+{
+    if (options.binaryOutput)
+    {
+        BinaryRecord record;
+        record.endSample     = totalSamples;
+        record.peakDb[0]     = readout.peakDb[0];
+        record.peakDb[1]     = readout.peakDb[1];
+        record.rmsDb[0]      = readout.rmsDb[0];
+        record.rmsDb[1]      = readout.rmsDb[1];
+        record.correlation   = readout.correlation;
+        record.momentaryLufs = readout.momentaryLufs;
+        record.shortTermLufs = readout.shortTermLufs;
+        record.reserved      = 0.f;
+
+        std::fwrite(&record, sizeof(record), 1, stdout);
+    }
+    else
+    {
+        juce::DynamicObject::Ptr frame = new juce::DynamicObject();
+        frame->setProperty("t", static_cast<double>(totalSamples) / options.sampleRate);
+        frame->setProperty("peakDb", juce::Array<juce::var> { readout.peakDb[0], readout.peakDb[1] });
+        frame->setProperty("rmsDb",  juce::Array<juce::var> { readout.rmsDb[0],  readout.rmsDb[1] });
+        frame->setProperty("correlation", readout.correlation);
+        frame->setProperty("momentaryLufs", readout.momentaryLufs);
+        frame->setProperty("shortTermLufs", readout.shortTermLufs);
+
+        std::fputs((juce::JSON::toString(juce::var(frame.get()), true, 2) + "\n").toRawUTF8(), stdout);
+    }
+
+    // Downstream tools read the frames live, don't hold them back in stdio's buffer
+    std::fflush(stdout);
+}
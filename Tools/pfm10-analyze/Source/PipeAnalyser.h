@@ -0,0 +1,72 @@
+//
+//  PipeAnalyser.h
+//  pfm10-analyze
+//
+//  Headless streaming mode: reads interleaved little-endian PCM from stdin
+//  and writes one meter frame per interval to stdout, either as JSON lines
+//  or as fixed-size binary records.
+//
+//  e.g. ffmpeg -i in.wav -f f32le -ac 2 -ar 48000 - | pfm10-analyze --pipe --rate 48000 --channels 2 --format f32
+//
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "../../../Source/MeterAnalysis.h"
+
+class PipeAnalyser
+{
+public:
+    enum class SampleFormat { float32, int16, int24 };
+
+    struct Options
+    {
+        double sampleRate { 48000.0 };
+        int numChannels { 2 };
+        SampleFormat sampleFormat { SampleFormat::float32 };
+        int intervalMs { 100 };
+        bool binaryOutput { false };
+    };
+
+    // One meter frame in --binary mode. Little-endian, 40 bytes, no padding.
+    struct BinaryRecord
+    {
+        juce::int64 endSample;
+        float peakDb[2];
+        float rmsDb[2];
+        float correlation;
+        float momentaryLufs;
+        float shortTermLufs;
+        float reserved;
+    };
+
+    static constexpr int framesPerRead = 4096;
+
+    // The meters are stereo; there's no downmix for wider input
+    static constexpr int maxNumChannels = MeterStatistics::numChannels;
+
+    PipeAnalyser(const Options& options);
+
+    // Runs until stdin reaches end-of-file. Returns the process exit code.
+    int run();
+
+    static bool parseSampleFormat(const juce::String& text, SampleFormat& format);
+
+private:
+    Options options;
+    MeterAnalysisEngine engine;
+
+    int bytesPerSample;
+    int bytesPerFrame;
+    juce::int64 samplesPerInterval;
+    juce::int64 samplesIntoInterval { 0 };
+    juce::int64 totalSamples { 0 };
+
+    juce::HeapBlock<char> readBuffer;
+    juce::HeapBlock<float> conversionBuffer;
+
+    void analyse(const float* interleaved, int numFrames);
+    void writeFrame(const MeterReadout& readout);
+};
+
+static_assert(sizeof(PipeAnalyser::BinaryRecord) == 40, "BinaryRecord layout is part of the pipe protocol");
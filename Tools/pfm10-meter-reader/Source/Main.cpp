@@ -0,0 +1,342 @@
+//
+//  Main.cpp
+//  pfm10-meter-reader
+//
+//  Reference reader for the meter frames PFM10 publishes when it is loaded
+//  with PFM10_PUBLISH_METERS=1. Deliberately written against plain POSIX and
+//  MeterSharedMemory.h only, so it doubles as an example for dashboards that
+//  don't use JUCE.
+//
+//  usage: pfm10-meter-reader              follow every instance through the notification socket
+//         pfm10-meter-reader SHM_NAME     poll one instance's ring, e.g. /pfm10-1234-1
+//
+//  Any number of readers can run at once: each binds its own socket in
+//  MeterSharedMemory::notificationSocketDirectory, and every instance
+//  notifies all of them.
+//
+
+#include "../../../Source/MeterSharedMemory.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+//==============================================================================
+
+struct Ring
+{
+    std::string shmName;
+    const MeterShmHeader* header { nullptr };
+    const MeterShmFrame* frames { nullptr };
+    size_t mappedSize { 0 };
+    uint64_t nextFrame { 0 };
+};
+
+static bool mapRing(const std::string& shmName, Ring& ring)
+{
+    int fd = shm_open(shmName.c_str(), O_RDONLY, 0);
+    if (fd < 0)
+        return false;
+
+    struct stat info {};
+    void* memory = MAP_FAILED;
+
+    if (fstat(fd, &info) == 0 && static_cast<size_t>(info.st_size) >= sizeof(MeterShmHeader))
+        memory = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_SHARED, fd, 0);
+
+    close(fd);
+
+    if (memory == MAP_FAILED)
+        return false;
+
+    auto* header = static_cast<const MeterShmHeader*>(memory);
+    size_t expectedSize = header->headerSize + static_cast<size_t>(header->capacity) * header->frameSize;
+
+    if (std::memcmp(header->magic, "PFMS", 4) != 0
+        || header->version != MeterSharedMemory::currentVersion
+        || header->frameSize != sizeof(MeterShmFrame)
+        || header->capacity == 0
+        || static_cast<size_t>(info.st_size) < expectedSize)
+    {
+        munmap(memory, static_cast<size_t>(info.st_size));
+        return false;
+    }
+
+    ring.shmName = shmName;
+    ring.header = header;
+    ring.frames = reinterpret_cast<const MeterShmFrame*>(static_cast<const char*>(memory) + header->headerSize);
+    ring.mappedSize = static_cast<size_t>(info.st_size);
+
+    // Start with what is being written now rather than the whole backlog
+    ring.nextFrame = header->writeCount.load(std::memory_order_acquire);
+
+    return true;
+}
+
+static void unmapRing(Ring& ring)
+{
+    if (ring.header != nullptr)
+        munmap(const_cast<MeterShmHeader*>(ring.header), ring.mappedSize);
+
+    ring = Ring();
+}
+
+// The instance unlinks its ring when it goes away, or its process is gone without having done so
+static bool isRingGone(const Ring& ring)
+{
+    if (kill(static_cast<pid_t>(ring.header->pid), 0) != 0 && errno == ESRCH)
+        return true;
+
+    int fd = shm_open(ring.shmName.c_str(), O_RDONLY, 0);
+    if (fd < 0)
+        return errno == ENOENT;
+
+    close(fd);
+    return false;
+}
+
+static std::string readName(const MeterShmHeader& header)
+{
+    char name[sizeof(header.name)];
+
+    for (;;)
+    {
+        auto before = header.nameSequence.load(std::memory_order_acquire);
+        std::memcpy(name, header.name, sizeof(name));
+        std::atomic_thread_fence(std::memory_order_acquire);
+        auto after = header.nameSequence.load(std::memory_order_relaxed);
+
+        if (before == after && (before & 1) == 0)
+            break;
+    }
+
+    name[sizeof(name) - 1] = 0;
+    return name;
+}
+
+static void printFrame(const std::string& name, uint64_t frameNumber, const MeterShmFrame& frame)
+{
+    std::printf("%-20s %10llu  peak %6.1f %6.1f  rms %6.1f %6.1f  corr %+5.2f  flags %x\n",
+                name.c_str(),
+                static_cast<unsigned long long>(frameNumber),
+                frame.peakDb[0], frame.peakDb[1],
+                frame.rmsDb[0], frame.rmsDb[1],
+                frame.correlation,
+                frame.flags);
+}
+
+// The lock-free read described in MeterSharedMemory.h
+static void readNewFrames(Ring& ring)
+{
+    const uint64_t capacity = ring.header->capacity;
+    uint64_t count = ring.header->writeCount.load(std::memory_order_acquire);
+
+    if (count + 1 > capacity)
+        ring.nextFrame = std::max(ring.nextFrame, count + 1 - capacity);
+
+    std::vector<MeterShmFrame> copied;
+    for (uint64_t k = ring.nextFrame; k < count; ++k)
+        copied.push_back(ring.frames[k % capacity]);
+
+    uint64_t countAfter = ring.header->writeCount.load(std::memory_order_acquire);
+    std::string name = readName(*ring.header);
+
+    for (uint64_t k = ring.nextFrame; k < count; ++k)
+    {
+        // Overwritten while we were copying it
+        if (k + capacity <= countAfter)
+            continue;
+
+        printFrame(name, k, copied[static_cast<size_t>(k - ring.nextFrame)]);
+    }
+
+    ring.nextFrame = count;
+    std::fflush(stdout);
+}
+
+//==============================================================================
+
+static int pollOneRing(const std::string& shmName)
+{
+    Ring ring;
+    if (! mapRing(shmName, ring))
+    {
+        std::fprintf(stderr, "pfm10-meter-reader: can't map %s\n", shmName.c_str());
+        return 1;
+    }
+
+    for (;;)
+    {
+        readNewFrames(ring);
+
+        if (isRingGone(ring))
+        {
+            std::fprintf(stderr, "pfm10-meter-reader: %s has gone away\n", shmName.c_str());
+            unmapRing(ring);
+            return 0;
+        }
+
+        usleep(MeterSharedMemory::notifyIntervalMs * 1000);
+    }
+}
+
+//==============================================================================
+
+static char socketPath[sizeof(sockaddr_un::sun_path)];
+
+static void removeSocketAndExit(int)
+{
+    unlink(socketPath);
+    _exit(0);
+}
+
+// Sockets left behind by readers that were killed before they could remove them
+static void removeStaleSockets()
+{
+    DIR* directory = opendir(MeterSharedMemory::notificationSocketDirectory);
+    if (directory == nullptr)
+        return;
+
+    while (auto* entry = readdir(directory))
+    {
+        char* end = nullptr;
+        long pid = std::strtol(entry->d_name, &end, 10);
+
+        if (pid > 0 && std::strcmp(end, ".sock") == 0
+            && kill(static_cast<pid_t>(pid), 0) != 0 && errno == ESRCH)
+        {
+            std::string path = std::string(MeterSharedMemory::notificationSocketDirectory) + "/" + entry->d_name;
+            unlink(path.c_str());
+        }
+    }
+
+    closedir(directory);
+}
+
+static int followNotifications()
+{
+    // Shared by every user's readers, like /tmp itself
+    if (mkdir(MeterSharedMemory::notificationSocketDirectory, 01777) == 0)
+        chmod(MeterSharedMemory::notificationSocketDirectory, 01777);
+
+    removeStaleSockets();
+
+    // sun_path is fixed-size and has to keep its terminator, socketPath is the same size
+    int written = std::snprintf(socketPath, sizeof(socketPath), "%s/%d.sock",
+                                MeterSharedMemory::notificationSocketDirectory, static_cast<int>(getpid()));
+
+    sockaddr_un address {};
+    size_t pathLength = std::strlen(socketPath);
+
+    if (written < 0 || static_cast<size_t>(written) != pathLength || pathLength >= sizeof(address.sun_path))
+    {
+        std::fprintf(stderr, "pfm10-meter-reader: socket path in %s is too long\n",
+                     MeterSharedMemory::notificationSocketDirectory);
+        return 1;
+    }
+
+    address.sun_family = AF_UNIX;
+    std::memcpy(address.sun_path, socketPath, pathLength + 1);
+
+    int fd = socket(AF_UNIX, SOCK_DGRAM, 0);
+
+    // Left behind by an earlier process with our pid
+    unlink(socketPath);
+
+    if (fd < 0 || bind(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0)
+    {
+        std::perror("pfm10-meter-reader: bind");
+        return 1;
+    }
+
+    // Instances stop sending to a socket that's gone, but only notice on their next send
+    std::signal(SIGINT, removeSocketAndExit);
+    std::signal(SIGTERM, removeSocketAndExit);
+    std::signal(SIGHUP, removeSocketAndExit);
+
+    std::map<std::string, Ring> rings;
+    time_t lastCleanup = time(nullptr);
+
+    for (;;)
+    {
+        pollfd waiting { fd, POLLIN, 0 };
+        bool ready = poll(&waiting, 1, MeterSharedMemory::readerScanIntervalMs) > 0;
+
+        // Instances that have gone away stop notifying, so this can't wait for a datagram
+        if (time(nullptr) != lastCleanup)
+        {
+            lastCleanup = time(nullptr);
+
+            for (auto it = rings.begin(); it != rings.end();)
+            {
+                if (isRingGone(it->second))
+                {
+                    unmapRing(it->second);
+                    it = rings.erase(it);
+                }
+                else
+                {
+                    ++it;
+                }
+            }
+        }
+
+        if (! ready)
+            continue;
+
+        MeterShmNotification notification {};
+        ssize_t received = recv(fd, &notification, sizeof(notification), 0);
+
+        if (received != static_cast<ssize_t>(sizeof(notification))
+            || std::memcmp(notification.magic, "PFMN", 4) != 0
+            || notification.version != MeterSharedMemory::currentVersion)
+            continue;
+
+        notification.shmName[sizeof(notification.shmName) - 1] = 0;
+        notification.name[sizeof(notification.name) - 1] = 0;
+        std::string shmName = notification.shmName;
+
+        if (! shmName.empty() && rings.count(shmName) == 0)
+        {
+            Ring ring;
+            if (mapRing(shmName, ring))
+                rings[shmName] = ring;
+        }
+
+        auto found = rings.find(shmName);
+
+        if (found != rings.end())
+            readNewFrames(found->second);
+        else if (notification.writeCount > 0)
+            printFrame(notification.name, notification.writeCount - 1, notification.latest);   // fallback: latest frame only
+
+        std::fflush(stdout);
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc > 2 || (argc == 2 && argv[1][0] != '/'))
+    {
+        std::fprintf(stderr, "usage: pfm10-meter-reader [SHM_NAME]\n");
+        return 1;
+    }
+
+    return argc == 2 ? pollOneRing(argv[1]) : followNotifications();
+}